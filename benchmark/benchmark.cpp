@@ -0,0 +1,255 @@
+// Microbenchmarks for mio's hot paths. Each benchmark prints one line of
+// timings; compare runs before and after a change to spot regressions.
+//
+// Covered:
+//   - map()/unmap() latency as a function of file size and file count
+//   - sequential and random fault throughput of mmap_source vs buffered reads
+//   - sync() cost as a function of the number of dirtied pages
+//   - shared_mmap copy overhead vs copying the owning mmap
+//
+// Numbers are wall-clock and depend on the page cache state; run on an idle
+// machine and take the best of a few runs.
+
+#include <mio/mmap.hpp>
+#include <mio/shared_mmap.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+double elapsed_us(const clock_type::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(
+            clock_type::now() - start).count();
+}
+
+// Sink for computed checksums so the compiler cannot elide the reads.
+volatile uint64_t g_checksum_sink = 0;
+
+std::string make_file(const std::string& name, const size_t size)
+{
+    const std::string path = "mio-bench-" + name;
+    std::ofstream file(path, std::ios::binary);
+    std::string chunk(1 << 16, '\0');
+    for(size_t i = 0; i < chunk.size(); ++i)
+    {
+        chunk[i] = static_cast<char>(i * 31);
+    }
+    for(size_t written = 0; written < size; written += chunk.size())
+    {
+        file.write(chunk.data(), static_cast<std::streamsize>(
+                std::min(chunk.size(), size - written)));
+    }
+    return path;
+}
+
+void bail(const char* what, const std::error_code& error)
+{
+    std::fprintf(stderr, "%s failed: %s\n", what, error.message().c_str());
+    std::exit(EXIT_FAILURE);
+}
+
+// -----------------------------------------------------------------------------
+// map()/unmap() latency
+// -----------------------------------------------------------------------------
+
+void bench_map_unmap(const size_t file_size, const int iterations)
+{
+    const std::string path = make_file("map", file_size);
+    std::error_code error;
+
+    double map_total = 0, unmap_total = 0;
+    for(int i = 0; i < iterations; ++i)
+    {
+        auto start = clock_type::now();
+        mio::mmap_source m = mio::make_mmap_source(
+                path, 0, mio::map_entire_file, error);
+        map_total += elapsed_us(start);
+        if(error) { bail("map", error); }
+
+        start = clock_type::now();
+        m.unmap();
+        unmap_total += elapsed_us(start);
+    }
+    std::printf("map/unmap      %8zu KiB: map %8.2f us  unmap %8.2f us\n",
+            file_size / 1024, map_total / iterations, unmap_total / iterations);
+    std::filesystem::remove(path);
+}
+
+void bench_map_many_files(const int file_count)
+{
+    const size_t file_size = mio::page_size();
+    std::vector<std::string> paths;
+    for(int i = 0; i < file_count; ++i)
+    {
+        paths.push_back(make_file("many-" + std::to_string(i), file_size));
+    }
+    std::error_code error;
+
+    const auto start = clock_type::now();
+    std::vector<mio::mmap_source> mappings;
+    for(const auto& path : paths)
+    {
+        mappings.push_back(mio::make_mmap_source(
+                path, 0, mio::map_entire_file, error));
+        if(error) { bail("map", error); }
+    }
+    const double total = elapsed_us(start);
+    std::printf("map %5d files of one page: %10.2f us total  %8.2f us/file\n",
+            file_count, total, total / file_count);
+
+    mappings.clear();
+    for(const auto& path : paths) { std::filesystem::remove(path); }
+}
+
+// -----------------------------------------------------------------------------
+// Fault throughput: mmap vs buffered reads
+// -----------------------------------------------------------------------------
+
+uint64_t checksum(const char* data, const size_t size)
+{
+    uint64_t sum = 0;
+    for(size_t i = 0; i < size; ++i)
+    {
+        sum += static_cast<unsigned char>(data[i]);
+    }
+    return sum;
+}
+
+void bench_fault_throughput(const size_t file_size)
+{
+    const std::string path = make_file("fault", file_size);
+    std::error_code error;
+    const size_t page_size = mio::page_size();
+    const size_t num_pages = file_size / page_size;
+
+    // Sequential: touch every byte through the mapping.
+    mio::mmap_source m = mio::make_mmap_source(
+            path, 0, mio::map_entire_file, error);
+    if(error) { bail("map", error); }
+    const auto& m_view = m;
+    auto start = clock_type::now();
+    g_checksum_sink += checksum(m_view.data(), m_view.size());
+    const double mmap_seq = elapsed_us(start);
+
+    // Random: touch one byte per page in shuffled order.
+    std::vector<size_t> page_order(num_pages);
+    for(size_t i = 0; i < num_pages; ++i) { page_order[i] = i; }
+    std::shuffle(page_order.begin(), page_order.end(), std::mt19937(42));
+    m.advise(mio::advice::dont_need, error); // drop residency for a cold-ish run
+    start = clock_type::now();
+    uint64_t sum = 0;
+    for(const size_t page : page_order)
+    {
+        sum += static_cast<unsigned char>(m_view.data()[page * page_size]);
+    }
+    g_checksum_sink += sum;
+    const double mmap_rand = elapsed_us(start);
+    m.unmap();
+
+    // Buffered read baseline for the sequential pass.
+    std::ifstream file(path, std::ios::binary);
+    std::vector<char> read_buffer(file_size);
+    start = clock_type::now();
+    file.read(read_buffer.data(), static_cast<std::streamsize>(file_size));
+    g_checksum_sink += checksum(read_buffer.data(), file_size);
+    const double read_seq = elapsed_us(start);
+
+    const double mib = static_cast<double>(file_size) / (1024 * 1024);
+    std::printf("fault %8.0f MiB: mmap seq %8.2f us (%.0f MiB/s)  "
+            "mmap rand %8.2f us  read seq %8.2f us (%.0f MiB/s)\n",
+            mib, mmap_seq, mib / (mmap_seq / 1e6),
+            mmap_rand, read_seq, mib / (read_seq / 1e6));
+    std::filesystem::remove(path);
+}
+
+// -----------------------------------------------------------------------------
+// sync() cost vs dirty page count
+// -----------------------------------------------------------------------------
+
+void bench_sync(const size_t file_size, const size_t dirty_pages)
+{
+    const std::string path = make_file("sync", file_size);
+    std::error_code error;
+    const size_t page_size = mio::page_size();
+
+    mio::mmap_sink sink = mio::make_mmap_sink(
+            path, 0, mio::map_entire_file, error);
+    if(error) { bail("map", error); }
+    for(size_t i = 0; i < dirty_pages; ++i)
+    {
+        sink[i * page_size] = static_cast<char>(i);
+    }
+
+    auto start = clock_type::now();
+    sink.sync(0, mio::map_entire_file, mio::sync_mode::sync, error);
+    const double sync_us = elapsed_us(start);
+    if(error) { bail("sync", error); }
+
+    std::printf("sync %5zu dirty pages of %5zu: %10.2f us\n",
+            dirty_pages, file_size / page_size, sync_us);
+    sink.unmap();
+    std::filesystem::remove(path);
+}
+
+// -----------------------------------------------------------------------------
+// shared_mmap copy overhead
+// -----------------------------------------------------------------------------
+
+void bench_shared_copy(const int iterations)
+{
+    const std::string path = make_file("shared", mio::page_size());
+    std::error_code error;
+
+    auto shared = mio::make_shared_mmap_source(
+            path, 0, mio::map_entire_file, error);
+    if(error) { bail("map", error); }
+
+    auto start = clock_type::now();
+    for(int i = 0; i < iterations; ++i)
+    {
+        const auto copy = shared;
+        g_checksum_sink += static_cast<unsigned char>(copy[0]);
+    }
+    const double copy_us = elapsed_us(start);
+
+    std::printf("shared_mmap copy: %8.4f us/copy over %d copies\n",
+            copy_us / iterations, iterations);
+    std::filesystem::remove(path);
+}
+
+} // namespace
+
+int main()
+{
+    const size_t mib = 1024 * 1024;
+
+    bench_map_unmap(64 * 1024, 200);
+    bench_map_unmap(16 * mib, 50);
+    bench_map_unmap(256 * mib, 10);
+    bench_map_many_files(64);
+    bench_map_many_files(1024);
+
+    bench_fault_throughput(16 * mib);
+    bench_fault_throughput(256 * mib);
+
+    const size_t sync_file_size = 64 * mib;
+    const size_t total_pages = sync_file_size / mio::page_size();
+    bench_sync(sync_file_size, 1);
+    bench_sync(sync_file_size, total_pages / 16);
+    bench_sync(sync_file_size, total_pages);
+
+    bench_shared_copy(1000000);
+    return EXIT_SUCCESS;
+}
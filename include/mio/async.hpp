@@ -0,0 +1,396 @@
+/* Copyright 2017 https://github.com/mandreyel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MIO_ASYNC_HEADER
+#define MIO_ASYNC_HEADER
+
+// -----------------------------------------------------------------------------
+// async.hpp - Asynchronous mapping, prefetch, and sync operations
+// -----------------------------------------------------------------------------
+//
+// This header provides async_engine, which moves mio's potentially blocking
+// operations off the calling thread: mapping a cold file (open + fstat +
+// mmap touch disk for metadata), prefetching a range into residency (page
+// faults at device latency), and sync() (writeback). In an async server,
+// any of these on a reactor thread stalls every connection it serves; the
+// engine runs them on its own workers and reports completion through a
+// std::future, or through co_await in C++20.
+//
+// Usage (futures):
+//   mio::async_engine engine;
+//   auto pending = engine.map<mio::mmap_source>("data.bin");
+//   ... // do other work
+//   auto [map, ec] = pending.get();
+//
+// Usage (C++20 coroutines):
+//   auto [map, ec] = co_await engine.async_map<mio::mmap_source>("data.bin");
+//   co_await engine.async_prefetch(map, 0, mio::map_entire_file);
+//
+// The coroutine is resumed on an engine worker thread; reschedule onto your
+// own executor after co_await if thread affinity matters.
+//
+// -----------------------------------------------------------------------------
+
+#include "mio/mmap.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+# include <coroutine>
+# define MIO_HAS_COROUTINES 1
+#endif
+
+namespace mio {
+
+/**
+ * Result of an asynchronous operation that produces a value.
+ *
+ * The usual out-parameter error convention does not work across a
+ * completion boundary, so async operations deliver the value and its
+ * error code together. Check `error` before using `value`.
+ */
+template<typename T>
+struct async_result
+{
+    T value;                ///< The produced value; empty/default on error.
+    std::error_code error;  ///< The operation's error code.
+};
+
+// -----------------------------------------------------------------------------
+// async_engine - Worker pool for blocking mapping operations
+// -----------------------------------------------------------------------------
+
+/**
+ * Executes mapping, prefetch, and sync operations on a pool of worker
+ * threads, completing them through futures or C++20 awaitables.
+ *
+ * The engine is intentionally simple: a FIFO of type-erased operations
+ * drained by N workers. Each operation is one blocking mio call; the
+ * caller's thread never blocks on file or memory I/O, only on the
+ * future/awaitable when it chooses to.
+ *
+ * Mapped objects are produced and consumed across threads, which is safe:
+ * the engine touches a mapping only inside the submitted operation, and
+ * completion (future or coroutine resumption) synchronizes-with it.
+ *
+ * Ownership semantics: neither copyable nor movable; workers hold a
+ * reference to the engine. Destruction drains already-submitted work,
+ * then joins the workers.
+ */
+class async_engine
+{
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> queue_;
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    bool stopping_ = false;
+
+    void worker_loop()
+    {
+        for(;;)
+        {
+            std::function<void()> op;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wakeup_.wait(lock, [this]
+                        { return stopping_ || !queue_.empty(); });
+                if(queue_.empty()) { return; } // stopping and drained
+                op = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            op();
+        }
+    }
+
+public:
+    /**
+     * Starts the engine with `num_threads` workers.
+     *
+     * @param num_threads Worker count; 0 selects hardware_concurrency().
+     */
+    explicit async_engine(size_t num_threads = 0)
+    {
+        if(num_threads == 0)
+        {
+            num_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        workers_.reserve(num_threads);
+        for(size_t i = 0; i < num_threads; ++i)
+        {
+            workers_.emplace_back([this] { worker_loop(); });
+        }
+    }
+
+    /** Drains already-submitted operations, then joins the workers. */
+    ~async_engine()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wakeup_.notify_all();
+        for(auto& worker : workers_) { worker.join(); }
+    }
+
+    async_engine(const async_engine&) = delete;
+    async_engine& operator=(const async_engine&) = delete;
+
+    /** Returns the number of worker threads. */
+    [[nodiscard]] size_t thread_count() const noexcept
+    {
+        return workers_.size();
+    }
+
+    /**
+     * Submits an arbitrary operation for execution on a worker thread.
+     *
+     * Building block for the typed operations below; exposed for callers
+     * that need to run their own blocking mapping sequence off-thread.
+     *
+     * @param op The operation to run.
+     */
+    void submit(std::function<void()> op)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(std::move(op));
+        }
+        wakeup_.notify_one();
+    }
+
+    // -------------------------------------------------------------------------
+    // Future-based operations
+    // -------------------------------------------------------------------------
+
+    /**
+     * Asynchronously maps a whole file.
+     *
+     * @tparam MMap The mapping type to produce (e.g. mmap_source).
+     *
+     * @param path    Path of the file to map.
+     * @param options Mapping options.
+     * @return Future resolving to the mapping and its error code.
+     */
+    template<typename MMap = mmap_source>
+    [[nodiscard]] std::future<async_result<MMap>> map(
+            std::filesystem::path path, map_options options = {})
+    {
+        auto task = std::make_shared<std::promise<async_result<MMap>>>();
+        auto pending = task->get_future();
+        submit([task = std::move(task), path = std::move(path), options]
+        {
+            async_result<MMap> result;
+            result.value.map(path, 0, map_entire_file, options, result.error);
+            task->set_value(std::move(result));
+        });
+        return pending;
+    }
+
+    /**
+     * Asynchronously faults a range of a mapping into residency.
+     *
+     * Issues advice::will_need for bulk readahead, then touches the pages
+     * so that completion means the range is actually resident - all on a
+     * worker, so the consumer never takes the major faults itself.
+     *
+     * The mapping must stay alive until the operation completes.
+     *
+     * @param map    The mapping to prefetch into.
+     * @param offset Byte offset into the mapping.
+     * @param length Number of bytes, or `map_entire_file` for the rest.
+     * @return Future resolving to the operation's error code.
+     */
+    template<access_mode AccessMode, typename ByteT>
+    [[nodiscard]] std::future<std::error_code> prefetch(
+            basic_mmap<AccessMode, ByteT>& map,
+            const size_t offset, const size_t length)
+    {
+        auto task = std::make_shared<std::promise<std::error_code>>();
+        auto pending = task->get_future();
+        submit([task = std::move(task), &map, offset, length]
+        {
+            std::error_code error;
+            map.advise(advice::will_need, offset, length, error);
+            if(!error)
+            {
+                const size_t len = length == map_entire_file
+                        ? map.size() - offset : length;
+                detail::prefault(reinterpret_cast<const char*>(
+                        std::as_const(map).data()) + offset, len);
+            }
+            task->set_value(error);
+        });
+        return pending;
+    }
+
+    /**
+     * Asynchronously flushes a range of a writable mapping.
+     *
+     * The mapping must stay alive until the operation completes, and must
+     * not be concurrently written in the range being flushed if the caller
+     * needs a consistent on-disk image.
+     *
+     * @param map    The mapping to flush.
+     * @param offset Byte offset into the mapping.
+     * @param length Number of bytes, or `map_entire_file` for the rest.
+     * @param mode   Durability tier for the flush.
+     * @return Future resolving to the operation's error code.
+     */
+    template<typename ByteT>
+    [[nodiscard]] std::future<std::error_code> sync(
+            basic_mmap<access_mode::write, ByteT>& map,
+            const size_t offset, const size_t length,
+            const sync_mode mode = sync_mode::sync)
+    {
+        auto task = std::make_shared<std::promise<std::error_code>>();
+        auto pending = task->get_future();
+        submit([task = std::move(task), &map, offset, length, mode]
+        {
+            std::error_code error;
+            map.sync(offset, length, mode, error);
+            task->set_value(error);
+        });
+        return pending;
+    }
+
+#ifdef MIO_HAS_COROUTINES
+    // -------------------------------------------------------------------------
+    // C++20 awaitables
+    // -------------------------------------------------------------------------
+
+    /**
+     * Awaitable running an operation on the engine and resuming the
+     * coroutine, on a worker thread, with the operation's result.
+     */
+    template<typename T>
+    class [[nodiscard]] awaitable
+    {
+        friend class async_engine;
+
+        async_engine& engine_;
+        std::function<T()> op_;
+        T result_{};
+
+        awaitable(async_engine& engine, std::function<T()> op)
+            : engine_(engine), op_(std::move(op))
+        {}
+
+    public:
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> coroutine)
+        {
+            engine_.submit([this, coroutine]
+            {
+                result_ = op_();
+                coroutine.resume();
+            });
+        }
+
+        T await_resume() { return std::move(result_); }
+    };
+
+    /**
+     * co_await-able counterpart of map().
+     *
+     * @tparam MMap The mapping type to produce.
+     *
+     * @param path    Path of the file to map.
+     * @param options Mapping options.
+     * @return Awaitable yielding the mapping and its error code.
+     */
+    template<typename MMap = mmap_source>
+    [[nodiscard]] awaitable<async_result<MMap>> async_map(
+            std::filesystem::path path, map_options options = {})
+    {
+        return awaitable<async_result<MMap>>(*this,
+                [path = std::move(path), options]
+        {
+            async_result<MMap> result;
+            result.value.map(path, 0, map_entire_file, options, result.error);
+            return result;
+        });
+    }
+
+    /**
+     * co_await-able counterpart of prefetch().
+     *
+     * @param map    The mapping to prefetch into.
+     * @param offset Byte offset into the mapping.
+     * @param length Number of bytes, or `map_entire_file` for the rest.
+     * @return Awaitable yielding the operation's error code.
+     */
+    template<access_mode AccessMode, typename ByteT>
+    [[nodiscard]] awaitable<std::error_code> async_prefetch(
+            basic_mmap<AccessMode, ByteT>& map,
+            const size_t offset, const size_t length)
+    {
+        return awaitable<std::error_code>(*this, [&map, offset, length]
+        {
+            std::error_code error;
+            map.advise(advice::will_need, offset, length, error);
+            if(!error)
+            {
+                const size_t len = length == map_entire_file
+                        ? map.size() - offset : length;
+                detail::prefault(reinterpret_cast<const char*>(
+                        std::as_const(map).data()) + offset, len);
+            }
+            return error;
+        });
+    }
+
+    /**
+     * co_await-able counterpart of sync().
+     *
+     * @param map    The mapping to flush.
+     * @param offset Byte offset into the mapping.
+     * @param length Number of bytes, or `map_entire_file` for the rest.
+     * @param mode   Durability tier for the flush.
+     * @return Awaitable yielding the operation's error code.
+     */
+    template<typename ByteT>
+    [[nodiscard]] awaitable<std::error_code> async_sync(
+            basic_mmap<access_mode::write, ByteT>& map,
+            const size_t offset, const size_t length,
+            const sync_mode mode = sync_mode::sync)
+    {
+        return awaitable<std::error_code>(*this, [&map, offset, length, mode]
+        {
+            std::error_code error;
+            map.sync(offset, length, mode, error);
+            return error;
+        });
+    }
+#endif // MIO_HAS_COROUTINES
+};
+
+} // namespace mio
+
+#endif // MIO_ASYNC_HEADER
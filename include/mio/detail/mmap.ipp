@@ -44,15 +44,48 @@
 #include "mio/mmap.hpp"
 #include "mio/page.hpp"
 #include "mio/detail/string_util.hpp"
+#include "mio/stats.hpp"
 
 #include <algorithm>
+#include <cstring>
 #include <filesystem>
+#include <functional>
 
-#ifndef _WIN32
+#ifdef _WIN32
+# include <psapi.h> // QueryWorkingSetEx, for residency()
+#else
 # include <unistd.h>
 # include <fcntl.h>
 # include <sys/mman.h>
 # include <sys/stat.h>
+# ifdef __linux__
+#  include <cstdio>
+#  include <cstdlib>
+#  include <sys/syscall.h> // mbind/move_pages, for NUMA placement
+# endif
+// Some BSD-derived systems spell MAP_ANONYMOUS as MAP_ANON.
+# if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#  define MAP_ANONYMOUS MAP_ANON
+# endif
+// MAP_SYNC (synchronous page faults on DAX filesystems) and the
+// MAP_SHARED_VALIDATE it requires are kernel ABI constants that older
+// libcs do not expose.
+# ifdef __linux__
+#  ifndef MAP_SHARED_VALIDATE
+#   define MAP_SHARED_VALIDATE 0x03
+#  endif
+#  ifndef MAP_SYNC
+#   define MAP_SYNC 0x80000
+#  endif
+// fallocate() mode flags for discard(); kernel ABI constants that only
+// newer libcs expose through <fcntl.h>.
+#  ifndef FALLOC_FL_KEEP_SIZE
+#   define FALLOC_FL_KEEP_SIZE 0x01
+#  endif
+#  ifndef FALLOC_FL_PUNCH_HOLE
+#   define FALLOC_FL_PUNCH_HOLE 0x02
+#  endif
+# endif
 #endif
 
 namespace mio {
@@ -94,23 +127,33 @@ inline DWORD int64_low(int64_t n) noexcept
 /**
  * Opens a file for memory mapping on Windows.
  *
- * Uses CreateFileW to support Unicode paths via std::filesystem::path.
- * The file is opened with sharing enabled for both reads and writes,
- * allowing other processes to access the file while it's mapped.
+ * Uses CreateFileW so Unicode paths work; callers with narrow strings
+ * convert through std::filesystem::path first. The file is opened with
+ * sharing enabled for both reads and writes, allowing other processes to
+ * access the file while it's mapped.
  *
- * @param path The file path (Unicode-aware via std::filesystem).
- * @param mode Whether to open for read-only or read-write access.
+ * @param path   The file path as a native wide NUL-terminated string.
+ * @param mode   Whether to open for read-only or read-write access.
+ * @param create Whether to create the file if it does not exist.
+ * @param access Access-pattern hint for the cache manager; sequential and
+ *               random translate to the corresponding CreateFile flags,
+ *               which can only be set at open time.
  * @return The file handle, or INVALID_HANDLE_VALUE on failure.
  */
-inline file_handle_type open_file_helper(const std::filesystem::path& path, const access_mode mode)
+inline file_handle_type open_file_helper(const wchar_t* path, const access_mode mode,
+        const bool create, const advice access)
 {
+    DWORD flags = FILE_ATTRIBUTE_NORMAL;
+    if(access == advice::sequential) { flags |= FILE_FLAG_SEQUENTIAL_SCAN; }
+    else if(access == advice::random) { flags |= FILE_FLAG_RANDOM_ACCESS; }
+
     return ::CreateFileW(
-            path.c_str(),  // Use wide string for Unicode support
-            mode == access_mode::read ? GENERIC_READ : GENERIC_READ | GENERIC_WRITE,
+            path,          // Use wide string for Unicode support
+            mode == access_mode::write ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
             FILE_SHARE_READ | FILE_SHARE_WRITE,  // Allow others to read/write
             0,                                    // Default security attributes
-            OPEN_EXISTING,                        // File must exist
-            FILE_ATTRIBUTE_NORMAL,                // No special flags
+            create ? OPEN_ALWAYS : OPEN_EXISTING, // Create if missing, or require existence
+            flags,                                // Cache-manager hints, if any
             0);                                   // No template file
 }
 
@@ -144,19 +187,102 @@ inline std::error_code last_error() noexcept
     return error;
 }
 
+/**
+ * Opens a file from a native NUL-terminated path, allocation-free.
+ *
+ * The std::filesystem::path overload below heap-allocates just to build
+ * the path object (and re-encodes the string on Windows); high-rate
+ * mapping loops resolve to these overloads instead. On POSIX the narrow
+ * string goes straight to open(). On Windows the wide string goes
+ * straight to CreateFileW, while narrow strings still convert through
+ * std::filesystem::path because the narrow system encoding must be
+ * re-encoded. Parameters as in the std::filesystem::path overload.
+ */
+inline file_handle_type open_file(const char* path, const access_mode mode,
+        const bool create, const advice access, std::error_code& error)
+{
+    error.clear();
+
+    // Check for null/empty path before attempting to open
+    if(path == nullptr || *path == '\0')
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return invalid_handle;
+    }
+
+#ifdef _WIN32
+    const auto handle = win::open_file_helper(
+            std::filesystem::path(path).c_str(), mode, create, access);
+#else // POSIX
+    // O_RDWR for write mode, O_RDONLY otherwise; copy-on-write mappings only
+    // ever read from the file, so they open it read-only like read mode.
+    const auto handle = ::open(path,
+            mode == access_mode::write ? (O_RDWR | (create ? O_CREAT : 0)) : O_RDONLY,
+            0644);
+
+# ifdef POSIX_FADV_NORMAL
+    // Shape file-level readahead before the first page of the mapping is
+    // ever faulted; advisory, so a failing or unsupported fadvise (e.g. on
+    // a pipe or some network filesystems) is ignored.
+    if(handle != invalid_handle && access != advice::normal)
+    {
+        const int hint = access == advice::sequential ? POSIX_FADV_SEQUENTIAL
+                : access == advice::random ? POSIX_FADV_RANDOM
+                : access == advice::will_need ? POSIX_FADV_WILLNEED
+                : access == advice::dont_need ? POSIX_FADV_DONTNEED
+                : POSIX_FADV_NOREUSE; // advice::free: drop from cache after use
+        ::posix_fadvise(handle, 0, 0, hint);
+    }
+# endif
+#endif
+
+    if(handle == invalid_handle)
+    {
+        error = detail::last_error();
+    }
+    return handle;
+}
+
+#ifdef _WIN32
+/** @copydoc open_file(const char*,access_mode,bool,advice,std::error_code&) */
+inline file_handle_type open_file(const wchar_t* path, const access_mode mode,
+        const bool create, const advice access, std::error_code& error)
+{
+    error.clear();
+
+    if(path == nullptr || *path == L'\0')
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return invalid_handle;
+    }
+
+    const auto handle = win::open_file_helper(path, mode, create, access);
+    if(handle == invalid_handle)
+    {
+        error = detail::last_error();
+    }
+    return handle;
+}
+#endif // _WIN32
+
 /**
  * Opens a file and returns its handle.
  *
  * Platform-independent file opening with appropriate access permissions.
  * The caller is responsible for closing the returned handle.
  *
- * @param path  Path to the file to open.
- * @param mode  Access mode (read or read-write).
- * @param error Output parameter for error reporting.
+ * @param path   Path to the file to open.
+ * @param mode   Access mode (read or read-write).
+ * @param create Whether to create the file if it does not exist
+ *               (write mode only).
+ * @param access Access-pattern hint applied at open time: CreateFile
+ *               cache-manager flags on Windows, posix_fadvise() on the fd
+ *               elsewhere. Advisory; failures to apply it are ignored.
+ * @param error  Output parameter for error reporting.
  * @return The file handle, or invalid_handle on failure.
  */
 inline file_handle_type open_file(const std::filesystem::path& path, const access_mode mode,
-        std::error_code& error)
+        const bool create, const advice access, std::error_code& error)
 {
     error.clear();
 
@@ -168,18 +294,76 @@ inline file_handle_type open_file(const std::filesystem::path& path, const acces
     }
 
 #ifdef _WIN32
-    const auto handle = win::open_file_helper(path, mode);
+    const auto handle = win::open_file_helper(path.c_str(), mode, create, access);
+    if(handle == invalid_handle)
+    {
+        error = detail::last_error();
+    }
+    return handle;
 #else // POSIX
-    // O_RDONLY for read mode, O_RDWR for write mode (mmap requires read access)
-    const auto handle = ::open(path.c_str(),
-            mode == access_mode::read ? O_RDONLY : O_RDWR);
+    // fs::path::c_str() is already the native narrow string; take the
+    // allocation-free native overload below.
+    return open_file(path.c_str(), mode, create, access, error);
 #endif
+}
 
-    if(handle == invalid_handle)
+/** @copydoc open_file(const std::filesystem::path&,access_mode,bool,advice,std::error_code&) */
+inline file_handle_type open_file(const std::filesystem::path& path, const access_mode mode,
+        const bool create, std::error_code& error)
+{
+    return open_file(path, mode, create, advice::normal, error);
+}
+
+/** @copydoc open_file(const std::filesystem::path&,access_mode,bool,advice,std::error_code&) */
+inline file_handle_type open_file(const std::filesystem::path& path, const access_mode mode,
+        std::error_code& error)
+{
+    return open_file(path, mode, false, error);
+}
+
+/**
+ * Closes a file handle, ignoring errors.
+ *
+ * Used on cleanup paths where an error has already been recorded.
+ */
+inline void close_file(file_handle_type handle) noexcept
+{
+#ifdef _WIN32
+    ::CloseHandle(handle);
+#else // POSIX
+    ::close(handle);
+#endif
+}
+
+/**
+ * Sets the size of a file, growing or shrinking it as needed.
+ *
+ * Newly added bytes read as zero. The mapping layer uses this to grow a
+ * file so a requested range exists before mapping it.
+ *
+ * @param handle   Valid file handle opened with write access.
+ * @param new_size The desired file size in bytes.
+ * @param error    Output parameter for error reporting.
+ */
+inline void resize_file(file_handle_type handle, const size_t new_size,
+        std::error_code& error)
+{
+    error.clear();
+
+#ifdef _WIN32
+    LARGE_INTEGER size;
+    size.QuadPart = static_cast<LONGLONG>(new_size);
+    if(::SetFilePointerEx(handle, size, 0, FILE_BEGIN) == 0
+       || ::SetEndOfFile(handle) == 0)
     {
         error = detail::last_error();
     }
-    return handle;
+#else // POSIX
+    if(::ftruncate(handle, static_cast<off_t>(new_size)) == -1)
+    {
+        error = detail::last_error();
+    }
+#endif
 }
 
 /**
@@ -215,6 +399,115 @@ inline size_t query_file_size(file_handle_type handle, std::error_code& error)
 #endif
 }
 
+/**
+ * Identity of a file on disk, independent of the path used to reach it.
+ *
+ * Two handles refer to the same file exactly when their file_ids compare
+ * equal (device + inode on POSIX, volume serial + file index on Windows).
+ * Used by the mapping registry to deduplicate mappings of the same file
+ * opened through different paths (symlinks, hard links, relative paths).
+ */
+struct file_id
+{
+    uint64_t device = 0;  ///< Device / volume identifier.
+    uint64_t inode = 0;   ///< Inode / file index within the device.
+
+    friend bool operator==(const file_id& a, const file_id& b) noexcept
+    {
+        return a.device == b.device && a.inode == b.inode;
+    }
+    friend bool operator!=(const file_id& a, const file_id& b) noexcept
+    {
+        return !(a == b);
+    }
+};
+
+/** Hash functor for file_id, for use with unordered containers. */
+struct file_id_hash
+{
+    size_t operator()(const file_id& id) const noexcept
+    {
+        // Boost-style hash combine of the two halves.
+        const size_t h = std::hash<uint64_t>{}(id.device);
+        return h ^ (std::hash<uint64_t>{}(id.inode)
+                + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+    }
+};
+
+/**
+ * Queries the on-disk identity of an open file.
+ *
+ * @param handle Valid file handle.
+ * @param error  Output parameter for error reporting.
+ * @return The file's identity, or a default file_id on error.
+ */
+inline file_id query_file_id(file_handle_type handle, std::error_code& error)
+{
+    error.clear();
+    file_id id;
+
+#ifdef _WIN32
+    BY_HANDLE_FILE_INFORMATION info;
+    if(::GetFileInformationByHandle(handle, &info) == 0)
+    {
+        error = detail::last_error();
+        return id;
+    }
+    id.device = info.dwVolumeSerialNumber;
+    id.inode = (static_cast<uint64_t>(info.nFileIndexHigh) << 32)
+            | info.nFileIndexLow;
+#else // POSIX
+    struct stat sbuf;
+    if(::fstat(handle, &sbuf) == -1)
+    {
+        error = detail::last_error();
+        return id;
+    }
+    id.device = static_cast<uint64_t>(sbuf.st_dev);
+    id.inode = static_cast<uint64_t>(sbuf.st_ino);
+#endif
+    return id;
+}
+
+/**
+ * Queries the on-disk identity of the file at `path`.
+ *
+ * Opens the file read-only just long enough to query its identity; on
+ * POSIX this is a plain stat() without opening at all.
+ *
+ * @param path  Path of the file.
+ * @param error Output parameter for error reporting.
+ * @return The file's identity, or a default file_id on error.
+ */
+inline file_id query_file_id(const std::filesystem::path& path,
+        std::error_code& error)
+{
+    error.clear();
+    file_id id;
+
+#ifdef _WIN32
+    const auto handle = open_file(path, access_mode::read, error);
+    if(error) { return id; }
+    id = query_file_id(handle, error);
+    close_file(handle);
+#else // POSIX
+    if(path.empty())
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return id;
+    }
+    struct stat sbuf;
+    if(::stat(path.c_str(), &sbuf) == -1)
+    {
+        error = detail::last_error();
+        return id;
+    }
+    id.device = static_cast<uint64_t>(sbuf.st_dev);
+    id.inode = static_cast<uint64_t>(sbuf.st_ino);
+#endif
+    return id;
+}
+
 /**
  * Result structure for memory_map().
  *
@@ -226,11 +519,144 @@ struct mmap_context
     char* data;              ///< Pointer to user's requested offset (not mapping start)
     int64_t length;          ///< User-requested length
     int64_t mapped_length;   ///< Actual mapped length (>= length due to alignment)
+    size_t page_granularity; ///< Page size backing the mapping (huge or normal)
+    bool sync_map = false;   ///< Whether MAP_SYNC was established (DAX/pmem)
 #ifdef _WIN32
     file_handle_type file_mapping_handle;  ///< Windows file mapping object handle
 #endif
 };
 
+/**
+ * Returns the page size a page_mode request resolves to.
+ *
+ * For the explicit sizes this is a constant; for page_mode::huge it is the
+ * system default huge page size. Returns 0 when huge pages are unavailable.
+ */
+inline size_t requested_page_size(const page_mode pages)
+{
+    switch(pages)
+    {
+    case page_mode::huge_2mb: return size_t(1) << 21;
+    case page_mode::huge_1gb: return size_t(1) << 30;
+    case page_mode::huge:     return large_page_size();
+    default:                  return page_size();
+    }
+}
+
+/**
+ * Faults in every page of a mapped range by touching one byte per page.
+ *
+ * Used to implement map_options::populate on platforms without a
+ * MAP_POPULATE equivalent. The volatile access forces the compiler to
+ * emit the load, which makes the kernel fault the page in.
+ *
+ * @param address Start of the range (should be page-aligned).
+ * @param length  Number of bytes to touch.
+ */
+inline void prefault(const char* const address, const size_t length)
+{
+    const size_t step = page_size();
+    for(size_t i = 0; i < length; i += step)
+    {
+        [[maybe_unused]] volatile char byte = address[i];
+    }
+}
+
+#ifdef __linux__
+// The MPOL_* constants live in <numaif.h>, which ships with libnuma's
+// development headers rather than glibc. The values are kernel ABI, so
+// define the ones we use locally instead of adding a dependency.
+# ifndef MPOL_BIND
+#  define MPOL_BIND 2
+# endif
+# ifndef MPOL_INTERLEAVE
+#  define MPOL_INTERLEAVE 3
+# endif
+# ifndef MPOL_MF_MOVE
+#  define MPOL_MF_MOVE (1 << 1)
+# endif
+
+/**
+ * Returns a bitmask of the online NUMA nodes, for interleaved placement.
+ *
+ * Parsed once from /sys/devices/system/node/online (a range list such as
+ * "0" or "0-3,8"); falls back to node 0 when sysfs is unavailable.
+ */
+inline unsigned long numa_online_nodes_mask()
+{
+    static const unsigned long mask = []() -> unsigned long
+    {
+        unsigned long nodes = 0;
+        if(std::FILE* online = std::fopen("/sys/devices/system/node/online", "r"))
+        {
+            char line[256];
+            if(std::fgets(line, sizeof(line), online))
+            {
+                const char* p = line;
+                while(*p != '\0' && *p != '\n')
+                {
+                    char* end = nullptr;
+                    const long first = std::strtol(p, &end, 10);
+                    long last = first;
+                    if(*end == '-') { last = std::strtol(end + 1, &end, 10); }
+                    for(long node = first; node >= 0 && node <= last
+                            && node < long(8 * sizeof(unsigned long)); ++node)
+                    {
+                        nodes |= 1UL << node;
+                    }
+                    p = *end == ',' ? end + 1 : end;
+                    if(end == nullptr || *end == '\0' || *end == '\n') { break; }
+                }
+            }
+            std::fclose(online);
+        }
+        return nodes != 0 ? nodes : 1;
+    }();
+    return mask;
+}
+
+/**
+ * Applies the requested NUMA placement policy to a mapped range.
+ *
+ * Uses the mbind() syscall directly (raw syscall; no libnuma dependency).
+ * MPOL_MF_MOVE migrates any pages that were already faulted in - e.g. by
+ * MAP_POPULATE - so the policy holds regardless of option order.
+ *
+ * @param address Start of the mapped range (page-aligned).
+ * @param length  Length of the range in bytes.
+ * @param options Mapping options carrying the policy and target node.
+ * @param error   Output parameter for error reporting.
+ */
+inline void apply_numa_policy(void* const address, const size_t length,
+        const map_options& options, std::error_code& error)
+{
+    int policy_mode;
+    unsigned long nodemask;
+    if(options.numa == numa_policy::bind)
+    {
+        if(options.numa_node < 0
+           || options.numa_node >= int(8 * sizeof(unsigned long)))
+        {
+            error = std::make_error_code(std::errc::invalid_argument);
+            return;
+        }
+        policy_mode = MPOL_BIND;
+        nodemask = 1UL << options.numa_node;
+    }
+    else
+    {
+        policy_mode = MPOL_INTERLEAVE;
+        nodemask = numa_online_nodes_mask();
+    }
+
+    if(::syscall(SYS_mbind, address, length, policy_mode, &nodemask,
+            8 * sizeof(nodemask) + 1, MPOL_MF_MOVE) != 0)
+    {
+        error = detail::last_error();
+    }
+}
+#endif // __linux__
+
 /**
  * Creates a memory mapping of a file region.
  *
@@ -249,12 +675,24 @@ struct mmap_context
  * @param offset      User-requested byte offset (will be page-aligned internally).
  * @param length      Number of bytes to map.
  * @param mode        Read or read-write access.
+ * @param options     Mapping options (page size selection, etc.).
  * @param error       Output parameter for error reporting.
  * @return mmap_context with mapping details, or empty context on failure.
  */
 inline mmap_context memory_map(const file_handle_type file_handle, const int64_t offset,
-    const int64_t length, const access_mode mode, std::error_code& error)
+    const int64_t length, const access_mode mode, const map_options& options,
+    std::error_code& error)
 {
+#ifndef __linux__
+    // NUMA placement is only implemented on Linux; fail explicitly rather
+    // than silently leaving the pages wherever first touch puts them.
+    if(options.numa != numa_policy::none)
+    {
+        error = std::make_error_code(std::errc::function_not_supported);
+        return {};
+    }
+#endif
+
     // Round down offset to page boundary for OS mapping requirement
     // Cast offset to size_t for make_offset_page_aligned (offset is non-negative for valid mappings).
     const int64_t aligned_offset = static_cast<int64_t>(
@@ -263,20 +701,48 @@ inline mmap_context memory_map(const file_handle_type file_handle, const int64_t
     // Actual length to map includes bytes from aligned_offset to offset
     const int64_t length_to_map = offset - aligned_offset + length;
 
+    // Resolve the page size a huge-page request would yield; used both to
+    // validate alignment up front and to report the effective granularity.
+    const size_t huge_size =
+            options.pages != page_mode::normal ? requested_page_size(options.pages) : 0;
+    bool use_huge_pages = false;
+
 #ifdef _WIN32
     // Windows requires the maximum file size for the mapping
     const int64_t max_file_size = offset + length;
 
+    DWORD protect = mode == access_mode::read ? PAGE_READONLY
+            : mode == access_mode::copy_on_write ? PAGE_WRITECOPY
+            : PAGE_READWRITE;
+    if(huge_size != 0)
+    {
+        // Large pages require the SeLockMemoryPrivilege; if CreateFileMapping
+        // rejects the request we retry with normal pages below.
+        protect |= SEC_LARGE_PAGES;
+        use_huge_pages = true;
+    }
+
     // Step 1: Create a file mapping object
     // This is a Windows-specific intermediate object between file and view
-    const auto file_mapping_handle = ::CreateFileMapping(
+    auto file_mapping_handle = ::CreateFileMapping(
             file_handle,
             0,  // Default security
-            mode == access_mode::read ? PAGE_READONLY : PAGE_READWRITE,
+            protect,
             win::int64_high(max_file_size),  // Upper 32 bits of size
             win::int64_low(max_file_size),   // Lower 32 bits of size
             0);  // No name (anonymous mapping)
 
+    if(file_mapping_handle == invalid_handle && use_huge_pages)
+    {
+        // Large pages unavailable (missing privilege or fragmentation);
+        // fall back to the normal page size.
+        use_huge_pages = false;
+        protect &= ~static_cast<DWORD>(SEC_LARGE_PAGES);
+        file_mapping_handle = ::CreateFileMapping(
+                file_handle, 0, protect,
+                win::int64_high(max_file_size), win::int64_low(max_file_size), 0);
+    }
+
     if(file_mapping_handle == invalid_handle)
     {
         error = detail::last_error();
@@ -287,7 +753,9 @@ inline mmap_context memory_map(const file_handle_type file_handle, const int64_t
     // Cast length_to_map to SIZE_T (MapViewOfFile expects SIZE_T for size parameter).
     char* mapping_start = static_cast<char*>(::MapViewOfFile(
             file_mapping_handle,
-            mode == access_mode::read ? FILE_MAP_READ : FILE_MAP_WRITE,
+            mode == access_mode::read ? FILE_MAP_READ
+                    : mode == access_mode::copy_on_write ? FILE_MAP_COPY
+                    : FILE_MAP_WRITE,
             win::int64_high(aligned_offset),  // Upper 32 bits of offset
             win::int64_low(aligned_offset),   // Lower 32 bits of offset
             static_cast<SIZE_T>(length_to_map)));
@@ -299,22 +767,120 @@ inline mmap_context memory_map(const file_handle_type file_handle, const int64_t
         error = detail::last_error();
         return {};
     }
+
+    if(options.populate)
+    {
+# if _WIN32_WINNT >= 0x0602 // PrefetchVirtualMemory requires Windows 8+
+        // Initiate the reads in bulk, then touch the pages so map() returns
+        // with the mapping actually resident
+        WIN32_MEMORY_RANGE_ENTRY range;
+        range.VirtualAddress = mapping_start;
+        range.NumberOfBytes = static_cast<SIZE_T>(length_to_map);
+        ::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0);
+# endif
+        prefault(mapping_start, static_cast<size_t>(length_to_map));
+    }
 #else // POSIX
+    const int prot = mode == access_mode::read ? PROT_READ : PROT_READ | PROT_WRITE;
+
+    // MAP_SHARED publishes changes to the file and other processes;
+    // MAP_PRIVATE gives this process its own copy of any page it writes
+    int base_flags = mode == access_mode::copy_on_write ? MAP_PRIVATE : MAP_SHARED;
+# ifdef MAP_POPULATE
+    // Fault the mapping in up front instead of on first touch
+    if(options.populate) { base_flags |= MAP_POPULATE; }
+# endif
+    int flags = base_flags;
+# ifdef MAP_HUGETLB
+    // Explicit hugetlb mappings require the file offset to be aligned to the
+    // huge page size; otherwise we skip straight to the THP fallback below.
+    if(huge_size != 0 && static_cast<uint64_t>(aligned_offset) % huge_size == 0)
+    {
+        flags |= MAP_HUGETLB;
+#  ifdef MAP_HUGE_SHIFT
+        if(options.pages == page_mode::huge_2mb) { flags |= 21 << MAP_HUGE_SHIFT; }
+        else if(options.pages == page_mode::huge_1gb) { flags |= 30 << MAP_HUGE_SHIFT; }
+#  endif
+        use_huge_pages = true;
+    }
+# endif
+
+    bool use_sync_map = false;
+    char* mapping_start = static_cast<char*>(MAP_FAILED);
+# ifdef __linux__
+    // pmem request: MAP_SHARED_VALIDATE | MAP_SYNC asks for synchronous
+    // page faults, after which user-space cacheline flushes alone persist
+    // both the data and the file metadata needed to reach it. The kernel
+    // rejects this on non-DAX files, in which case we fall back to the
+    // regular mapping below.
+    if(options.pmem && mode == access_mode::write)
+    {
+        mapping_start = static_cast<char*>(::mmap(
+                0, static_cast<size_t>(length_to_map), prot,
+                (flags & ~MAP_SHARED) | MAP_SHARED_VALIDATE | MAP_SYNC,
+                file_handle, aligned_offset));
+        use_sync_map = mapping_start != MAP_FAILED;
+    }
+# endif
+
     // POSIX mmap is simpler - maps file directly to memory
     // Cast length_to_map to size_t (mmap expects size_t for length parameter).
-    char* mapping_start = static_cast<char*>(::mmap(
-            0,  // Let OS choose mapping address (no hint)
-            static_cast<size_t>(length_to_map),
-            mode == access_mode::read ? PROT_READ : PROT_READ | PROT_WRITE,
-            MAP_SHARED,      // Changes are shared with other processes
-            file_handle,
-            aligned_offset));
+    if(mapping_start == MAP_FAILED)
+    {
+        mapping_start = static_cast<char*>(::mmap(
+                0,  // Let OS choose mapping address (no hint)
+                static_cast<size_t>(length_to_map),
+                prot,
+                flags,
+                file_handle,
+                aligned_offset));
+    }
+
+    if(mapping_start == MAP_FAILED && use_huge_pages)
+    {
+        // hugetlbfs backing is unavailable for this file (the common case for
+        // regular filesystems); retry with normal pages.
+        use_huge_pages = false;
+        mapping_start = static_cast<char*>(::mmap(
+                0, static_cast<size_t>(length_to_map), prot, base_flags,
+                file_handle, aligned_offset));
+    }
 
     if(mapping_start == MAP_FAILED)
     {
         error = detail::last_error();
         return {};
     }
+
+# ifdef MADV_HUGEPAGE
+    // When huge pages were requested but an explicit hugetlb mapping was not
+    // possible, ask for transparent huge pages instead (best effort).
+    if(huge_size != 0 && !use_huge_pages)
+    {
+        ::madvise(mapping_start, static_cast<size_t>(length_to_map), MADV_HUGEPAGE);
+    }
+# endif
+
+# ifdef __linux__
+    if(options.numa != numa_policy::none)
+    {
+        apply_numa_policy(mapping_start, static_cast<size_t>(length_to_map),
+                options, error);
+        if(error)
+        {
+            ::munmap(mapping_start, static_cast<size_t>(length_to_map));
+            return {};
+        }
+    }
+# endif
+
+# ifndef MAP_POPULATE
+    // No kernel support for prefaulting at mmap time; touch the pages instead
+    if(options.populate)
+    {
+        prefault(mapping_start, static_cast<size_t>(length_to_map));
+    }
+# endif
 #endif
 
     // Build result with adjusted pointer
@@ -323,35 +889,176 @@ inline mmap_context memory_map(const file_handle_type file_handle, const int64_t
     ctx.data = mapping_start + offset - aligned_offset;  // Adjust for alignment
     ctx.length = length;
     ctx.mapped_length = length_to_map;
+    ctx.page_granularity = use_huge_pages ? huge_size : page_size();
 #ifdef _WIN32
     ctx.file_mapping_handle = file_mapping_handle;
+#else
+    ctx.sync_map = use_sync_map;
 #endif
     return ctx;
 }
 
-} // namespace detail
-
-// -----------------------------------------------------------------------------
-// basic_mmap implementation
-// -----------------------------------------------------------------------------
-
 /**
- * Destructor implementation.
+ * Creates an anonymous (file-less) memory mapping.
  *
- * For write-mode mappings, syncs changes to disk first (errors ignored
- * since destructors shouldn't throw). Then unmaps the file region.
+ * The returned memory is zero-initialized and demand-paged, backed by
+ * anonymous memory on POSIX and by the pagefile on Windows. Huge-page
+ * requests are honored the same way as for file mappings, including the
+ * transparent-huge-page fallback.
+ *
+ * @param length  Number of bytes to map.
+ * @param mode    Access mode for the mapping.
+ * @param options Mapping options (page size selection, etc.).
+ * @param error   Output parameter for error reporting.
+ * @return mmap_context with mapping details, or empty context on failure.
  */
-template<access_mode AccessMode, typename ByteT>
-basic_mmap<AccessMode, ByteT>::~basic_mmap()
+inline mmap_context memory_map_anonymous(const int64_t length, const access_mode mode,
+    const map_options& options, std::error_code& error)
 {
-    conditional_sync();
-    unmap();
-}
+#ifndef __linux__
+    if(options.numa != numa_policy::none)
+    {
+        error = std::make_error_code(std::errc::function_not_supported);
+        return {};
+    }
+#endif
 
-/**
- * Move constructor implementation.
- *
- * Transfers ownership of all resources from other to this.
+    const size_t huge_size =
+            options.pages != page_mode::normal ? requested_page_size(options.pages) : 0;
+    bool use_huge_pages = false;
+
+#ifdef _WIN32
+    DWORD protect = mode == access_mode::read ? PAGE_READONLY : PAGE_READWRITE;
+    if(huge_size != 0)
+    {
+        protect |= SEC_LARGE_PAGES | SEC_COMMIT;
+        use_huge_pages = true;
+    }
+
+    // Passing INVALID_HANDLE_VALUE creates a pagefile-backed section
+    auto file_mapping_handle = ::CreateFileMapping(
+            INVALID_HANDLE_VALUE, 0, protect,
+            win::int64_high(length), win::int64_low(length), 0);
+
+    if(file_mapping_handle == invalid_handle && use_huge_pages)
+    {
+        use_huge_pages = false;
+        protect = mode == access_mode::read ? PAGE_READONLY : PAGE_READWRITE;
+        file_mapping_handle = ::CreateFileMapping(
+                INVALID_HANDLE_VALUE, 0, protect,
+                win::int64_high(length), win::int64_low(length), 0);
+    }
+
+    if(file_mapping_handle == invalid_handle)
+    {
+        error = detail::last_error();
+        return {};
+    }
+
+    char* mapping_start = static_cast<char*>(::MapViewOfFile(
+            file_mapping_handle,
+            mode == access_mode::read ? FILE_MAP_READ : FILE_MAP_WRITE,
+            0, 0, static_cast<SIZE_T>(length)));
+
+    if(mapping_start == nullptr)
+    {
+        ::CloseHandle(file_mapping_handle);
+        error = detail::last_error();
+        return {};
+    }
+#else // POSIX
+    const int prot = mode == access_mode::read ? PROT_READ : PROT_READ | PROT_WRITE;
+
+    // Anonymous memory is always private to this process
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+# ifdef MAP_POPULATE
+    if(options.populate) { flags |= MAP_POPULATE; }
+# endif
+# ifdef MAP_HUGETLB
+    if(huge_size != 0)
+    {
+        flags |= MAP_HUGETLB;
+#  ifdef MAP_HUGE_SHIFT
+        if(options.pages == page_mode::huge_2mb) { flags |= 21 << MAP_HUGE_SHIFT; }
+        else if(options.pages == page_mode::huge_1gb) { flags |= 30 << MAP_HUGE_SHIFT; }
+#  endif
+        use_huge_pages = true;
+    }
+# endif
+
+    char* mapping_start = static_cast<char*>(::mmap(
+            0, static_cast<size_t>(length), prot, flags, -1, 0));
+
+    if(mapping_start == MAP_FAILED && use_huge_pages)
+    {
+        // No hugetlb pages reserved on the system; retry with normal pages
+        use_huge_pages = false;
+        mapping_start = static_cast<char*>(::mmap(
+                0, static_cast<size_t>(length), prot,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    }
+
+    if(mapping_start == MAP_FAILED)
+    {
+        error = detail::last_error();
+        return {};
+    }
+
+# ifdef MADV_HUGEPAGE
+    if(huge_size != 0 && !use_huge_pages)
+    {
+        ::madvise(mapping_start, static_cast<size_t>(length), MADV_HUGEPAGE);
+    }
+# endif
+
+# ifdef __linux__
+    if(options.numa != numa_policy::none)
+    {
+        apply_numa_policy(mapping_start, static_cast<size_t>(length), options,
+                error);
+        if(error)
+        {
+            ::munmap(mapping_start, static_cast<size_t>(length));
+            return {};
+        }
+    }
+# endif
+#endif
+
+    mmap_context ctx;
+    ctx.data = mapping_start;
+    ctx.length = length;
+    ctx.mapped_length = length;
+    ctx.page_granularity = use_huge_pages ? huge_size : page_size();
+#ifdef _WIN32
+    ctx.file_mapping_handle = file_mapping_handle;
+#endif
+    return ctx;
+}
+
+} // namespace detail
+
+// -----------------------------------------------------------------------------
+// basic_mmap implementation
+// -----------------------------------------------------------------------------
+
+/**
+ * Destructor implementation.
+ *
+ * For write-mode mappings, syncs changes to disk first (errors ignored
+ * since destructors shouldn't throw). Then unmaps the file region.
+ */
+template<access_mode AccessMode, typename ByteT>
+basic_mmap<AccessMode, ByteT>::~basic_mmap()
+{
+    conditional_sync();
+    unmap();
+}
+
+/**
+ * Move constructor implementation.
+ *
+ * Transfers ownership of all resources from other to this.
  * After the move, other is left in an unmapped state.
  */
 template<access_mode AccessMode, typename ByteT>
@@ -359,19 +1066,24 @@ basic_mmap<AccessMode, ByteT>::basic_mmap(basic_mmap&& other)
     : data_(std::move(other.data_))
     , length_(std::move(other.length_))
     , mapped_length_(std::move(other.mapped_length_))
+    , page_granularity_(std::move(other.page_granularity_))
+    , file_offset_(std::move(other.file_offset_))
     , file_handle_(std::move(other.file_handle_))
 #ifdef _WIN32
     , file_mapping_handle_(std::move(other.file_mapping_handle_))
 #endif
     , is_handle_internal_(std::move(other.is_handle_internal_))
+    , sync_map_(std::move(other.sync_map_))
 {
     // Reset source to unmapped state to prevent double-free
     other.data_ = nullptr;
-    other.length_ = other.mapped_length_ = 0;
+    other.length_ = other.mapped_length_ = other.page_granularity_ = 0;
+    other.file_offset_ = 0;
     other.file_handle_ = invalid_handle;
 #ifdef _WIN32
     other.file_mapping_handle_ = invalid_handle;
 #endif
+    other.sync_map_ = false;
 }
 
 /**
@@ -392,20 +1104,25 @@ basic_mmap<AccessMode, ByteT>::operator=(basic_mmap&& other)
         data_ = std::move(other.data_);
         length_ = std::move(other.length_);
         mapped_length_ = std::move(other.mapped_length_);
+        page_granularity_ = std::move(other.page_granularity_);
+        file_offset_ = std::move(other.file_offset_);
         file_handle_ = std::move(other.file_handle_);
 #ifdef _WIN32
         file_mapping_handle_ = std::move(other.file_mapping_handle_);
 #endif
         is_handle_internal_ = std::move(other.is_handle_internal_);
+        sync_map_ = std::move(other.sync_map_);
 
         // Reset source to prevent double-free on destruction
         other.data_ = nullptr;
-        other.length_ = other.mapped_length_ = 0;
+        other.length_ = other.mapped_length_ = other.page_granularity_ = 0;
+        other.file_offset_ = 0;
         other.file_handle_ = invalid_handle;
 #ifdef _WIN32
         other.file_mapping_handle_ = invalid_handle;
 #endif
         other.is_handle_internal_ = false;
+        other.sync_map_ = false;
     }
     return *this;
 }
@@ -437,25 +1154,66 @@ basic_mmap<AccessMode, ByteT>::mapping_handle() const noexcept
 template<access_mode AccessMode, typename ByteT>
 void basic_mmap<AccessMode, ByteT>::map(const std::filesystem::path& path, const size_type offset,
         const size_type length, std::error_code& error)
+{
+    map(path, offset, length, map_options{}, error);
+}
+
+/** @copydoc basic_mmap::map(const std::filesystem::path&,size_type,size_type,std::error_code&) */
+template<access_mode AccessMode, typename ByteT>
+void basic_mmap<AccessMode, ByteT>::map(const std::filesystem::path& path, const size_type offset,
+        const size_type length, const map_options& options, std::error_code& error)
+{
+    map_with_path(path, offset, length, options, error);
+}
+
+/**
+ * Shared body of the path-based map() overloads.
+ *
+ * `Path` is std::filesystem::path or a native string pointer; the
+ * open_file() overload it resolves to decides whether a path object is
+ * ever constructed. Null/empty paths are rejected by open_file().
+ */
+template<access_mode AccessMode, typename ByteT>
+template<typename Path>
+void basic_mmap<AccessMode, ByteT>::map_with_path(const Path& path, const size_type offset,
+        const size_type length, const map_options& options, std::error_code& error)
 {
     error.clear();
 
-    // Validate path
-    if(path.empty())
+    // Creating or growing a file only makes sense for write mappings
+    if(options.create && AccessMode != access_mode::write)
     {
         error = std::make_error_code(std::errc::invalid_argument);
         return;
     }
 
     // Open file (handle will be closed on unmap since is_handle_internal_=true)
-    const auto handle = detail::open_file(path, AccessMode, error);
+    const auto handle = detail::open_file(path, AccessMode, options.create,
+            options.access_pattern, error);
     if(error)
     {
         return;
     }
 
+    // Grow the file so the requested range exists. A freshly created file is
+    // empty, so without this step mapping it would fail (or, with
+    // map_entire_file, silently yield an empty mapping).
+    if(options.create && length != map_entire_file)
+    {
+        const auto file_size = detail::query_file_size(handle, error);
+        if(!error && offset + length > file_size)
+        {
+            detail::resize_file(handle, offset + length, error);
+        }
+        if(error)
+        {
+            detail::close_file(handle);
+            return;
+        }
+    }
+
     // Create the mapping using the handle overload
-    map(handle, offset, length, error);
+    map(handle, offset, length, options, error);
 
     // Mark handle as internally owned (so we close it on unmap)
     // This MUST be after the call to map(), which sets is_handle_internal_=false
@@ -463,6 +1221,11 @@ void basic_mmap<AccessMode, ByteT>::map(const std::filesystem::path& path, const
     {
         is_handle_internal_ = true;
     }
+    else
+    {
+        // The mapping failed, so nothing will ever close the handle we opened
+        detail::close_file(handle);
+    }
 }
 
 /**
@@ -479,6 +1242,15 @@ void basic_mmap<AccessMode, ByteT>::map(const std::filesystem::path& path, const
 template<access_mode AccessMode, typename ByteT>
 void basic_mmap<AccessMode, ByteT>::map(const handle_type handle,
         const size_type offset, const size_type length, std::error_code& error)
+{
+    map(handle, offset, length, map_options{}, error);
+}
+
+/** @copydoc basic_mmap::map(handle_type,size_type,size_type,std::error_code&) */
+template<access_mode AccessMode, typename ByteT>
+void basic_mmap<AccessMode, ByteT>::map(const handle_type handle,
+        const size_type offset, const size_type length,
+        const map_options& options, std::error_code& error)
 {
     error.clear();
 
@@ -509,7 +1281,9 @@ void basic_mmap<AccessMode, ByteT>::map(const handle_type handle,
     const auto ctx = detail::memory_map(handle,
             static_cast<int64_t>(offset),
             static_cast<int64_t>(length == map_entire_file ? (file_size - offset) : length),
-            AccessMode, error);
+            AccessMode, options, error);
+    detail::stats_on_map(error ? 0 : static_cast<uint64_t>(ctx.length),
+            static_cast<bool>(error));
 
     if(!error)
     {
@@ -525,6 +1299,55 @@ void basic_mmap<AccessMode, ByteT>::map(const handle_type handle,
         // Cast int64_t to size_type (safe: values are from successful mapping, always non-negative).
         length_ = static_cast<size_type>(ctx.length);
         mapped_length_ = static_cast<size_type>(ctx.mapped_length);
+        page_granularity_ = ctx.page_granularity;
+        file_offset_ = offset;
+        sync_map_ = ctx.sync_map;
+#ifdef _WIN32
+        file_mapping_handle_ = ctx.file_mapping_handle;
+#endif
+    }
+}
+
+/**
+ * Establishes an anonymous memory mapping.
+ *
+ * There is no file handle; is_open() is true while the memory is mapped,
+ * and unmap() releases the memory without closing anything else.
+ *
+ * Provides the same strong guarantee as the file-backed map() overloads:
+ * the existing mapping (if any) is only released after the new one has
+ * been created.
+ */
+template<access_mode AccessMode, typename ByteT>
+void basic_mmap<AccessMode, ByteT>::map_anonymous(const size_type length,
+        const map_options& options, std::error_code& error)
+{
+    error.clear();
+
+    if(length == 0)
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
+
+    const auto ctx = detail::memory_map_anonymous(
+            static_cast<int64_t>(length), AccessMode, options, error);
+    detail::stats_on_map(error ? 0 : static_cast<uint64_t>(ctx.length),
+            static_cast<bool>(error));
+
+    if(!error)
+    {
+        // Unmap previous mapping only after the new mapping succeeded
+        unmap();
+
+        file_handle_ = invalid_handle;
+        is_handle_internal_ = false;
+        data_ = reinterpret_cast<pointer>(ctx.data);
+        length_ = static_cast<size_type>(ctx.length);
+        mapped_length_ = static_cast<size_type>(ctx.mapped_length);
+        page_granularity_ = ctx.page_granularity;
+        file_offset_ = 0;
+        sync_map_ = ctx.sync_map;
 #ifdef _WIN32
         file_mapping_handle_ = ctx.file_mapping_handle;
 #endif
@@ -541,6 +1364,20 @@ void basic_mmap<AccessMode, ByteT>::map(const handle_type handle,
  */
 template<access_mode AccessMode, typename ByteT>
 void basic_mmap<AccessMode, ByteT>::sync(std::error_code& error)
+{
+    sync(0, map_entire_file, sync_mode::sync, error);
+}
+
+/**
+ * Flushes a subrange of the mapping with the requested durability tier.
+ *
+ * The user-supplied range is relative to data() and is aligned down to a
+ * page boundary before being handed to msync()/FlushViewOfFile, which both
+ * require page-aligned addresses.
+ */
+template<access_mode AccessMode, typename ByteT>
+void basic_mmap<AccessMode, ByteT>::sync(const size_type offset, const size_type length,
+        const sync_mode mode, std::error_code& error)
 {
     static_assert(AccessMode == access_mode::write, "sync() requires write access");
 
@@ -552,22 +1389,642 @@ void basic_mmap<AccessMode, ByteT>::sync(std::error_code& error)
         return;
     }
 
+    // Anonymous mappings have no backing file to flush to
+    if(file_handle_ == invalid_handle) { return; }
+
+    // Validate that the range lies within the mapping
+    if(offset > length_ || (length != map_entire_file && offset + length > length_))
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
+
     if(data())
     {
+        // If length==map_entire_file (0), flush from offset to end of mapping
+        const size_type sync_length =
+                length == map_entire_file ? length_ - offset : length;
+        if(sync_length == 0) { return; }
+
+        // Times the flush and records it (with the final error state) on
+        // scope exit; a no-op unless MIO_ENABLE_STATS is defined.
+        [[maybe_unused]] const detail::stats_sync_timer sync_timer(error);
+
+        // Round the start of the range down to a page boundary, measured from
+        // the actual mapping start, and clamp the end to the mapping.
+        const size_type aligned_offset =
+                make_offset_page_aligned(mapping_offset() + offset);
+        const size_type aligned_length = std::min(
+                mapping_offset() + offset + sync_length - aligned_offset,
+                mapped_length_ - aligned_offset);
+        char* const address =
+                reinterpret_cast<char*>(get_mapping_start()) + aligned_offset;
+
 #ifdef _WIN32
-        // Windows: Flush the view, then flush the file buffers
-        // FlushViewOfFile writes to system cache; FlushFileBuffers writes to disk
-        if(::FlushViewOfFile(get_mapping_start(), mapped_length_) == 0
-           || ::FlushFileBuffers(file_handle_) == 0)
+        // Windows: FlushViewOfFile writes the range to the system cache;
+        // FlushFileBuffers makes it (and file metadata) durable on disk.
+        if(::FlushViewOfFile(address, static_cast<SIZE_T>(aligned_length)) == 0)
+        {
+            error = detail::last_error();
+            return;
+        }
+        if(mode != sync_mode::async && ::FlushFileBuffers(file_handle_) == 0)
+        {
+            error = detail::last_error();
+            return;
+        }
 #else // POSIX
-        // POSIX: msync with MS_SYNC for synchronous write
-        if(::msync(get_mapping_start(), mapped_length_, MS_SYNC) != 0)
+# ifdef MIO_CACHELINE_FLUSH
+        // MAP_SYNC mapping: stores already sit in (or on their way to) the
+        // persistence domain, so durability is a matter of flushing the
+        // dirty cachelines and fencing - no syscall, no page writeback.
+        // MAP_SYNC guarantees the file metadata for the mapped extents is
+        // durable, so even sync_mode::full needs no fsync here.
+        if(sync_map_)
+        {
+            detail::flush_cachelines(address,
+                    static_cast<size_t>(aligned_length));
+            return;
+        }
+# endif
+        // POSIX: MS_ASYNC schedules the writeback, MS_SYNC waits for it
+        if(::msync(address, aligned_length,
+                mode == sync_mode::async ? MS_ASYNC : MS_SYNC) != 0)
+        {
+            error = detail::last_error();
+            return;
+        }
+        // Full durability additionally flushes file metadata
+        if(mode == sync_mode::full && ::fsync(file_handle_) != 0)
+        {
+            error = detail::last_error();
+            return;
+        }
 #endif
+    }
+}
+
+/**
+ * Grows or shrinks the mapping in place.
+ *
+ * On Linux this uses mremap(), which preserves resident pages (the mapping
+ * may move, in which case data() changes). Elsewhere a new view is created
+ * before the old one is released so a failed resize leaves the mapping
+ * untouched.
+ */
+template<access_mode AccessMode, typename ByteT>
+void basic_mmap<AccessMode, ByteT>::resize(const size_type new_length, std::error_code& error)
+{
+    static_assert(AccessMode == access_mode::write, "resize() requires write access");
+
+    error.clear();
+
+    if(!is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return;
+    }
+    if(new_length == 0)
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
+    if(new_length == length_) { return; }
+
+    // Anonymous mappings have no file to extend; mremap alone suffices on
+    // Linux, and there is no portable in-place resize elsewhere.
+    const bool anonymous = file_handle_ == invalid_handle;
+
+    // When growing, extend the file first so the added range exists.
+    // The file is never shrunk; a shrinking resize only narrows the view.
+    if(new_length > length_ && !anonymous)
+    {
+        const auto file_size = detail::query_file_size(file_handle_, error);
+        if(error) { return; }
+        if(file_offset_ + new_length > file_size)
+        {
+            detail::resize_file(file_handle_, file_offset_ + new_length, error);
+            if(error) { return; }
+        }
+    }
+
+    const size_type new_mapped_length = mapping_offset() + new_length;
+
+#ifdef __linux__
+    // mremap extends (or shrinks) the mapping, moving it if the adjacent
+    // address space is occupied. Resident pages survive the move.
+    void* const new_start = ::mremap(get_mapping_start(), mapped_length_,
+            new_mapped_length, MREMAP_MAYMOVE);
+    if(new_start == MAP_FAILED)
+    {
+        error = detail::last_error();
+        return;
+    }
+    data_ = reinterpret_cast<pointer>(
+            static_cast<char*>(new_start) + mapping_offset());
+    length_ = new_length;
+    mapped_length_ = new_mapped_length;
+#else
+    if(anonymous)
+    {
+        error = std::make_error_code(std::errc::function_not_supported);
+        return;
+    }
+
+    // No in-place remap primitive; map the new view first so that on
+    // failure the existing mapping remains valid (strong guarantee).
+    const auto ctx = detail::memory_map(file_handle_,
+            static_cast<int64_t>(file_offset_),
+            static_cast<int64_t>(new_length),
+            AccessMode, map_options{}, error);
+    if(error) { return; }
+
+# ifdef _WIN32
+    ::UnmapViewOfFile(get_mapping_start());
+    ::CloseHandle(file_mapping_handle_);
+    file_mapping_handle_ = ctx.file_mapping_handle;
+# else // POSIX
+    ::munmap(get_mapping_start(), mapped_length_);
+# endif
+    data_ = reinterpret_cast<pointer>(ctx.data);
+    length_ = static_cast<size_type>(ctx.length);
+    mapped_length_ = static_cast<size_type>(ctx.mapped_length);
+    page_granularity_ = ctx.page_granularity;
+    sync_map_ = ctx.sync_map;
+#endif
+}
+
+/**
+ * Punches a hole over a retired range of the mapping.
+ *
+ * The byte range is zeroed through the filesystem (which handles partial
+ * blocks), deallocating its on-disk blocks, and the pages fully covered by
+ * the range are dropped from memory. Partial pages at the edges are never
+ * dropped - their remainder is live data - only zeroed.
+ */
+template<access_mode AccessMode, typename ByteT>
+void basic_mmap<AccessMode, ByteT>::discard(const size_type offset,
+        const size_type length, std::error_code& error)
+{
+    static_assert(AccessMode == access_mode::write, "discard() requires write access");
+
+    error.clear();
+
+    if(!is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return;
+    }
+
+    // Validate that the range lies within the mapping
+    if(offset > length_ || (length != map_entire_file && offset + length > length_))
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
+
+    const size_type discard_length =
+            length == map_entire_file ? length_ - offset : length;
+    if(discard_length == 0) { return; }
+
+#if defined(__linux__)
+    // Memory-side geometry, in bytes from the actual mapping start. Round
+    // the range inward to the granularity backing the mapping (huge pages
+    // must be dropped whole): [aligned_begin, aligned_end) are the pages
+    // owned entirely by the discard.
+    const size_type begin = mapping_offset() + offset;
+    const size_type end = begin + discard_length;
+    const size_type mask = page_granularity_ - 1;
+    const size_type aligned_begin = (begin + mask) & ~mask;
+    const size_type aligned_end = end & ~mask;
+    char* const mapping_start = reinterpret_cast<char*>(get_mapping_start());
+
+    if(file_handle_ != invalid_handle)
+    {
+        // Punch the exact byte range in the file. The filesystem zeroes
+        // partial blocks, and since the mapping reads through the page
+        // cache, the hole is immediately visible in memory too.
+        if(::fallocate(file_handle_,
+                FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                static_cast<off_t>(file_offset_ + offset),
+                static_cast<off_t>(discard_length)) != 0)
         {
             error = detail::last_error();
             return;
         }
     }
+    else
+    {
+        // Anonymous memory has no file to punch; zero the partial edge
+        // pages by hand so the whole range reads back as zero. The fully
+        // covered pages are handled by madvise below (zero-fill on next
+        // touch for private anonymous memory).
+        if(aligned_begin >= aligned_end)
+        {
+            std::memset(mapping_start + begin, 0, discard_length);
+        }
+        else
+        {
+            if(begin < aligned_begin)
+            {
+                std::memset(mapping_start + begin, 0, aligned_begin - begin);
+            }
+            if(aligned_end < end)
+            {
+                std::memset(mapping_start + aligned_end, 0, end - aligned_end);
+            }
+        }
+    }
+
+    // Drop the fully covered pages so the resident set shrinks now rather
+    // than under memory pressure.
+    if(aligned_end > aligned_begin
+       && ::madvise(mapping_start + aligned_begin,
+                static_cast<size_t>(aligned_end - aligned_begin),
+                MADV_DONTNEED) != 0)
+    {
+        error = detail::last_error();
+    }
+#elif defined(_WIN32)
+    if(file_handle_ == invalid_handle)
+    {
+        // Anonymous pagefile-backed memory: zero the range; the memory
+        // manager reclaims zeroed pages under pressure.
+        std::memset(reinterpret_cast<char*>(data_) + offset, 0,
+                static_cast<size_t>(discard_length));
+        return;
+    }
+
+    DWORD bytes_returned = 0;
+    // Zeroed ranges only release blocks on sparse files; marking an
+    // already-sparse file sparse again is a no-op.
+    ::DeviceIoControl(file_handle_, FSCTL_SET_SPARSE, nullptr, 0,
+            nullptr, 0, &bytes_returned, nullptr);
+
+    FILE_ZERO_DATA_INFORMATION zero_range;
+    zero_range.FileOffset.QuadPart =
+            static_cast<LONGLONG>(file_offset_ + offset);
+    zero_range.BeyondFinalZero.QuadPart =
+            static_cast<LONGLONG>(file_offset_ + offset + discard_length);
+    if(::DeviceIoControl(file_handle_, FSCTL_SET_ZERO_DATA, &zero_range,
+            sizeof zero_range, nullptr, 0, &bytes_returned, nullptr) == 0)
+    {
+        error = detail::last_error();
+    }
+#else
+    // No portable hole-punching primitive on the remaining platforms.
+    error = std::make_error_code(std::errc::function_not_supported);
+#endif
+}
+
+/**
+ * Pins a subrange of the mapping into physical memory.
+ *
+ * The user-supplied range is relative to data() and is aligned down to a
+ * page boundary before being handed to mlock()/VirtualLock(), which operate
+ * on whole pages.
+ */
+template<access_mode AccessMode, typename ByteT>
+void basic_mmap<AccessMode, ByteT>::lock(const size_type offset, const size_type length,
+        std::error_code& error)
+{
+    error.clear();
+
+    if(!is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return;
+    }
+
+    // Validate that the range lies within the mapping
+    if(offset > length_ || (length != map_entire_file && offset + length > length_))
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
+
+    const size_type lock_length =
+            length == map_entire_file ? length_ - offset : length;
+    if(lock_length == 0) { return; }
+
+    // Round the start of the range down to a page boundary, measured from
+    // the actual mapping start, and clamp the end to the mapping.
+    const size_type aligned_offset =
+            make_offset_page_aligned(mapping_offset() + offset);
+    const size_type aligned_length = std::min(
+            mapping_offset() + offset + lock_length - aligned_offset,
+            mapped_length_ - aligned_offset);
+    char* const address =
+            reinterpret_cast<char*>(get_mapping_start()) + aligned_offset;
+
+#ifdef _WIN32
+    if(::VirtualLock(address, static_cast<SIZE_T>(aligned_length)) == 0)
+#else // POSIX
+    if(::mlock(address, aligned_length) != 0)
+#endif
+    {
+        error = detail::last_error();
+    }
+}
+
+/**
+ * Releases a previously pinned subrange of the mapping.
+ */
+template<access_mode AccessMode, typename ByteT>
+void basic_mmap<AccessMode, ByteT>::unlock(const size_type offset, const size_type length,
+        std::error_code& error)
+{
+    error.clear();
+
+    if(!is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return;
+    }
+
+    // Validate that the range lies within the mapping
+    if(offset > length_ || (length != map_entire_file && offset + length > length_))
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
+
+    const size_type unlock_length =
+            length == map_entire_file ? length_ - offset : length;
+    if(unlock_length == 0) { return; }
+
+    const size_type aligned_offset =
+            make_offset_page_aligned(mapping_offset() + offset);
+    const size_type aligned_length = std::min(
+            mapping_offset() + offset + unlock_length - aligned_offset,
+            mapped_length_ - aligned_offset);
+    char* const address =
+            reinterpret_cast<char*>(get_mapping_start()) + aligned_offset;
+
+#ifdef _WIN32
+    // VirtualUnlock on a range with no locked pages fails with
+    // ERROR_NOT_LOCKED; treat that as the no-op it effectively is.
+    if(::VirtualUnlock(address, static_cast<SIZE_T>(aligned_length)) == 0
+       && ::GetLastError() != ERROR_NOT_LOCKED)
+#else // POSIX
+    if(::munlock(address, aligned_length) != 0)
+#endif
+    {
+        error = detail::last_error();
+    }
+}
+
+/**
+ * Applies a memory-access hint to a subrange of the mapping.
+ *
+ * The user-supplied range is relative to data(). It is translated to an
+ * absolute, page-aligned range within the actual mapping before being
+ * handed to the kernel, since madvise()/PrefetchVirtualMemory require
+ * page-aligned addresses.
+ */
+template<access_mode AccessMode, typename ByteT>
+void basic_mmap<AccessMode, ByteT>::advise(const advice adv, const size_type offset,
+        const size_type length, std::error_code& error)
+{
+    error.clear();
+
+    if(!is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return;
+    }
+
+    // Validate that the range lies within the mapping
+    if(offset > length_ || (length != map_entire_file && offset + length > length_))
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
+
+    // If length==map_entire_file (0), advise from offset to end of mapping
+    const size_type advise_length =
+            length == map_entire_file ? length_ - offset : length;
+    if(advise_length == 0) { return; }
+
+    // Round the start of the range down to a page boundary. Offsets are
+    // measured from the actual mapping start (data() sits mapping_offset()
+    // bytes into the mapping), and the aligned length is clamped so the
+    // range never extends past the mapping.
+    const size_type aligned_offset =
+            make_offset_page_aligned(mapping_offset() + offset);
+    const size_type aligned_length = std::min(
+            mapping_offset() + offset + advise_length - aligned_offset,
+            mapped_length_ - aligned_offset);
+    char* const address =
+            reinterpret_cast<char*>(get_mapping_start()) + aligned_offset;
+
+#ifdef _WIN32
+    switch(adv)
+    {
+    case advice::will_need:
+    {
+# if _WIN32_WINNT >= 0x0602 // PrefetchVirtualMemory requires Windows 8+
+        WIN32_MEMORY_RANGE_ENTRY range;
+        range.VirtualAddress = address;
+        range.NumberOfBytes = static_cast<SIZE_T>(aligned_length);
+        if(::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0) == 0)
+        {
+            error = detail::last_error();
+        }
+# endif
+        break;
+    }
+    case advice::dont_need:
+    case advice::free:
+# if _WIN32_WINNT >= 0x0A00 // DiscardVirtualMemory requires Windows 10+
+        if(::DiscardVirtualMemory(address, static_cast<SIZE_T>(aligned_length))
+                != ERROR_SUCCESS)
+        {
+            error = detail::last_error();
+        }
+# endif
+        break;
+    default:
+        // normal/sequential/random have no Windows equivalent; the cache
+        // manager's behavior cannot be changed after the view is mapped.
+        break;
+    }
+#else // POSIX
+    int sys_advice = MADV_NORMAL;
+    switch(adv)
+    {
+    case advice::normal:     sys_advice = MADV_NORMAL; break;
+    case advice::sequential: sys_advice = MADV_SEQUENTIAL; break;
+    case advice::random:     sys_advice = MADV_RANDOM; break;
+    case advice::will_need:  sys_advice = MADV_WILLNEED; break;
+    case advice::dont_need:  sys_advice = MADV_DONTNEED; break;
+# ifdef MADV_FREE
+    case advice::free:       sys_advice = MADV_FREE; break;
+# else
+    // MADV_FREE is Linux 4.5+/BSD only; DONTNEED is the closest substitute.
+    case advice::free:       sys_advice = MADV_DONTNEED; break;
+# endif
+    }
+    if(::madvise(address, aligned_length, sys_advice) != 0)
+    {
+        error = detail::last_error();
+    }
+#endif
+}
+
+/**
+ * Queries page residency for a subrange of the mapping.
+ *
+ * The user-supplied range is relative to data() and page-aligned internally
+ * like the other range operations. One bitmap entry is produced per page of
+ * the aligned range; the summary statistics are computed in the same pass.
+ */
+template<access_mode AccessMode, typename ByteT>
+page_residency basic_mmap<AccessMode, ByteT>::residency(const size_type offset,
+        const size_type length, std::error_code& error) const
+{
+    error.clear();
+    page_residency result;
+
+    if(!is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return result;
+    }
+
+    // Validate that the range lies within the mapping
+    if(offset > length_ || (length != map_entire_file && offset + length > length_))
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return result;
+    }
+
+    const size_type query_length =
+            length == map_entire_file ? length_ - offset : length;
+    if(query_length == 0) { return result; }
+
+    const size_type aligned_offset =
+            make_offset_page_aligned(mapping_offset() + offset);
+    const size_type aligned_length = std::min(
+            mapping_offset() + offset + query_length - aligned_offset,
+            mapped_length_ - aligned_offset);
+    char* const address =
+            const_cast<char*>(reinterpret_cast<const char*>(
+                    get_mapping_start())) + aligned_offset;
+
+    const size_t page_size_ = page_size();
+    const size_t num_pages = (aligned_length + page_size_ - 1) / page_size_;
+
+#ifdef _WIN32
+    std::vector<PSAPI_WORKING_SET_EX_INFORMATION> info(num_pages);
+    for(size_t i = 0; i < num_pages; ++i)
+    {
+        info[i].VirtualAddress = address + i * page_size_;
+    }
+    if(::QueryWorkingSetEx(::GetCurrentProcess(), info.data(),
+            static_cast<DWORD>(info.size() * sizeof(info[0]))) == 0)
+    {
+        error = detail::last_error();
+        return result;
+    }
+#else // POSIX
+    // mincore's vector parameter is unsigned char* on Linux but char* on
+    // BSD-derived systems (including macOS).
+    std::vector<unsigned char> info(num_pages);
+# ifdef __linux__
+    if(::mincore(address, aligned_length, info.data()) != 0)
+# else
+    if(::mincore(address, aligned_length,
+            reinterpret_cast<char*>(info.data())) != 0)
+# endif
+    {
+        error = detail::last_error();
+        return result;
+    }
+#endif
+
+    result.page_size = page_size_;
+    result.pages.resize(num_pages);
+    bool previous_resident = false;
+    for(size_t i = 0; i < num_pages; ++i)
+    {
+#ifdef _WIN32
+        const bool resident = info[i].VirtualAttributes.Valid != 0;
+#else
+        // Only the low bit of each mincore entry is defined.
+        const bool resident = (info[i] & 1) != 0;
+#endif
+        result.pages[i] = resident;
+        if(resident)
+        {
+            ++result.resident_pages;
+            if(!previous_resident) { ++result.resident_runs; }
+        }
+        previous_resident = resident;
+    }
+    return result;
+}
+
+/**
+ * Queries NUMA placement for a subrange of the mapping.
+ *
+ * Uses move_pages() in query mode (no target nodes), which reports the
+ * node currently holding each page, or a negative errno value (commonly
+ * -ENOENT) for pages that are not resident.
+ */
+template<access_mode AccessMode, typename ByteT>
+std::vector<int> basic_mmap<AccessMode, ByteT>::numa_nodes(const size_type offset,
+        const size_type length, std::error_code& error) const
+{
+    error.clear();
+    std::vector<int> nodes;
+
+    if(!is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return nodes;
+    }
+
+    // Validate that the range lies within the mapping
+    if(offset > length_ || (length != map_entire_file && offset + length > length_))
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return nodes;
+    }
+
+#ifdef __linux__
+    const size_type query_length =
+            length == map_entire_file ? length_ - offset : length;
+    if(query_length == 0) { return nodes; }
+
+    const size_type aligned_offset =
+            make_offset_page_aligned(mapping_offset() + offset);
+    const size_type aligned_length = std::min(
+            mapping_offset() + offset + query_length - aligned_offset,
+            mapped_length_ - aligned_offset);
+    char* const address =
+            const_cast<char*>(reinterpret_cast<const char*>(
+                    get_mapping_start())) + aligned_offset;
+
+    const size_t page_size_ = page_size();
+    const size_t num_pages = (aligned_length + page_size_ - 1) / page_size_;
+
+    std::vector<void*> pages(num_pages);
+    for(size_t i = 0; i < num_pages; ++i)
+    {
+        pages[i] = address + i * page_size_;
+    }
+    nodes.resize(num_pages);
+    if(::syscall(SYS_move_pages, 0, num_pages, pages.data(), nullptr,
+            nodes.data(), 0) != 0)
+    {
+        error = detail::last_error();
+        nodes.clear();
+    }
+#else
+    error = std::make_error_code(std::errc::function_not_supported);
+#endif
+    return nodes;
 }
 
 /**
@@ -586,6 +2043,8 @@ void basic_mmap<AccessMode, ByteT>::unmap()
 {
     if(!is_open()) { return; }
 
+    detail::stats_on_unmap(static_cast<uint64_t>(length_));
+
     // Step 1: Unmap the memory region
 #ifdef _WIN32
     if(is_mapped())
@@ -610,7 +2069,8 @@ void basic_mmap<AccessMode, ByteT>::unmap()
 
     // Step 3: Reset to default (unmapped) state
     data_ = nullptr;
-    length_ = mapped_length_ = 0;
+    length_ = mapped_length_ = page_granularity_ = file_offset_ = 0;
+    sync_map_ = false;
     file_handle_ = invalid_handle;
 #ifdef _WIN32
     file_mapping_handle_ = invalid_handle;
@@ -629,7 +2089,7 @@ bool basic_mmap<AccessMode, ByteT>::is_mapped() const noexcept
 #ifdef _WIN32
     return file_mapping_handle_ != invalid_handle;
 #else // POSIX
-    return is_open();
+    return data_ != nullptr;
 #endif
 }
 
@@ -651,6 +2111,9 @@ void basic_mmap<AccessMode, ByteT>::swap(basic_mmap& other) noexcept
 #endif
         swap(length_, other.length_);
         swap(mapped_length_, other.mapped_length_);
+        swap(page_granularity_, other.page_granularity_);
+        swap(sync_map_, other.sync_map_);
+        swap(file_offset_, other.file_offset_);
         swap(is_handle_internal_, other.is_handle_internal_);
     }
 }
@@ -729,6 +2192,89 @@ bool operator>=(const basic_mmap<AccessMode, ByteT>& a,
     return !(a < b);
 }
 
+// -----------------------------------------------------------------------------
+// Zero-copy range cloning
+// -----------------------------------------------------------------------------
+
+template<access_mode SrcAccessMode, access_mode DstAccessMode, typename ByteT>
+void clone_range(const basic_mmap<SrcAccessMode, ByteT>& source,
+        basic_mmap<DstAccessMode, ByteT>& dest, const size_t src_offset,
+        const size_t dst_offset, const size_t length, std::error_code& error)
+{
+    static_assert(DstAccessMode != access_mode::read,
+            "clone_range requires a writable destination");
+    error.clear();
+
+    if(!source.is_open() || !dest.is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return;
+    }
+
+    // Validate that both ranges lie within their mappings
+    if(src_offset > source.size()
+       || (length != map_entire_file
+           && length > source.size() - src_offset))
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
+    const size_t clone_length = length == map_entire_file
+            ? source.size() - src_offset : length;
+    if(dst_offset > dest.size() || clone_length > dest.size() - dst_offset)
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
+    if(clone_length == 0) { return; }
+
+#ifdef __linux__
+    // Kernel-offloaded path. Both ranges must be file-backed, the
+    // destination must be a shared (write) mapping - a copy-on-write
+    // destination is private, so writing its file would not be observed
+    // through the mapping - and the source must not be copy-on-write
+    // either: a COW source's dirty pages are private and never reach the
+    // file, so the kernel would copy stale file bytes instead of the
+    // live view. Dirty pages of shared mappings live in the page cache,
+    // which is exactly what copy_file_range() reads from and writes to,
+    // so no sync is needed on either side and on reflink filesystems
+    // (Btrfs, XFS) the extents are shared instead of copied.
+    if(DstAccessMode == access_mode::write
+       && SrcAccessMode != access_mode::copy_on_write
+       && source.file_handle() != invalid_handle
+       && dest.file_handle() != invalid_handle)
+    {
+        loff_t off_in = static_cast<loff_t>(
+                source.file_offset() + src_offset);
+        loff_t off_out = static_cast<loff_t>(
+                dest.file_offset() + dst_offset);
+        size_t remaining = clone_length;
+        while(remaining > 0)
+        {
+            const ssize_t copied = ::copy_file_range(source.file_handle(),
+                    &off_in, dest.file_handle(), &off_out, remaining, 0);
+            if(copied > 0)
+            {
+                remaining -= static_cast<size_t>(copied);
+                continue;
+            }
+            if(copied < 0 && errno == EINTR) { continue; }
+            // EXDEV (cross-filesystem on older kernels), EINVAL, ENOSYS,
+            // EOPNOTSUPP, or a short file: fall back below. Any partial
+            // progress went through the shared page cache, so redoing the
+            // whole range is safe.
+            break;
+        }
+        if(remaining == 0) { return; }
+    }
+#endif // __linux__
+
+    // Fallback: copy through the mappings, streaming around the CPU cache
+    // for large ranges.
+    detail::nontemporal_copy(dest.data() + dst_offset,
+            source.data() + src_offset, clone_length);
+}
+
 } // namespace mio
 
 #endif // MIO_BASIC_MMAP_IMPL
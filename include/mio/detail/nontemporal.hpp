@@ -0,0 +1,231 @@
+/* Copyright 2017 https://github.com/mandreyel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MIO_DETAIL_NONTEMPORAL_HEADER
+#define MIO_DETAIL_NONTEMPORAL_HEADER
+
+// -----------------------------------------------------------------------------
+// nontemporal.hpp - Cache-bypassing bulk copy and fill kernels
+// -----------------------------------------------------------------------------
+//
+// Low-level kernels behind mio::copy_to / mio::fill / mio::copy_from in
+// mmap.hpp. Writing a large range through the cache costs a
+// read-for-ownership on every destination line and evicts the working set
+// with data that will not be re-read; non-temporal (streaming) stores skip
+// both. On x86 the kernels use AVX or SSE2 streaming stores when the
+// compiler targets them, with a prefetchnta hint on the source; everywhere
+// else they compile to plain memcpy/memset.
+//
+// Small ranges always take the memcpy/memset path: below a few hundred KiB
+// the data plausibly fits in cache and bypassing it only hurts.
+//
+// -----------------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64) \
+        || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <immintrin.h>
+# define MIO_NONTEMPORAL_SIMD 1
+#endif
+
+namespace mio {
+namespace detail {
+
+/**
+ * Transfers below this size use plain memcpy/memset: the range plausibly
+ * fits in cache, where keeping it is a win and bypassing it a loss.
+ */
+inline constexpr size_t nontemporal_threshold = size_t(1) << 18; // 256 KiB
+
+#ifdef MIO_NONTEMPORAL_SIMD
+/** Source prefetch distance for the streaming loops. */
+inline constexpr size_t nontemporal_prefetch_distance = 512;
+#endif
+
+/**
+ * Copies `length` bytes from `src` to `dst`, with streaming stores for
+ * large ranges where the target supports them.
+ *
+ * The destination is brought to vector alignment with a scalar head,
+ * the bulk is streamed with unaligned loads and non-temporal stores,
+ * and the remainder is handled by memcpy. A store fence at the end
+ * makes the streamed data visible before the call returns, so callers
+ * need no ordering awareness.
+ *
+ * @param dst    Destination (no alignment requirement).
+ * @param src    Source (no alignment requirement, must not overlap dst).
+ * @param length Number of bytes to copy.
+ */
+inline void nontemporal_copy(void* const dst, const void* const src,
+        const size_t length)
+{
+#ifdef MIO_NONTEMPORAL_SIMD
+    if(length >= nontemporal_threshold)
+    {
+        unsigned char* d = static_cast<unsigned char*>(dst);
+        const unsigned char* s = static_cast<const unsigned char*>(src);
+        size_t n = length;
+
+# ifdef __AVX__
+        constexpr size_t vector_size = sizeof(__m256i);
+# else
+        constexpr size_t vector_size = sizeof(__m128i);
+# endif
+        const size_t misalignment =
+                reinterpret_cast<uintptr_t>(d) & (vector_size - 1);
+        if(misalignment != 0)
+        {
+            const size_t head = vector_size - misalignment;
+            std::memcpy(d, s, head);
+            d += head;
+            s += head;
+            n -= head;
+        }
+
+        while(n >= vector_size)
+        {
+            _mm_prefetch(reinterpret_cast<const char*>(s)
+                    + nontemporal_prefetch_distance, _MM_HINT_NTA);
+# ifdef __AVX__
+            _mm256_stream_si256(reinterpret_cast<__m256i*>(d),
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s)));
+# else
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(s)));
+# endif
+            d += vector_size;
+            s += vector_size;
+            n -= vector_size;
+        }
+        _mm_sfence();
+
+        if(n != 0) { std::memcpy(d, s, n); }
+        return;
+    }
+#endif // MIO_NONTEMPORAL_SIMD
+    std::memcpy(dst, src, length);
+}
+
+/**
+ * Fills `length` bytes at `dst` with `value`, with streaming stores for
+ * large ranges where the target supports them.
+ *
+ * Same structure as nontemporal_copy(): scalar head to alignment,
+ * streamed bulk, memset tail, store fence.
+ *
+ * @param dst    Destination (no alignment requirement).
+ * @param value  Byte value to fill with.
+ * @param length Number of bytes to fill.
+ */
+inline void nontemporal_fill(void* const dst, const unsigned char value,
+        const size_t length)
+{
+#ifdef MIO_NONTEMPORAL_SIMD
+    if(length >= nontemporal_threshold)
+    {
+        unsigned char* d = static_cast<unsigned char*>(dst);
+        size_t n = length;
+
+# ifdef __AVX__
+        constexpr size_t vector_size = sizeof(__m256i);
+        const __m256i pattern = _mm256_set1_epi8(static_cast<char>(value));
+# else
+        constexpr size_t vector_size = sizeof(__m128i);
+        const __m128i pattern = _mm_set1_epi8(static_cast<char>(value));
+# endif
+        const size_t misalignment =
+                reinterpret_cast<uintptr_t>(d) & (vector_size - 1);
+        if(misalignment != 0)
+        {
+            const size_t head = vector_size - misalignment;
+            std::memset(d, value, head);
+            d += head;
+            n -= head;
+        }
+
+        while(n >= vector_size)
+        {
+# ifdef __AVX__
+            _mm256_stream_si256(reinterpret_cast<__m256i*>(d), pattern);
+# else
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d), pattern);
+# endif
+            d += vector_size;
+            n -= vector_size;
+        }
+        _mm_sfence();
+
+        if(n != 0) { std::memset(d, value, n); }
+        return;
+    }
+#endif // MIO_NONTEMPORAL_SIMD
+    std::memset(dst, value, length);
+}
+
+#ifdef MIO_NONTEMPORAL_SIMD
+
+/** Cacheline granularity assumed by flush_cachelines(). */
+inline constexpr size_t cacheline_size = 64;
+
+/**
+ * Flushes every cacheline covering [address, address + length) to the
+ * memory controller and fences.
+ *
+ * On persistent-memory (DAX/CXL) mappings this is the whole durability
+ * story: once the lines have left the cache hierarchy, ADR guarantees
+ * they reach media. Uses clwb where the build targets it (keeps the line
+ * cached), clflushopt next, and the universally available clflush
+ * otherwise.
+ *
+ * Only defined on x86 targets; MIO_CACHELINE_FLUSH advertises its
+ * availability so callers can fall back to msync().
+ *
+ * @param address Start of the range (no alignment requirement).
+ * @param length  Number of bytes whose lines to flush.
+ */
+inline void flush_cachelines(const void* const address, const size_t length)
+{
+    const char* line = reinterpret_cast<const char*>(
+            reinterpret_cast<uintptr_t>(address) & ~(cacheline_size - 1));
+    const char* const end =
+            reinterpret_cast<const char*>(address) + length;
+    for(; line < end; line += cacheline_size)
+    {
+# if defined(__CLWB__)
+        _mm_clwb(const_cast<char*>(line));
+# elif defined(__CLFLUSHOPT__)
+        _mm_clflushopt(const_cast<char*>(line));
+# else
+        _mm_clflush(line);
+# endif
+    }
+    _mm_sfence();
+}
+
+# define MIO_CACHELINE_FLUSH 1
+#endif // MIO_NONTEMPORAL_SIMD
+
+} // namespace detail
+} // namespace mio
+
+#endif // MIO_DETAIL_NONTEMPORAL_HEADER
@@ -0,0 +1,306 @@
+/* Copyright 2017 https://github.com/mandreyel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MIO_FILE_SOURCE_HEADER
+#define MIO_FILE_SOURCE_HEADER
+
+// -----------------------------------------------------------------------------
+// file_source.hpp - Hybrid read/mmap file source selected by file size
+// -----------------------------------------------------------------------------
+//
+// This header provides basic_file_source, a read-only file view with the
+// same data()/begin()/end() interface as basic_mmap_source that picks the
+// cheaper I/O path per file: files at or under a size threshold are read
+// into an internal buffer with one pread()/ReadFile, larger files are
+// memory-mapped.
+//
+// Small files are mmap's worst case - the map + fault + munmap cycle
+// (plus the TLB shootdown at unmap) costs several times a single read
+// into a warm buffer, while for large files mapping avoids the copy
+// entirely. The hybrid gives callers one type and the right syscall path
+// for both size classes.
+//
+// Usage:
+//   std::error_code ec;
+//   mio::file_source meta;
+//   meta.open("shard-0007.meta", ec);   // ~4KB file: buffered read
+//   if (ec) { handle_error(ec); }
+//   parse(meta.data(), meta.size());
+//
+// The buffer is retained across open() calls on the same object, so a
+// loop reading many small files through one file_source reuses a single
+// allocation.
+//
+// -----------------------------------------------------------------------------
+
+#include "mio/mmap.hpp"
+
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace mio {
+
+// -----------------------------------------------------------------------------
+// basic_file_source - Size-aware read path selection
+// -----------------------------------------------------------------------------
+
+/**
+ * A read-only view of a file that is buffered or memory-mapped depending
+ * on the file's size.
+ *
+ * Files at or under the threshold are read whole into an internal buffer
+ * and the file is closed before open() returns - no mapping, no page
+ * faults, no unmap shootdown. Larger files are memory-mapped as with
+ * basic_mmap_source. Which path was taken is observable through
+ * is_mapped(), but the read interface is identical either way.
+ *
+ * Unlike a mapping, a buffered view is a snapshot: later changes to the
+ * file are not reflected. Treat the view as valid-at-open in both modes.
+ *
+ * @tparam ByteT The byte type for the data. Must be 1 byte in size.
+ *
+ * Ownership semantics: move-only RAII, like basic_mmap.
+ */
+template<typename ByteT>
+class basic_file_source
+{
+public:
+    using mmap_type = basic_mmap_source<ByteT>;
+    using value_type = typename mmap_type::value_type;
+    using size_type = typename mmap_type::size_type;
+    using const_pointer = typename mmap_type::const_pointer;
+    using const_reference = typename mmap_type::const_reference;
+    using const_iterator = const_pointer;
+
+    static_assert(sizeof(ByteT) == 1, "ByteT must be 1 byte in size");
+
+    /// Default size threshold (64KB) at or under which files are buffered.
+    static constexpr size_type default_threshold = size_type(1) << 16;
+
+private:
+    mmap_type map_;
+    std::vector<value_type> buffer_;
+    // Handle backing the mapped path; basic_mmap treats handles it was
+    // given as caller-owned, so this class closes it.
+    file_handle_type owned_handle_ = invalid_handle;
+    size_type threshold_ = default_threshold;
+    bool buffered_ = false;
+
+public:
+    /**
+     * Constructs a closed source.
+     *
+     * @param threshold Files of this many bytes or fewer are buffered;
+     *                  larger ones are mapped. 0 maps everything.
+     */
+    explicit basic_file_source(
+            const size_type threshold = default_threshold) noexcept
+        : threshold_(threshold)
+    {}
+
+    basic_file_source(basic_file_source&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    // Manual moves: owned_handle_ is a plain scalar, so a defaulted move
+    // would leave it set in the moved-from object, whose close() would
+    // then close the fd the destination's mapping still depends on.
+    basic_file_source& operator=(basic_file_source&& other) noexcept
+    {
+        if(this != &other)
+        {
+            close();
+            map_ = std::move(other.map_);
+            buffer_ = std::move(other.buffer_);
+            owned_handle_ = std::exchange(other.owned_handle_,
+                    invalid_handle);
+            threshold_ = std::exchange(other.threshold_, default_threshold);
+            buffered_ = std::exchange(other.buffered_, false);
+        }
+        return *this;
+    }
+
+    basic_file_source(const basic_file_source&) = delete;
+    basic_file_source& operator=(const basic_file_source&) = delete;
+
+    /**
+     * Opens the file at `path`, buffering or mapping it by size.
+     *
+     * @param path  Path of the file to open.
+     * @param error Output parameter for error reporting.
+     */
+    void open(const std::filesystem::path& path, std::error_code& error)
+    {
+        error.clear();
+
+        const auto handle =
+                detail::open_file(path, access_mode::read, error);
+        if(error) { return; }
+
+        const auto file_size = detail::query_file_size(handle, error);
+        if(error)
+        {
+            detail::close_file(handle);
+            return;
+        }
+
+        if(static_cast<size_type>(file_size) > threshold_)
+        {
+            mmap_type map;
+            map.map(handle, 0, map_entire_file, error);
+            if(error)
+            {
+                detail::close_file(handle);
+                return;
+            }
+            close();
+            map_ = std::move(map);
+            // The mapping treats the handle as caller-owned; adopt it so
+            // unmapping through close() also closes the file.
+            owned_handle_ = handle;
+            return;
+        }
+
+        // Small file: one read into the (reused) buffer, then the file is
+        // closed - nothing to fault and nothing to tear down later.
+        std::vector<value_type> buffer;
+        buffer.swap(buffer_); // reuse the previous allocation
+        buffer.resize(static_cast<size_t>(file_size));
+        size_type total = 0;
+        while(total < static_cast<size_type>(file_size))
+        {
+#ifdef _WIN32
+            DWORD read = 0;
+            OVERLAPPED overlapped = {};
+            overlapped.Offset = detail::win::int64_low(
+                    static_cast<int64_t>(total));
+            overlapped.OffsetHigh = detail::win::int64_high(
+                    static_cast<int64_t>(total));
+            if(::ReadFile(handle, buffer.data() + total,
+                    static_cast<DWORD>(file_size - total),
+                    &read, &overlapped) == 0)
+            {
+                error = detail::last_error();
+                detail::close_file(handle);
+                return;
+            }
+#else
+            const ssize_t read = ::pread(handle, buffer.data() + total,
+                    static_cast<size_t>(file_size - total),
+                    static_cast<off_t>(total));
+            if(read < 0)
+            {
+                if(errno == EINTR) { continue; }
+                error = detail::last_error();
+                detail::close_file(handle);
+                return;
+            }
+#endif
+            if(read == 0) { break; } // file shrank underneath us
+            total += static_cast<size_type>(read);
+        }
+        detail::close_file(handle);
+
+        close();
+        buffer.resize(static_cast<size_t>(total));
+        buffer_ = std::move(buffer);
+        buffered_ = true;
+    }
+
+    /** Releases the buffer or mapping. Safe to call when closed. */
+    void close()
+    {
+        map_.unmap();
+        if(owned_handle_ != invalid_handle)
+        {
+            detail::close_file(owned_handle_);
+            owned_handle_ = invalid_handle;
+        }
+        buffer_.clear();
+        buffered_ = false;
+    }
+
+    ~basic_file_source() { close(); }
+
+    /** Returns whether a file is open. */
+    [[nodiscard]] bool is_open() const noexcept
+    {
+        return buffered_ || map_.is_open();
+    }
+
+    /** Returns whether the file was memory-mapped (vs buffered). */
+    [[nodiscard]] bool is_mapped() const noexcept { return map_.is_open(); }
+
+    /** Returns the buffering threshold in bytes. */
+    [[nodiscard]] size_type threshold() const noexcept { return threshold_; }
+
+    /** Returns the file size in bytes (0 when closed). */
+    [[nodiscard]] size_type size() const noexcept
+    {
+        return buffered_ ? static_cast<size_type>(buffer_.size())
+                : map_.size();
+    }
+
+    /** Returns whether the source is empty (closed or zero-length file). */
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+    /** Returns a pointer to the first byte of the data. */
+    [[nodiscard]] const_pointer data() const noexcept
+    {
+        return buffered_ ? buffer_.data() : map_.data();
+    }
+
+    /** Returns an iterator to the first byte. */
+    [[nodiscard]] const_iterator begin() const noexcept { return data(); }
+
+    /** Returns an iterator one past the last byte. */
+    [[nodiscard]] const_iterator end() const noexcept
+    {
+        return data() + size();
+    }
+
+    /** Returns the byte at index `i` (no bounds checking). */
+    [[nodiscard]] const_reference operator[](const size_type i) const noexcept
+    {
+        return data()[i];
+    }
+
+#if __cplusplus >= 202002L
+    /** Returns the data as a read-only std::span. */
+    [[nodiscard]] std::span<const value_type> as_span() const noexcept
+    {
+        return {data(), size()};
+    }
+#endif
+};
+
+// -----------------------------------------------------------------------------
+// Convenience type aliases
+// -----------------------------------------------------------------------------
+
+using file_source = basic_file_source<char>;           ///< Hybrid source, char
+using ufile_source = basic_file_source<unsigned char>; ///< Hybrid source, unsigned char
+using bfile_source = basic_file_source<std::byte>;     ///< Hybrid source, std::byte
+
+} // namespace mio
+
+#endif // MIO_FILE_SOURCE_HEADER
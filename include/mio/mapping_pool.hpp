@@ -0,0 +1,448 @@
+/* Copyright 2017 https://github.com/mandreyel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MIO_MAPPING_POOL_HEADER
+#define MIO_MAPPING_POOL_HEADER
+
+// -----------------------------------------------------------------------------
+// mapping_pool.hpp - Reusable address-space reservation for high-churn mapping
+// -----------------------------------------------------------------------------
+//
+// This header provides mapping_pool, which reserves one large contiguous
+// PROT_NONE address range up front and serves read-only file mappings out
+// of fixed-size slots within it. Releasing a slot replaces its pages with
+// a fresh reservation instead of unmapping, so the slot can be reused by
+// the next file.
+//
+// Mapping and unmapping millions of small files through plain mmap()
+// pays, per cycle: a VMA allocation, an address-space search for a free
+// range, and - the expensive part on many-core hosts - an unmap-time TLB
+// shootdown broadcast to every thread in the process. With a pool, the
+// VMA count stays constant, the address-space search happens once, and
+// shootdowns are confined to one slot's worth of pages.
+//
+// Usage:
+//   std::error_code ec;
+//   mio::mapping_pool pool;
+//   pool.open(1 << 20, 256, ec);              // 256 slots of 1MiB
+//   auto view = pool.map_into_pool(path, ec); // mapped into a free slot
+//   scan(view.data(), view.size());
+//   // view's destructor recycles the slot
+//
+// The pool is thread-safe: slots may be acquired and released from any
+// thread. Views must not outlive the pool.
+//
+// On Windows, carving file views out of a reservation requires the
+// placeholder APIs (VirtualAlloc2/MapViewOfFile3, Windows 10 1803+),
+// which mio's minimum API level does not assume; there the pool falls
+// back to regular per-file mappings and only enforces the slot budget.
+//
+// -----------------------------------------------------------------------------
+
+#include "mio/mmap.hpp"
+
+#include <mutex>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace mio {
+
+/**
+ * A pool of fixed-size address-space slots that read-only file mappings
+ * are recycled through.
+ *
+ * open() reserves slot_size * slot_count bytes of address space once
+ * (PROT_NONE, so it consumes no memory); map_into_pool() maps a file
+ * over a free slot with MAP_FIXED, and releasing the returned view
+ * re-reserves the slot for the next file. Files larger than a slot are
+ * rejected with std::errc::file_too_large - size slots for the largest
+ * file the workload produces.
+ *
+ * Ownership semantics: neither copyable nor movable; outstanding views
+ * hold a pointer to the pool.
+ */
+class mapping_pool
+{
+public:
+    /**
+     * A read-only view of a file mapped into a pool slot.
+     *
+     * Move-only RAII: the destructor (or release()) returns the slot to
+     * the pool. The view must be released before the pool is closed or
+     * destroyed.
+     */
+    class mapping
+    {
+        friend class mapping_pool;
+
+        mapping_pool* pool_ = nullptr;
+        size_t slot_ = 0;
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+#ifdef _WIN32
+        basic_mmap_source<char> map_; // fallback mapping, no slot reuse
+#endif
+
+        mapping(mapping_pool* pool, const size_t slot, const char* data,
+                const size_t size) noexcept
+            : pool_(pool), slot_(slot), data_(data), size_(size)
+        {}
+
+    public:
+        mapping() = default;
+
+        mapping(mapping&& other) noexcept { *this = std::move(other); }
+
+        mapping& operator=(mapping&& other) noexcept
+        {
+            if(this != &other)
+            {
+                release();
+                pool_ = std::exchange(other.pool_, nullptr);
+                slot_ = std::exchange(other.slot_, 0);
+                data_ = std::exchange(other.data_, nullptr);
+                size_ = std::exchange(other.size_, 0);
+#ifdef _WIN32
+                map_ = std::move(other.map_);
+#endif
+            }
+            return *this;
+        }
+
+        mapping(const mapping&) = delete;
+        mapping& operator=(const mapping&) = delete;
+
+        ~mapping() { release(); }
+
+        /** Returns the slot to the pool. Safe to call when empty. */
+        void release()
+        {
+            if(pool_)
+            {
+#ifdef _WIN32
+                map_.unmap();
+#endif
+                pool_->release_slot(slot_);
+                pool_ = nullptr;
+                data_ = nullptr;
+                size_ = 0;
+            }
+        }
+
+        /** Returns whether the view holds a mapped file. */
+        [[nodiscard]] bool is_open() const noexcept { return pool_ != nullptr; }
+
+        /** Returns the file size in bytes. */
+        [[nodiscard]] size_t size() const noexcept { return size_; }
+
+        /** Returns whether the view is empty. */
+        [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+        /** Returns a pointer to the first byte of the file's data. */
+        [[nodiscard]] const char* data() const noexcept { return data_; }
+
+        /** Returns an iterator to the first byte. */
+        [[nodiscard]] const char* begin() const noexcept { return data_; }
+
+        /** Returns an iterator one past the last byte. */
+        [[nodiscard]] const char* end() const noexcept
+        {
+            return data_ + size_;
+        }
+
+        /** Returns the byte at index `i` (no bounds checking). */
+        [[nodiscard]] char operator[](const size_t i) const noexcept
+        {
+            return data_[i];
+        }
+
+#if __cplusplus >= 202002L
+        /** Returns the data as a read-only std::span. */
+        [[nodiscard]] std::span<const char> as_span() const noexcept
+        {
+            return {data_, size_};
+        }
+#endif
+    };
+
+private:
+    char* base_ = nullptr;
+    size_t slot_size_ = 0;
+    size_t slot_count_ = 0;
+    std::vector<size_t> free_slots_;
+    std::mutex mutex_;
+
+public:
+    mapping_pool() = default;
+
+    mapping_pool(const mapping_pool&) = delete;
+    mapping_pool& operator=(const mapping_pool&) = delete;
+
+    ~mapping_pool() { close(); }
+
+    /**
+     * Reserves the pool's address range.
+     *
+     * @param slot_size  Bytes per slot; rounded up to a page multiple.
+     *                   Files up to this size can be mapped into a slot.
+     * @param slot_count Number of slots, i.e. the maximum number of
+     *                   concurrently mapped files.
+     * @param error      Output parameter for error reporting.
+     */
+    void open(const size_t slot_size, const size_t slot_count,
+            std::error_code& error)
+    {
+        error.clear();
+
+        if(is_open() || slot_size == 0 || slot_count == 0)
+        {
+            error = std::make_error_code(std::errc::invalid_argument);
+            return;
+        }
+
+        const size_t page_mask = page_size() - 1;
+        const size_t aligned_slot = (slot_size + page_mask) & ~page_mask;
+
+#ifndef _WIN32
+        // One PROT_NONE reservation covers every slot. MAP_NORESERVE
+        // (where it exists) makes explicit that no swap is committed;
+        // PROT_NONE memory is never touched anyway.
+        const int flags = MAP_PRIVATE | MAP_ANONYMOUS
+#ifdef MAP_NORESERVE
+                | MAP_NORESERVE
+#endif
+                ;
+        void* const reservation = ::mmap(nullptr, aligned_slot * slot_count,
+                PROT_NONE, flags, -1, 0);
+        if(reservation == MAP_FAILED)
+        {
+            error = detail::last_error();
+            return;
+        }
+        base_ = static_cast<char*>(reservation);
+#endif // !_WIN32
+
+        slot_size_ = aligned_slot;
+        slot_count_ = slot_count;
+        free_slots_.clear();
+        free_slots_.reserve(slot_count);
+        // Hand out low slots first so a lightly loaded pool stays compact.
+        for(size_t slot = slot_count; slot > 0; --slot)
+        {
+            free_slots_.push_back(slot - 1);
+        }
+    }
+
+    /** Returns whether the pool has been opened. */
+    [[nodiscard]] bool is_open() const noexcept { return slot_count_ != 0; }
+
+    /** Returns the (page-aligned) slot size in bytes. */
+    [[nodiscard]] size_t slot_size() const noexcept { return slot_size_; }
+
+    /** Returns the total number of slots. */
+    [[nodiscard]] size_t slot_count() const noexcept { return slot_count_; }
+
+    /** Returns the number of currently unused slots. */
+    [[nodiscard]] size_t free_slots()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return free_slots_.size();
+    }
+
+    /**
+     * Maps the file at `path` read-only into a free slot.
+     *
+     * The file is opened, mapped over the slot's reserved pages, and
+     * closed again before returning; the returned view keeps the mapping
+     * alive. Errors: std::errc::file_too_large if the file exceeds the
+     * slot size, std::errc::no_buffer_space if every slot is in use,
+     * plus the usual open/mmap failures.
+     *
+     * @param path  Path of the file to map.
+     * @param error Output parameter for error reporting.
+     * @return The mapped view; empty on error.
+     */
+    template<typename Path>
+    mapping map_into_pool(const Path& path, std::error_code& error)
+    {
+        error.clear();
+
+        if(!is_open())
+        {
+            error = std::make_error_code(std::errc::bad_file_descriptor);
+            return {};
+        }
+
+#ifndef _WIN32
+        // The full-arity overload resolves to the allocation-free native
+        // open_file() when `path` is a const char*.
+        const auto handle = detail::open_file(path, access_mode::read,
+                false, advice::normal, error);
+        if(error) { return {}; }
+
+        const auto file_size = detail::query_file_size(handle, error);
+        if(error)
+        {
+            detail::close_file(handle);
+            return {};
+        }
+        if(file_size > slot_size_)
+        {
+            detail::close_file(handle);
+            error = std::make_error_code(std::errc::file_too_large);
+            return {};
+        }
+
+        size_t slot = 0;
+        if(!acquire_slot(slot))
+        {
+            detail::close_file(handle);
+            error = std::make_error_code(std::errc::no_buffer_space);
+            return {};
+        }
+
+        char* const address = base_ + slot * slot_size_;
+        if(file_size > 0)
+        {
+            // MAP_FIXED replaces the slot's reservation pages in place:
+            // no address-space search and no new VMA beyond the split.
+            if(::mmap(address, file_size, PROT_READ, MAP_SHARED | MAP_FIXED,
+                    handle, 0) == MAP_FAILED)
+            {
+                error = detail::last_error();
+                detail::close_file(handle);
+                release_slot(slot);
+                return {};
+            }
+        }
+        // The mapping keeps the file referenced; the descriptor is not
+        // needed anymore.
+        detail::close_file(handle);
+
+        return mapping(this, slot, address, file_size);
+#else // _WIN32
+        // Fallback: a regular mapping at a system-chosen address. The
+        // slot budget still applies so callers see uniform behavior.
+        size_t slot = 0;
+        if(!acquire_slot(slot))
+        {
+            error = std::make_error_code(std::errc::no_buffer_space);
+            return {};
+        }
+
+        basic_mmap_source<char> map;
+        map.map(path, error);
+        if(error)
+        {
+            release_slot(slot);
+            return {};
+        }
+        if(map.size() > slot_size_)
+        {
+            release_slot(slot);
+            error = std::make_error_code(std::errc::file_too_large);
+            return {};
+        }
+
+        mapping view(this, slot, map.data(), map.size());
+        view.map_ = std::move(map);
+        view.data_ = view.map_.data();
+        return view;
+#endif // _WIN32
+    }
+
+    /**
+     * Releases the pool's address range.
+     *
+     * All views must have been released first; closing with slots still
+     * in use fails with std::errc::device_or_resource_busy.
+     *
+     * @param error Output parameter for error reporting.
+     */
+    void close(std::error_code& error)
+    {
+        error.clear();
+        if(!is_open()) { return; }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if(free_slots_.size() != slot_count_)
+            {
+                error = std::make_error_code(
+                        std::errc::device_or_resource_busy);
+                return;
+            }
+        }
+#ifndef _WIN32
+        ::munmap(base_, slot_size_ * slot_count_);
+#endif
+        base_ = nullptr;
+        slot_size_ = 0;
+        slot_count_ = 0;
+        free_slots_.clear();
+    }
+
+    /** Destructor variant of close(): outstanding views become dangling. */
+    void close()
+    {
+#ifndef _WIN32
+        if(base_) { ::munmap(base_, slot_size_ * slot_count_); }
+#endif
+        base_ = nullptr;
+        slot_size_ = 0;
+        slot_count_ = 0;
+        free_slots_.clear();
+    }
+
+private:
+    bool acquire_slot(size_t& slot)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(free_slots_.empty()) { return false; }
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+        return true;
+    }
+
+    void release_slot(const size_t slot)
+    {
+#ifndef _WIN32
+        // Replace the file pages with a fresh PROT_NONE reservation in
+        // one call. This shoots down only this slot's TLB entries and
+        // keeps the address range reserved for the next file.
+        if(base_)
+        {
+            const int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED
+#ifdef MAP_NORESERVE
+                    | MAP_NORESERVE
+#endif
+                    ;
+            ::mmap(base_ + slot * slot_size_, slot_size_, PROT_NONE, flags,
+                    -1, 0);
+        }
+#endif // !_WIN32
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_slots_.push_back(slot);
+    }
+};
+
+} // namespace mio
+
+#endif // MIO_MAPPING_POOL_HEADER
@@ -0,0 +1,242 @@
+/* Copyright 2017 https://github.com/mandreyel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MIO_MEMORY_RESOURCE_HEADER
+#define MIO_MEMORY_RESOURCE_HEADER
+
+// -----------------------------------------------------------------------------
+// memory_resource.hpp - std::pmr allocation out of a memory mapping
+// -----------------------------------------------------------------------------
+//
+// This header provides mapped_memory_resource, a std::pmr::memory_resource
+// that carves allocations out of a single mapping - file-backed or
+// anonymous - with bump-pointer allocation and whole-arena release.
+//
+// Building a large intermediate structure (hash table, sorted run) in heap
+// containers and copying it into a mapping at the end of a stage pays for
+// the data twice; pmr containers allocating directly inside the mapping
+// pay once, can be persisted with sync(), and the whole arena is reclaimed
+// in O(1) by release() - one madvise instead of running destructors over
+// millions of nodes.
+//
+// Usage:
+//   std::error_code ec;
+//   mio::mapped_memory_resource arena;
+//   arena.open("run-0.bin", 1 << 30, ec);           // or open_anonymous()
+//   if (ec) { handle_error(ec); }
+//   std::pmr::vector<entry> entries(&arena);
+//   ... build ...
+//   arena.sync(ec);                                  // persist the stage
+//   arena.release();                                 // O(1) reclaim, reuse
+//
+// Deallocation is a no-op (monotonic); the arena's memory is reused only
+// after release(). Trivially-destructible element types skip destructor
+// runs entirely; types with owning destructors still need them run before
+// release(), as with std::pmr::monotonic_buffer_resource.
+//
+// -----------------------------------------------------------------------------
+
+#include "mio/mmap.hpp"
+
+#include <filesystem>
+#include <memory_resource>
+#include <new>
+#include <system_error>
+
+namespace mio {
+
+// -----------------------------------------------------------------------------
+// mapped_memory_resource - Bump allocator over a single mapping
+// -----------------------------------------------------------------------------
+
+/**
+ * A std::pmr::memory_resource allocating from a memory-mapped arena.
+ *
+ * Allocation bumps an offset through the mapping; deallocate() is a no-op
+ * and release() rewinds the whole arena at once. When the arena is
+ * exhausted, allocation throws std::bad_alloc (the pmr contract) - there
+ * is no upstream resource, since falling back to the heap would silently
+ * defeat the point of placing the data in the mapping.
+ *
+ * Ownership semantics: neither copyable nor movable - containers hold a
+ * raw pointer to their memory_resource, so the object must stay put for
+ * the lifetime of everything allocated from it.
+ *
+ * Thread safety: none, like monotonic_buffer_resource; use one arena per
+ * thread or synchronize externally.
+ */
+class mapped_memory_resource final : public std::pmr::memory_resource
+{
+    basic_mmap_sink<char> map_;
+    size_t offset_ = 0;
+
+public:
+    /** Constructs a closed arena; open one of the backings before use. */
+    mapped_memory_resource() = default;
+
+    mapped_memory_resource(const mapped_memory_resource&) = delete;
+    mapped_memory_resource& operator=(const mapped_memory_resource&) = delete;
+
+    /**
+     * Opens a file-backed arena of `capacity` bytes at `path`.
+     *
+     * The file is created if missing and grown to the capacity (it is
+     * never truncated), so a fresh path yields a zeroed arena and the
+     * arena's contents can be persisted with sync() and re-mapped later.
+     *
+     * @param path     Path of the backing file.
+     * @param capacity Size of the arena in bytes.
+     * @param error    Output parameter for error reporting.
+     */
+    void open(const std::filesystem::path& path, const size_t capacity,
+            std::error_code& error)
+    {
+        map_options options;
+        options.create = true;
+        open(path, capacity, options, error);
+    }
+
+    /**
+     * Opens a file-backed arena with explicit mapping options.
+     *
+     * options.create is forced on; the other options (huge pages, NUMA
+     * placement, prefaulting) apply as for any write mapping.
+     *
+     * @param path     Path of the backing file.
+     * @param capacity Size of the arena in bytes.
+     * @param options  Mapping options for the arena.
+     * @param error    Output parameter for error reporting.
+     */
+    void open(const std::filesystem::path& path, const size_t capacity,
+            map_options options, std::error_code& error)
+    {
+        options.create = true;
+        map_.map(path, 0, capacity, options, error);
+        if(!error) { offset_ = 0; }
+    }
+
+    /**
+     * Opens an anonymous arena of `capacity` bytes.
+     *
+     * Backed by demand-zero memory: nothing to persist, but release()
+     * still reclaims the pages in O(1).
+     *
+     * @param capacity Size of the arena in bytes.
+     * @param error    Output parameter for error reporting.
+     */
+    void open_anonymous(const size_t capacity, std::error_code& error)
+    {
+        map_.map_anonymous(capacity, error);
+        if(!error) { offset_ = 0; }
+    }
+
+    /** Returns whether an arena is open. */
+    [[nodiscard]] bool is_open() const noexcept { return map_.is_open(); }
+
+    /** Returns the arena size in bytes (0 when closed). */
+    [[nodiscard]] size_t capacity() const noexcept { return map_.size(); }
+
+    /** Returns the number of bytes allocated (including alignment waste). */
+    [[nodiscard]] size_t used() const noexcept { return offset_; }
+
+    /** Returns the number of bytes still allocatable. */
+    [[nodiscard]] size_t remaining() const noexcept
+    {
+        return map_.size() - offset_;
+    }
+
+    /** Returns the underlying mapping, e.g. for advise() or residency(). */
+    [[nodiscard]] const basic_mmap_sink<char>& mapping() const noexcept
+    {
+        return map_;
+    }
+
+    /**
+     * Rewinds the arena: every allocation is invalidated and the full
+     * capacity becomes available again.
+     *
+     * The backing pages are released with advice::dont_need so physical
+     * memory is reclaimed immediately instead of lingering until memory
+     * pressure; the hint is best-effort and its failure is ignored.
+     */
+    void release() noexcept
+    {
+        offset_ = 0;
+        if(map_.is_open())
+        {
+            std::error_code ignored;
+            map_.advise(advice::dont_need, ignored);
+        }
+    }
+
+    /**
+     * Flushes the allocated prefix of a file-backed arena to disk.
+     *
+     * A no-op for anonymous arenas. Only the used part of the arena is
+     * written back; the untouched tail has no dirty pages anyway.
+     *
+     * @param error Output parameter for error reporting.
+     */
+    void sync(std::error_code& error)
+    {
+        error.clear();
+        if(offset_ == 0) { return; }
+        map_.sync(0, offset_, sync_mode::sync, error);
+    }
+
+    /** Unmaps the arena. Allocations are invalidated. */
+    void close()
+    {
+        map_.unmap();
+        offset_ = 0;
+    }
+
+protected:
+    void* do_allocate(const size_t bytes, const size_t alignment) override
+    {
+        // Bump the offset to the requested alignment; alignment is a power
+        // of two per the memory_resource contract, and the mapping itself
+        // is page-aligned, so aligning the offset aligns the pointer.
+        const size_t aligned = (offset_ + alignment - 1) & ~(alignment - 1);
+        if(!map_.is_open() || aligned < offset_
+           || aligned > map_.size() || bytes > map_.size() - aligned)
+        {
+            throw std::bad_alloc();
+        }
+        offset_ = aligned + bytes;
+        return map_.data() + aligned;
+    }
+
+    void do_deallocate(void*, size_t, size_t) override
+    {
+        // Monotonic: individual deallocation is a no-op; release() or
+        // close() reclaims everything at once.
+    }
+
+    [[nodiscard]] bool do_is_equal(
+            const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+} // namespace mio
+
+#endif // MIO_MEMORY_RESOURCE_HEADER
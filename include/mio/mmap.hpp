@@ -60,6 +60,7 @@
 //
 // -----------------------------------------------------------------------------
 
+#include "mio/detail/nontemporal.hpp"
 #include "mio/page.hpp"
 
 #include <iterator>
@@ -68,6 +69,7 @@
 #include <cstdint>
 #include <cstddef>
 #include <filesystem>
+#include <vector>
 
 #if __cplusplus >= 202002L
 #include <span>
@@ -102,6 +104,228 @@ namespace mio {
  */
 inline constexpr size_t map_entire_file = 0;
 
+/**
+ * Memory-access advice for a mapped region.
+ *
+ * These hints tell the kernel how the application intends to access the
+ * mapped pages so it can tune readahead and page-cache behavior. They map
+ * onto `madvise()` on POSIX and `PrefetchVirtualMemory`/`DiscardVirtualMemory`
+ * on Windows (where no direct equivalent exists, the hint is a no-op).
+ *
+ * Typical uses:
+ * - `sequential` before a linear scan: aggressive readahead keeps the scan
+ *   at device bandwidth.
+ * - `random` before index lookups: disables readahead so point accesses do
+ *   not pollute the page cache with unwanted neighboring pages.
+ * - `will_need` to asynchronously prefetch a range that is about to be used.
+ * - `dont_need` / `free` to release pages that will not be touched again.
+ *
+ * @see basic_mmap::advise()
+ */
+enum class advice
+{
+    normal,      ///< Reset to default kernel behavior (MADV_NORMAL).
+    sequential,  ///< Expect sequential access; enables aggressive readahead (MADV_SEQUENTIAL).
+    random,      ///< Expect random access; disables readahead (MADV_RANDOM).
+    will_need,   ///< Range will be accessed soon; prefetch it (MADV_WILLNEED).
+    dont_need,   ///< Range will not be accessed soon; pages may be reclaimed (MADV_DONTNEED).
+    free         ///< Contents are disposable; lazily reclaimable (MADV_FREE, falls back to MADV_DONTNEED).
+};
+
+/**
+ * Durability tier for sync() operations.
+ *
+ * Flushing a large dirty mapping with full durability can block for hundreds
+ * of milliseconds; most of the time only a small range actually needs to be
+ * durable, or the caller merely wants writeback scheduled in the background.
+ * The tiers let callers pick the cheapest semantics that are still correct
+ * for them (e.g. a write-ahead-log writer can issue async range flushes per
+ * transaction and a single full flush at group-commit time).
+ *
+ * Platform behavior:
+ * - `async`: schedule writeback of the range and return immediately
+ *   (msync MS_ASYNC / FlushViewOfFile without FlushFileBuffers).
+ * - `sync`: wait until the range's data has been written
+ *   (msync MS_SYNC / FlushViewOfFile + FlushFileBuffers).
+ * - `full`: `sync` plus a file-level flush (fsync) so file metadata
+ *   (size, allocation) is durable as well.
+ */
+enum class sync_mode
+{
+    async,  ///< Initiate writeback of the range without waiting.
+    sync,   ///< Block until the range's data is written.
+    full    ///< Block until data and file metadata are durable.
+};
+
+/**
+ * Page-size selection for a mapping.
+ *
+ * Large ("huge") pages reduce TLB misses and the number of page faults taken
+ * while warming up big mappings, at the cost of coarser-grained memory
+ * accounting. They are strictly opt-in.
+ *
+ * Platform behavior:
+ * - Linux: `MAP_HUGETLB` (with an explicit 2MB/1GB size where requested).
+ *   Explicit hugetlb mappings require hugetlbfs backing; when that is
+ *   unavailable (the common case for regular files), the mapping falls back
+ *   to normal pages with `MADV_HUGEPAGE` so transparent huge pages can
+ *   still be used.
+ * - Windows: `SEC_LARGE_PAGES` in CreateFileMapping (requires the
+ *   SeLockMemoryPrivilege); falls back to normal pages on failure.
+ *
+ * Use basic_mmap::page_granularity() to find out what a mapping actually got.
+ */
+enum class page_mode
+{
+    normal,    ///< Default system page size.
+    huge,      ///< System default huge page size (see mio::large_page_size()).
+    huge_2mb,  ///< Explicit 2MB huge pages.
+    huge_1gb   ///< Explicit 1GB huge pages.
+};
+
+/**
+ * Memory-placement policy for a mapping on NUMA systems.
+ *
+ * A mapping faulted in by one thread lands entirely on that thread's node
+ * under the kernel's default first-touch policy; readers on the other
+ * socket then pay cross-node memory latency on every access. These
+ * policies control placement per mapping instead:
+ * - `bind` places all pages on one node, for mappings consumed by threads
+ *   pinned to that node.
+ * - `interleave` spreads pages round-robin across the nodes with memory,
+ *   evening out latency and bandwidth for mappings shared by all sockets.
+ *
+ * Platform behavior:
+ * - Linux: mbind() on the mapped range (with page migration, so it also
+ *   applies to pages prefaulted by the populate option).
+ * - Elsewhere: requesting a policy fails with function_not_supported.
+ */
+enum class numa_policy
+{
+    none,       ///< Kernel default (first-touch) placement.
+    bind,       ///< Place all pages on map_options::numa_node.
+    interleave  ///< Spread pages round-robin across all memory nodes.
+};
+
+/**
+ * Optional parameters controlling how a mapping is established.
+ *
+ * Passed to the map() overloads that take options. A default-constructed
+ * map_options reproduces the behavior of the overloads without one exactly,
+ * so existing callers are unaffected.
+ */
+struct map_options
+{
+    /// Page-size selection for the mapping (huge pages are opt-in).
+    page_mode pages = page_mode::normal;
+
+    /**
+     * Create the backing file if it does not exist and extend it so the
+     * requested range [offset, offset + length) exists (via ftruncate /
+     * SetEndOfFile). Existing file contents are never truncated away; the
+     * file is only ever grown.
+     *
+     * Only meaningful for write mappings opened by path, and requires an
+     * explicit length (a freshly created file is empty, so mapping
+     * `map_entire_file` of it would yield an empty mapping). Read mappings
+     * with this flag set fail with invalid_argument.
+     */
+    bool create = false;
+
+    /**
+     * Fault the whole mapping in at map() time instead of on first touch.
+     *
+     * Demand paging spreads the cost of reading a cold file across every
+     * first access, one page fault at a time; prefaulting moves that cost
+     * to map(), where it runs at full device bandwidth. map() blocks until
+     * the mapping is resident. For asynchronous warming of a subrange,
+     * use advise(advice::will_need) instead.
+     *
+     * Implemented with MAP_POPULATE on Linux and a page-touching pass
+     * elsewhere (after PrefetchVirtualMemory on Windows, which initiates
+     * the reads in bulk).
+     */
+    bool populate = false;
+
+    /**
+     * Map with synchronous page faults for persistent memory (Linux).
+     *
+     * On a DAX filesystem (pmem or CXL-backed), requests
+     * MAP_SHARED_VALIDATE | MAP_SYNC so that stores go straight to the
+     * device and user-space cacheline flushes alone make them durable -
+     * sync() then flushes and fences instead of calling msync(). On
+     * non-DAX mounts (where the kernel rejects MAP_SYNC) and on other
+     * platforms the request falls back cleanly to a regular mapping with
+     * the syscall-based sync() path; is_pmem() reports which one was
+     * established.
+     *
+     * Only meaningful for write mappings; ignored otherwise.
+     */
+    bool pmem = false;
+
+    /**
+     * File-level access-pattern hint applied when the file is opened.
+     *
+     * advise() covers hints on the established mapping, but some hints can
+     * only take effect at open time: the Windows cache manager's
+     * FILE_FLAG_SEQUENTIAL_SCAN / FILE_FLAG_RANDOM_ACCESS are CreateFile
+     * flags, and posix_fadvise() readahead hints shape how the very first
+     * faults of the mapping are read. Only meaningful for mappings opened
+     * by path; sequential and random are honored on Windows, the full set
+     * maps to posix_fadvise() elsewhere. Purely advisory - failures are
+     * ignored.
+     */
+    advice access_pattern = advice::normal;
+
+    /**
+     * NUMA placement policy for the mapping's pages (Linux).
+     *
+     * Applied with mbind() right after the mapping is established, so
+     * pages are placed per the policy as they are faulted in. See
+     * mio::numa_policy for the available policies.
+     */
+    numa_policy numa = numa_policy::none;
+
+    /**
+     * Target node for numa_policy::bind; ignored for the other policies.
+     * Must name an online node with memory.
+     */
+    int numa_node = -1;
+};
+
+/**
+ * Result of a basic_mmap::residency() query.
+ *
+ * Describes which pages of the queried range were in physical memory at the
+ * time of the call. The bitmap is a snapshot: the kernel may fault pages in
+ * or reclaim them at any moment, so treat the result as a hint for policies
+ * (what to prefetch, what to pin), not as a guarantee.
+ */
+struct page_residency
+{
+    /// One entry per page of the queried range; true if the page was resident.
+    std::vector<bool> pages;
+
+    /// Size in bytes of the pages described by the bitmap.
+    size_t page_size = 0;
+
+    /// Number of resident pages in the range.
+    size_t resident_pages = 0;
+
+    /**
+     * Number of contiguous runs of resident pages. Together with
+     * resident_pages this summarizes fragmentation: a warm mapping has few
+     * long runs, a randomly-accessed cold one has many short runs.
+     */
+    size_t resident_runs = 0;
+
+    /// Number of resident bytes (resident_pages scaled by the page size).
+    [[nodiscard]] size_t resident_bytes() const noexcept
+    {
+        return resident_pages * page_size;
+    }
+};
+
 // -----------------------------------------------------------------------------
 // Platform-specific types
 // -----------------------------------------------------------------------------
@@ -213,6 +437,16 @@ private:
     // start of the mapping to a page boundary. Always >= length_.
     size_type mapped_length_ = 0;
 
+    // The page size backing this mapping. Equals mio::page_size() for normal
+    // mappings, or the huge page size when a huge-page request was honored.
+    // Zero when unmapped.
+    size_type page_granularity_ = 0;
+
+    // The byte offset into the file at which data() begins (the offset the
+    // user passed to map()). Needed to grow the file and re-derive file
+    // positions for resize() and other file-level operations.
+    size_type file_offset_ = 0;
+
     // The file handle used for the mapping. On Windows, this is the original
     // file handle (HANDLE); on POSIX, this is the file descriptor (int).
     handle_type file_handle_ = INVALID_HANDLE_VALUE;
@@ -229,6 +463,11 @@ private:
     // False when map() was called with an existing handle (user owns it).
     bool is_handle_internal_ = false;
 
+    // Whether the mapping was established with MAP_SYNC on a DAX
+    // filesystem, making user-space cacheline flushes sufficient for
+    // durability (see map_options::pmem and sync()).
+    bool sync_map_ = false;
+
 public:
     // -------------------------------------------------------------------------
     // Constructors and destructor
@@ -373,9 +612,15 @@ public:
      * An open mapping has accessible data via data(), begin(), end(), and
      * operator[]. Accessing data on a closed mapping is undefined behavior.
      *
+     * Anonymous mappings (see map_anonymous()) have no file handle but are
+     * still open while mapped.
+     *
      * @return true if the mapping is open and valid.
      */
-    [[nodiscard]] bool is_open() const noexcept { return file_handle_ != invalid_handle; }
+    [[nodiscard]] bool is_open() const noexcept
+    {
+        return file_handle_ != invalid_handle || data_ != nullptr;
+    }
 
     /**
      * Returns true if the mapping is empty (zero length).
@@ -456,6 +701,41 @@ public:
         return mapped_length_ - length_;
     }
 
+    /**
+     * Returns the effective page granularity of this mapping in bytes.
+     *
+     * For normal mappings this equals mio::page_size(). For mappings created
+     * with a huge-page option (see mio::page_mode) that the kernel honored,
+     * this is the huge page size actually in use (e.g. 2MB). If a huge-page
+     * request fell back to normal pages, this reports the normal page size.
+     *
+     * @return The page size backing the mapping, or 0 if not mapped.
+     */
+    [[nodiscard]] size_type page_granularity() const noexcept { return page_granularity_; }
+
+    /**
+     * Returns the byte offset into the file at which data() begins.
+     *
+     * This is the offset that was passed to map(), i.e. file position
+     * file_offset() + i corresponds to data()[i].
+     *
+     * @return The mapping's starting offset within the file.
+     */
+    [[nodiscard]] size_type file_offset() const noexcept { return file_offset_; }
+
+    /**
+     * Returns whether the mapping was established with synchronous page
+     * faults (MAP_SYNC) on a DAX filesystem.
+     *
+     * When true, sync() flushes CPU cachelines and fences instead of
+     * calling msync(), turning a commit into a handful of instructions.
+     * False when the map_options::pmem request fell back to a regular
+     * mapping, and always false on non-Linux platforms.
+     *
+     * @return Whether user-space flushes alone make stores durable.
+     */
+    [[nodiscard]] bool is_pmem() const noexcept { return sync_map_; }
+
     // -------------------------------------------------------------------------
     // Data access
     // -------------------------------------------------------------------------
@@ -471,7 +751,7 @@ public:
      * @return Pointer to mapped data, or nullptr if not mapped.
      */
     [[nodiscard]] pointer data() noexcept {
-        static_assert(AccessMode == access_mode::write, "non-const data() requires write access");
+        static_assert(AccessMode != access_mode::read, "non-const data() requires write or copy-on-write access");
         return data_;
     }
 
@@ -491,7 +771,7 @@ public:
      * @return Iterator to the first byte.
      */
     [[nodiscard]] iterator begin() noexcept {
-        static_assert(AccessMode == access_mode::write, "non-const begin() requires write access");
+        static_assert(AccessMode != access_mode::read, "non-const begin() requires write or copy-on-write access");
         return data();
     }
     /** @copydoc begin() */
@@ -508,7 +788,7 @@ public:
      * @return Iterator past the last byte.
      */
     [[nodiscard]] iterator end() noexcept {
-        static_assert(AccessMode == access_mode::write, "non-const end() requires write access");
+        static_assert(AccessMode != access_mode::read, "non-const end() requires write or copy-on-write access");
         return data() + length();
     }
     /** @copydoc end() */
@@ -525,7 +805,7 @@ public:
      * @return Reverse iterator to the last byte.
      */
     [[nodiscard]] reverse_iterator rbegin() noexcept {
-        static_assert(AccessMode == access_mode::write, "non-const rbegin() requires write access");
+        static_assert(AccessMode != access_mode::read, "non-const rbegin() requires write or copy-on-write access");
         return reverse_iterator(end());
     }
     /** @copydoc rbegin() */
@@ -544,7 +824,7 @@ public:
      * @return Reverse iterator before the first byte.
      */
     [[nodiscard]] reverse_iterator rend() noexcept {
-        static_assert(AccessMode == access_mode::write, "non-const rend() requires write access");
+        static_assert(AccessMode != access_mode::read, "non-const rend() requires write or copy-on-write access");
         return reverse_iterator(begin());
     }
     /** @copydoc rend() */
@@ -570,7 +850,7 @@ public:
      * @return Reference to the byte at index i.
      */
     [[nodiscard]] reference operator[](const size_type i) noexcept {
-        static_assert(AccessMode == access_mode::write, "non-const operator[] requires write access");
+        static_assert(AccessMode != access_mode::read, "non-const operator[] requires write or copy-on-write access");
         return data_[i];
     }
     /** @copydoc operator[]() */
@@ -600,7 +880,7 @@ public:
      *
      * @return A mutable span viewing the entire mapped region.
      */
-    template<access_mode A = AccessMode, std::enable_if_t<A == access_mode::write, int> = 0>
+    template<access_mode A = AccessMode, std::enable_if_t<A != access_mode::read, int> = 0>
     [[nodiscard]] std::span<value_type> as_span() noexcept {
         return {data(), length()};
     }
@@ -641,12 +921,30 @@ public:
     void map(const std::filesystem::path& path, const size_type offset,
             const size_type length, std::error_code& error);
 
+    /**
+     * Establishes a memory mapping from a file path with explicit options.
+     *
+     * Identical to the overload without options, but allows requesting
+     * non-default mapping behavior such as huge pages (see mio::map_options).
+     *
+     * @param path    Path to an existing file. Empty paths cause an error.
+     * @param offset  Byte offset where mapping starts.
+     * @param length  Number of bytes to map, or `map_entire_file`.
+     * @param options Mapping options (page size selection, etc.).
+     * @param error   Output parameter for error reporting.
+     */
+    void map(const std::filesystem::path& path, const size_type offset,
+            const size_type length, const map_options& options,
+            std::error_code& error);
+
     /**
      * Overload for const char* paths with null-pointer checking.
      *
-     * Passing nullptr to std::filesystem::path constructor is undefined
-     * behavior. This overload provides safe handling by checking for null
-     * first and returning an error instead of UB.
+     * This is the allocation-free fast path on POSIX: the string goes
+     * straight to open() without constructing a std::filesystem::path
+     * (which heap-allocates). On Windows, narrow strings still pass
+     * through std::filesystem::path for correct Unicode re-encoding; use
+     * the const wchar_t* overload there to skip it.
      *
      * @param path   C-string path, or nullptr (which causes an error).
      * @param offset Byte offset where mapping starts.
@@ -655,14 +953,71 @@ public:
      */
     void map(const char* path, const size_type offset,
             const size_type length, std::error_code& error)
+    {
+        map(path, offset, length, map_options{}, error);
+    }
+
+    /**
+     * Overload for const char* paths with explicit options.
+     *
+     * Provides the same null-pointer checking and allocation-free POSIX
+     * fast path as the overload without options.
+     *
+     * @param path    C-string path, or nullptr (which causes an error).
+     * @param offset  Byte offset where mapping starts.
+     * @param length  Number of bytes to map, or `map_entire_file`.
+     * @param options Mapping options (page size selection, file creation, etc.).
+     * @param error   Output parameter for error reporting.
+     */
+    void map(const char* path, const size_type offset, const size_type length,
+            const map_options& options, std::error_code& error)
     {
         if (!path) {
             error = std::make_error_code(std::errc::invalid_argument);
             return;
         }
-        map(std::filesystem::path(path), offset, length, error);
+        map_with_path(path, offset, length, options, error);
     }
 
+#ifdef _WIN32
+    /**
+     * Overload for native wide paths (Windows only).
+     *
+     * The string goes straight to CreateFileW with no
+     * std::filesystem::path construction and no re-encoding, so mapping
+     * performs zero heap allocations. This is the preferred overload for
+     * high-rate mapping loops on Windows.
+     *
+     * @param path   Wide C-string path, or nullptr (which causes an error).
+     * @param offset Byte offset where mapping starts.
+     * @param length Number of bytes to map, or `map_entire_file`.
+     * @param error  Output parameter for error reporting.
+     */
+    void map(const wchar_t* path, const size_type offset,
+            const size_type length, std::error_code& error)
+    {
+        map(path, offset, length, map_options{}, error);
+    }
+
+    /** @copydoc map(const wchar_t*,size_type,size_type,std::error_code&) */
+    void map(const wchar_t* path, const size_type offset,
+            const size_type length, const map_options& options,
+            std::error_code& error)
+    {
+        if (!path) {
+            error = std::make_error_code(std::errc::invalid_argument);
+            return;
+        }
+        map_with_path(path, offset, length, options, error);
+    }
+
+    /** Maps the entire file from a native wide path (Windows only). */
+    void map(const wchar_t* path, std::error_code& error)
+    {
+        map(path, 0, map_entire_file, error);
+    }
+#endif // _WIN32
+
     /**
      * Maps the entire file starting at offset 0.
      *
@@ -686,11 +1041,7 @@ public:
      */
     void map(const char* path, std::error_code& error)
     {
-        if (!path) {
-            error = std::make_error_code(std::errc::invalid_argument);
-            return;
-        }
-        map(std::filesystem::path(path), 0, map_entire_file, error);
+        map(path, 0, map_entire_file, error);
     }
 
     /**
@@ -720,6 +1071,22 @@ public:
     void map(const handle_type handle, const size_type offset,
             const size_type length, std::error_code& error);
 
+    /**
+     * Establishes a memory mapping from an existing handle with explicit options.
+     *
+     * Identical to the overload without options, but allows requesting
+     * non-default mapping behavior such as huge pages (see mio::map_options).
+     *
+     * @param handle  Valid file handle.
+     * @param offset  Byte offset where mapping starts.
+     * @param length  Number of bytes to map, or `map_entire_file`.
+     * @param options Mapping options (page size selection, etc.).
+     * @param error   Output parameter for error reporting.
+     */
+    void map(const handle_type handle, const size_type offset,
+            const size_type length, const map_options& options,
+            std::error_code& error);
+
     /**
      * Maps the entire file from an existing handle.
      *
@@ -733,6 +1100,42 @@ public:
         map(handle, 0, map_entire_file, error);
     }
 
+    /**
+     * Establishes an anonymous (file-less) memory mapping.
+     *
+     * The mapping is backed by zero-initialized demand-paged memory
+     * (MAP_ANONYMOUS on POSIX, a pagefile-backed section on Windows) instead
+     * of a file. It reuses all of the RAII, iterator, advise() and huge-page
+     * machinery of file-backed mappings, which makes it a drop-in scratch
+     * buffer: unlike a std::vector it performs no heap allocation, can be
+     * given huge pages via map_options, and can return memory to the OS
+     * in-place with advise(advice::dont_need).
+     *
+     * sync() on an anonymous mapping is a no-op (there is no file to flush
+     * to), and file_handle() returns invalid_handle.
+     *
+     * @param length Number of bytes to map (must be > 0).
+     * @param error  Output parameter for error reporting.
+     */
+    void map_anonymous(const size_type length, std::error_code& error)
+    {
+        map_anonymous(length, map_options{}, error);
+    }
+
+    /**
+     * Establishes an anonymous memory mapping with explicit options.
+     *
+     * Identical to map_anonymous(length, error), but allows requesting
+     * non-default behavior such as huge pages (see mio::map_options).
+     * The create flag is meaningless for anonymous mappings and is ignored.
+     *
+     * @param length  Number of bytes to map (must be > 0).
+     * @param options Mapping options (page size selection, etc.).
+     * @param error   Output parameter for error reporting.
+     */
+    void map_anonymous(const size_type length, const map_options& options,
+            std::error_code& error);
+
     /**
      * Releases the memory mapping and associated resources.
      *
@@ -779,6 +1182,276 @@ public:
      */
     void sync(std::error_code& error);
 
+    /**
+     * Flushes a subrange of modified pages to the underlying file.
+     *
+     * Equivalent to sync(offset, length, sync_mode::sync, error): blocks
+     * until the range's data has been written. Offsets are relative to
+     * data(), like operator[]; the range is page-aligned internally.
+     *
+     * @param offset Byte offset into the mapping where the flush starts.
+     * @param length Number of bytes to flush, or `map_entire_file` for the
+     *               rest of the mapping from offset.
+     * @param error  Output parameter for error reporting.
+     */
+    void sync(const size_type offset, const size_type length, std::error_code& error)
+    {
+        sync(offset, length, sync_mode::sync, error);
+    }
+
+    /**
+     * Flushes a subrange of modified pages with an explicit durability tier.
+     *
+     * This is the most general flush operation; see mio::sync_mode for the
+     * semantics of each tier. Flushing only the dirty range instead of the
+     * whole mapping keeps flush latency proportional to the amount of dirty
+     * data rather than to the mapping size.
+     *
+     * Implementation:
+     * - Windows: FlushViewOfFile over the range; FlushFileBuffers for the
+     *   `sync` and `full` tiers
+     * - POSIX: msync() with MS_ASYNC or MS_SYNC; fsync() for `full`
+     *
+     * Only available for write access mode (compile-time check).
+     *
+     * @param offset Byte offset into the mapping where the flush starts.
+     * @param length Number of bytes to flush, or `map_entire_file` for the
+     *               rest of the mapping from offset.
+     * @param mode   Durability tier for the flush.
+     * @param error  Output parameter for error reporting.
+     */
+    void sync(const size_type offset, const size_type length,
+            const sync_mode mode, std::error_code& error);
+
+    /**
+     * Grows or shrinks the mapping in place, extending the file if needed.
+     *
+     * This avoids the unmap()/map() cycle that would otherwise be required
+     * to change a mapping's length, which tears down and refaults every
+     * resident page. When growing, the backing file is first extended (with
+     * zero fill) so the range file_offset() + new_length exists; the file
+     * itself is never shrunk.
+     *
+     * Implementation:
+     * - Linux: mremap(MREMAP_MAYMOVE) - resident pages are preserved, but
+     *   the mapping may move, so data() can change (raw pointers into the
+     *   region must be re-derived from data() after a resize)
+     * - Windows and other POSIX: a new view is created before the old one is
+     *   released, so failure leaves the mapping unchanged; resident pages
+     *   stay in the page cache but are refaulted on next access
+     *
+     * Only available for write access mode (compile-time check).
+     *
+     * @param new_length The desired mapping length in bytes (must be > 0).
+     * @param error      Output parameter for error reporting.
+     */
+    void resize(const size_type new_length, std::error_code& error);
+
+    /**
+     * Releases a retired range: the bytes read back as zero, the backing
+     * file's blocks are deallocated, and the resident pages are dropped.
+     *
+     * For ring-buffer-over-file designs that retire old regions
+     * continuously, this caps the file's on-disk footprint and the
+     * mapping's resident set at the live window, without remapping. The
+     * file's logical size is unchanged (the hole is transparent to
+     * readers), and the mapping stays valid: accessing a discarded range
+     * is permitted and faults in zero pages.
+     *
+     * Implementation:
+     * - Linux: fallocate(FALLOC_FL_PUNCH_HOLE) on the byte range (the
+     *   filesystem zeroes partial blocks), then madvise(MADV_DONTNEED)
+     *   over the fully-covered pages to drop them from memory. Anonymous
+     *   mappings zero the partial edge pages and MADV_DONTNEED the rest.
+     * - Windows: the file is marked sparse and the range zeroed with
+     *   FSCTL_SET_ZERO_DATA; the memory manager reclaims the clean pages.
+     * - Other POSIX: fails with function_not_supported (no portable
+     *   hole-punching primitive).
+     *
+     * Only available for write access mode (compile-time check).
+     *
+     * @param offset Byte offset into the mapping where the discard starts.
+     * @param length Number of bytes to discard, or `map_entire_file` for
+     *               the rest of the mapping from offset.
+     * @param error  Output parameter for error reporting.
+     */
+    void discard(const size_type offset, const size_type length,
+            std::error_code& error);
+
+    /**
+     * Pins a subrange of the mapping into physical memory.
+     *
+     * Locked pages are faulted in immediately and are exempt from reclaim,
+     * so subsequent accesses never take a major fault. Pinning just the hot
+     * ranges of a large mapping keeps the memory budget bounded while still
+     * guaranteeing residency where tail latency matters.
+     *
+     * Offsets are relative to data(); the range is page-aligned internally.
+     * Locks are per-range, not reference counted: unlocking a range releases
+     * it regardless of how many times it was locked.
+     *
+     * Implementation:
+     * - POSIX: mlock() (subject to RLIMIT_MEMLOCK)
+     * - Windows: VirtualLock() (subject to the process working-set quota;
+     *   see SetProcessWorkingSetSize to raise it)
+     *
+     * @param offset Byte offset into the mapping where the lock starts.
+     * @param length Number of bytes to lock, or `map_entire_file` for the
+     *               rest of the mapping from offset.
+     * @param error  Output parameter for error reporting.
+     */
+    void lock(const size_type offset, const size_type length, std::error_code& error);
+
+    /**
+     * Pins the entire mapping into physical memory.
+     *
+     * Convenience overload equivalent to lock(0, map_entire_file, error).
+     *
+     * @param error Output parameter for error reporting.
+     */
+    void lock(std::error_code& error) { lock(0, map_entire_file, error); }
+
+    /**
+     * Releases a previously pinned subrange of the mapping.
+     *
+     * The pages become reclaimable again; their contents are unaffected.
+     * Unlocking a range that was never locked is harmless.
+     *
+     * Implementation:
+     * - POSIX: munlock()
+     * - Windows: VirtualUnlock()
+     *
+     * @param offset Byte offset into the mapping where the unlock starts.
+     * @param length Number of bytes to unlock, or `map_entire_file` for the
+     *               rest of the mapping from offset.
+     * @param error  Output parameter for error reporting.
+     */
+    void unlock(const size_type offset, const size_type length, std::error_code& error);
+
+    /**
+     * Releases all pinned pages of the mapping.
+     *
+     * Convenience overload equivalent to unlock(0, map_entire_file, error).
+     *
+     * @param error Output parameter for error reporting.
+     */
+    void unlock(std::error_code& error) { unlock(0, map_entire_file, error); }
+
+    /**
+     * Advises the kernel about the expected access pattern for a subrange.
+     *
+     * Offsets are relative to data() (the user's requested offset), just like
+     * operator[]. The range is page-aligned internally against the actual
+     * mapping start, so callers never need to reason about mapping_offset()
+     * or page boundaries themselves.
+     *
+     * Implementation:
+     * - POSIX: madvise() with the corresponding MADV_* flag
+     * - Windows: PrefetchVirtualMemory for `will_need`, DiscardVirtualMemory
+     *   for `dont_need`/`free`; pattern hints (sequential/random) are no-ops
+     *
+     * Note: This is a hint; the kernel is free to ignore it. `dont_need` on a
+     * shared file mapping does not lose data (pages are re-read from the file
+     * on next access).
+     *
+     * @param adv    The access pattern hint to apply.
+     * @param offset Byte offset into the mapping where the hint starts.
+     * @param length Number of bytes the hint covers, or `map_entire_file`
+     *               for the rest of the mapping from offset.
+     * @param error  Output parameter for error reporting.
+     */
+    void advise(const advice adv, const size_type offset,
+            const size_type length, std::error_code& error);
+
+    /**
+     * Advises the kernel about the access pattern for the entire mapping.
+     *
+     * Convenience overload equivalent to advise(adv, 0, map_entire_file, error).
+     *
+     * @param adv   The access pattern hint to apply.
+     * @param error Output parameter for error reporting.
+     */
+    void advise(const advice adv, std::error_code& error)
+    {
+        advise(adv, 0, map_entire_file, error);
+    }
+
+    /**
+     * Reports which pages of a subrange are resident in physical memory.
+     *
+     * Accessing a resident page is a memory read; accessing a non-resident
+     * one takes a page fault and potentially a disk read. Querying residency
+     * lets callers warm exactly the missing ranges (advise(advice::will_need)
+     * or lock()) instead of prefetching blindly, and lets capacity planning
+     * measure how much of a mapping is actually held in RAM.
+     *
+     * Offsets are relative to data(); the range is page-aligned internally,
+     * so the first bitmap entry covers the page containing `offset`.
+     *
+     * Implementation:
+     * - POSIX: mincore()
+     * - Windows: QueryWorkingSetEx() (reports working-set membership, the
+     *   closest Windows equivalent of residency)
+     *
+     * @param offset Byte offset into the mapping where the query starts.
+     * @param length Number of bytes to query, or `map_entire_file` for the
+     *               rest of the mapping from offset.
+     * @param error  Output parameter for error reporting.
+     * @return Per-page bitmap and summary statistics; empty on error.
+     */
+    [[nodiscard]] page_residency residency(const size_type offset,
+            const size_type length, std::error_code& error) const;
+
+    /**
+     * Reports residency of the entire mapping.
+     *
+     * Convenience overload equivalent to residency(0, map_entire_file, error).
+     *
+     * @param error Output parameter for error reporting.
+     * @return Per-page bitmap and summary statistics; empty on error.
+     */
+    [[nodiscard]] page_residency residency(std::error_code& error) const
+    {
+        return residency(0, map_entire_file, error);
+    }
+
+    /**
+     * Reports the NUMA node each page of a subrange currently resides on.
+     *
+     * Complements residency(): once a page is known to be in RAM, this
+     * tells you which socket's memory holds it, so shard-to-core
+     * assignments can be checked against actual placement.
+     *
+     * Offsets are relative to data(); the range is page-aligned internally.
+     *
+     * Implementation:
+     * - Linux: move_pages() in query mode
+     * - Elsewhere: fails with function_not_supported
+     *
+     * @param offset Byte offset into the mapping where the query starts.
+     * @param length Number of bytes to query, or `map_entire_file` for the
+     *               rest of the mapping from offset.
+     * @param error  Output parameter for error reporting.
+     * @return One entry per page: the node id, or a negative errno-style
+     *         value for pages that are not resident. Empty on error.
+     */
+    [[nodiscard]] std::vector<int> numa_nodes(const size_type offset,
+            const size_type length, std::error_code& error) const;
+
+    /**
+     * Reports NUMA placement of the entire mapping.
+     *
+     * Convenience overload equivalent to
+     * numa_nodes(0, map_entire_file, error).
+     *
+     * @param error Output parameter for error reporting.
+     * @return One node entry per page; empty on error.
+     */
+    [[nodiscard]] std::vector<int> numa_nodes(std::error_code& error) const
+    {
+        return numa_nodes(0, map_entire_file, error);
+    }
+
 private:
     // -------------------------------------------------------------------------
     // Private helpers
@@ -804,6 +1477,18 @@ private:
         return !data_ ? nullptr : data_ - mapping_offset();
     }
 
+    /**
+     * Shared body of the path-based map() overloads.
+     *
+     * Templated on the path representation so const char* (POSIX) and
+     * const wchar_t* (Windows) callers resolve to the native open_file()
+     * overloads and never construct a std::filesystem::path.
+     */
+    template<typename Path>
+    void map_with_path(const Path& path, const size_type offset,
+            const size_type length, const map_options& options,
+            std::error_code& error);
+
     /**
      * Conditionally syncs the mapping based on access mode.
      *
@@ -849,6 +1534,193 @@ template<access_mode AccessMode, typename ByteT>
 [[nodiscard]] bool operator>=(const basic_mmap<AccessMode, ByteT>& a,
         const basic_mmap<AccessMode, ByteT>& b);
 
+// -----------------------------------------------------------------------------
+// Non-temporal bulk transfer
+// -----------------------------------------------------------------------------
+
+/**
+ * Copies `count` bytes from `src` into the mapping at `offset`, bypassing
+ * the CPU cache for large ranges.
+ *
+ * Bulk-writing a large mapping with std::copy or memcpy pulls every
+ * destination line into cache first (read-for-ownership) and evicts the
+ * working set with data that will not be re-read. On x86 this uses
+ * streaming stores for ranges of a few hundred KiB and up; small ranges
+ * and other targets degrade to memcpy. See detail/nontemporal.hpp.
+ *
+ * The source must not overlap the mapping.
+ *
+ * @param map    A writable mapping.
+ * @param offset Byte offset into the mapping where writing starts.
+ * @param src    Source buffer of at least `count` bytes.
+ * @param count  Number of bytes to copy.
+ * @param error  Output parameter for error reporting.
+ */
+template<access_mode AccessMode, typename ByteT>
+void copy_to(basic_mmap<AccessMode, ByteT>& map, const size_t offset,
+        const ByteT* const src, const size_t count, std::error_code& error)
+{
+    static_assert(AccessMode != access_mode::read,
+            "copy_to requires write or copy-on-write access");
+    error.clear();
+
+    if(!map.is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return;
+    }
+
+    // Validate that the range lies within the mapping
+    if(offset > map.size() || count > map.size() - offset)
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
+
+    detail::nontemporal_copy(map.data() + offset, src, count);
+}
+
+/**
+ * Fills `length` bytes of the mapping at `offset` with `value`, bypassing
+ * the CPU cache for large ranges.
+ *
+ * The streaming-store counterpart of std::fill / memset; see copy_to()
+ * for when the cache bypass engages.
+ *
+ * @param map    A writable mapping.
+ * @param offset Byte offset into the mapping where filling starts.
+ * @param length Number of bytes to fill, or `map_entire_file` for the
+ *               rest of the mapping from offset.
+ * @param value  Byte value to fill with.
+ * @param error  Output parameter for error reporting.
+ */
+template<access_mode AccessMode, typename ByteT>
+void fill(basic_mmap<AccessMode, ByteT>& map, const size_t offset,
+        const size_t length, const ByteT value, std::error_code& error)
+{
+    static_assert(AccessMode != access_mode::read,
+            "fill requires write or copy-on-write access");
+    error.clear();
+
+    if(!map.is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return;
+    }
+
+    if(offset > map.size()
+       || (length != map_entire_file && length > map.size() - offset))
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
+
+    const size_t fill_length =
+            length == map_entire_file ? map.size() - offset : length;
+    detail::nontemporal_fill(map.data() + offset,
+            static_cast<unsigned char>(value), fill_length);
+}
+
+/**
+ * Copies `count` bytes from the mapping at `offset` into `dst`, keeping
+ * the transfer out of the CPU cache for large ranges.
+ *
+ * The read counterpart of copy_to(): the destination buffer is written
+ * with streaming stores and the mapped source is prefetched with a
+ * non-temporal hint, so draining a multi-GB mapping into an I/O buffer
+ * does not flush the working set.
+ *
+ * The destination must not overlap the mapping.
+ *
+ * @param map    The mapping to read from (any access mode).
+ * @param offset Byte offset into the mapping where reading starts.
+ * @param dst    Destination buffer of at least `count` bytes.
+ * @param count  Number of bytes to copy.
+ * @param error  Output parameter for error reporting.
+ */
+template<access_mode AccessMode, typename ByteT>
+void copy_from(const basic_mmap<AccessMode, ByteT>& map, const size_t offset,
+        ByteT* const dst, const size_t count, std::error_code& error)
+{
+    error.clear();
+
+    if(!map.is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return;
+    }
+
+    if(offset > map.size() || count > map.size() - offset)
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
+
+    detail::nontemporal_copy(dst, map.data() + offset, count);
+}
+
+#if __cplusplus >= 202002L
+/**
+ * Span overload of copy_to(): copies `src.size()` bytes from `src` into
+ * the mapping at `offset`.
+ */
+template<access_mode AccessMode, typename ByteT>
+void copy_to(basic_mmap<AccessMode, ByteT>& map, const size_t offset,
+        const std::span<const ByteT> src, std::error_code& error)
+{
+    copy_to(map, offset, src.data(), src.size(), error);
+}
+
+/**
+ * Span overload of copy_from(): fills `dst` with `dst.size()` bytes read
+ * from the mapping at `offset`.
+ */
+template<access_mode AccessMode, typename ByteT>
+void copy_from(const basic_mmap<AccessMode, ByteT>& map, const size_t offset,
+        const std::span<ByteT> dst, std::error_code& error)
+{
+    copy_from(map, offset, dst.data(), dst.size(), error);
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// Zero-copy range cloning
+// -----------------------------------------------------------------------------
+
+/**
+ * Copies `length` bytes from `source` at `src_offset` into `dest` at
+ * `dst_offset`, offloading the copy to the kernel where possible.
+ *
+ * When both mappings are file-backed and the platform supports it (Linux
+ * copy_file_range()), the transfer happens inside the kernel: on a
+ * filesystem with reflink support (Btrfs, XFS) the extents are shared
+ * rather than copied, and elsewhere the copy runs at page-cache speed
+ * without the data crossing into user space. Rewriting data between
+ * mapped segment files this way pays no read+write memory bandwidth
+ * through the mappings and leaves the CPU cache untouched.
+ *
+ * Anonymous mappings, copy-on-write mappings on either side (a COW
+ * source's private dirty pages never reach the file, so only the mapped
+ * copy sees the live view), cross-filesystem copies, and platforms
+ * without a kernel copy primitive fall back to a non-temporal copy
+ * through the mappings (see copy_to()).
+ *
+ * The ranges must not overlap. Shared file mappings are coherent with
+ * the page cache, so both mappings observe the new contents on return.
+ *
+ * @param source     The mapping to read from (any access mode).
+ * @param dest       A writable mapping.
+ * @param src_offset Byte offset into `source` where reading starts.
+ * @param dst_offset Byte offset into `dest` where writing starts.
+ * @param length     Number of bytes to copy, or `map_entire_file` for
+ *                   the rest of `source` from `src_offset`.
+ * @param error      Output parameter for error reporting.
+ */
+template<access_mode SrcAccessMode, access_mode DstAccessMode, typename ByteT>
+void clone_range(const basic_mmap<SrcAccessMode, ByteT>& source,
+        basic_mmap<DstAccessMode, ByteT>& dest, const size_t src_offset,
+        const size_t dst_offset, const size_t length, std::error_code& error);
+
 // -----------------------------------------------------------------------------
 // Type aliases for common use cases
 // -----------------------------------------------------------------------------
@@ -876,6 +1748,20 @@ using basic_mmap_source = basic_mmap<access_mode::read, ByteT>;
 template<typename ByteT>
 using basic_mmap_sink = basic_mmap<access_mode::write, ByteT>;
 
+/**
+ * Copy-on-write memory mapping template.
+ *
+ * Use this to mutate a view of a file without ever modifying the file
+ * itself: the first write to a page lazily creates a private copy of just
+ * that page. Peak memory overhead is proportional to the pages actually
+ * touched, not to the file size. sync() is not available (there is nothing
+ * to write back).
+ *
+ * @tparam ByteT The byte type (char, unsigned char, std::byte).
+ */
+template<typename ByteT>
+using basic_cow_mmap = basic_mmap<access_mode::copy_on_write, ByteT>;
+
 // Convenient type aliases for the most common byte types:
 
 /// Read-only mapping with char bytes (most common)
@@ -896,6 +1782,15 @@ using ummap_sink = basic_mmap_sink<unsigned char>;
 /// Read-write mapping with std::byte bytes (C++17)
 using bmmap_sink = basic_mmap_sink<std::byte>;
 
+/// Copy-on-write mapping with char bytes (most common)
+using mmap_cow = basic_cow_mmap<char>;
+
+/// Copy-on-write mapping with unsigned char bytes
+using ummap_cow = basic_cow_mmap<unsigned char>;
+
+/// Copy-on-write mapping with std::byte bytes (C++17)
+using bmmap_cow = basic_cow_mmap<std::byte>;
+
 // -----------------------------------------------------------------------------
 // Factory functions
 // -----------------------------------------------------------------------------
@@ -928,6 +1823,24 @@ template<
     return mmap;
 }
 
+/**
+ * Generic factory function for creating memory mappings with explicit options.
+ *
+ * Identical to make_mmap() without options, but forwards a mio::map_options
+ * (page size selection, file creation, etc.) to map().
+ */
+template<
+    typename MMap,
+    typename MappingToken
+> MMap make_mmap(const MappingToken& token,
+        typename MMap::size_type offset, typename MMap::size_type length,
+        const map_options& options, std::error_code& error)
+{
+    MMap mmap;
+    mmap.map(token, offset, length, options, error);
+    return mmap;
+}
+
 /**
  * Creates a read-only memory mapping.
  *
@@ -961,6 +1874,18 @@ mmap_source make_mmap_source(const MappingToken& token, mmap_source::size_type o
     return make_mmap<mmap_source>(token, offset, length, error);
 }
 
+/**
+ * Creates a read-only memory mapping with explicit options.
+ *
+ * Overload forwarding a mio::map_options (e.g. huge pages) to map().
+ */
+template<typename MappingToken>
+mmap_source make_mmap_source(const MappingToken& token, mmap_source::size_type offset,
+        mmap_source::size_type length, const map_options& options, std::error_code& error)
+{
+    return make_mmap<mmap_source>(token, offset, length, options, error);
+}
+
 /**
  * Creates a read-only mapping of an entire file.
  *
@@ -1007,6 +1932,24 @@ mmap_sink make_mmap_sink(const MappingToken& token, mmap_sink::size_type offset,
     return make_mmap<mmap_sink>(token, offset, length, error);
 }
 
+/**
+ * Creates a read-write memory mapping with explicit options.
+ *
+ * With options.create set, this produces a ready writable mapping of a file
+ * that did not previously exist (or was shorter than the requested range)
+ * in a single call:
+ *
+ *   mio::map_options opts;
+ *   opts.create = true;
+ *   auto sink = mio::make_mmap_sink("out.bin", 0, segment_size, opts, ec);
+ */
+template<typename MappingToken>
+mmap_sink make_mmap_sink(const MappingToken& token, mmap_sink::size_type offset,
+        mmap_sink::size_type length, const map_options& options, std::error_code& error)
+{
+    return make_mmap<mmap_sink>(token, offset, length, options, error);
+}
+
 /**
  * Creates a read-write mapping of an entire file.
  *
@@ -1022,6 +1965,50 @@ mmap_sink make_mmap_sink(const MappingToken& token, std::error_code& error)
     return make_mmap_sink(token, 0, map_entire_file, error);
 }
 
+/**
+ * Creates a copy-on-write memory mapping.
+ *
+ * The mapped memory is writable, but all changes stay private to this
+ * process; the file is opened read-only and is never modified.
+ *
+ * @tparam MappingToken Type that can identify a file (path or handle).
+ *
+ * @param token  The file path or handle to map.
+ * @param offset Byte offset where mapping starts.
+ * @param length Number of bytes to map, or `map_entire_file`.
+ * @param error  Output parameter for error reporting.
+ *
+ * @return The created mmap_cow.
+ *
+ * Example:
+ *   std::error_code ec;
+ *   auto view = mio::make_mmap_cow("reference.bin", ec);
+ *   if (!ec) {
+ *       view[0] = 'X';  // Copies one page; reference.bin is untouched
+ *   }
+ */
+template<typename MappingToken>
+mmap_cow make_mmap_cow(const MappingToken& token, mmap_cow::size_type offset,
+        mmap_cow::size_type length, std::error_code& error)
+{
+    return make_mmap<mmap_cow>(token, offset, length, error);
+}
+
+/**
+ * Creates a copy-on-write mapping of an entire file.
+ *
+ * Convenience overload that maps from offset 0 to end of file.
+ *
+ * @param token The file path or handle to map.
+ * @param error Output parameter for error reporting.
+ * @return The created mmap_cow.
+ */
+template<typename MappingToken>
+mmap_cow make_mmap_cow(const MappingToken& token, std::error_code& error)
+{
+    return make_mmap_cow(token, 0, map_entire_file, error);
+}
+
 } // namespace mio
 
 // Include the implementation (template definitions)
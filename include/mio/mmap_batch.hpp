@@ -0,0 +1,141 @@
+/* Copyright 2017 https://github.com/mandreyel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MIO_MMAP_BATCH_HEADER
+#define MIO_MMAP_BATCH_HEADER
+
+// -----------------------------------------------------------------------------
+// mmap_batch.hpp - Batch mapping of many files in parallel
+// -----------------------------------------------------------------------------
+//
+// This header provides map_files(), which maps a list of files and returns
+// one mapping per path. The open/fstat/mmap sequence behind each mapping is
+// cheap individually, but serialized syscall latency dominates when mapping
+// hundreds of thousands of small files at startup; map_files() spreads the
+// work across a temporary pool of threads, turning minutes of serial opens
+// into seconds.
+//
+// Errors are reported per file: one missing or unreadable file leaves an
+// empty mapping and an error code in its slot without aborting the batch.
+//
+// Usage:
+//   std::vector<std::filesystem::path> paths = list_segment_files();
+//   std::vector<std::error_code> errors;
+//   auto segments = mio::map_files(paths, errors);
+//   for (size_t i = 0; i < segments.size(); ++i) {
+//       if (errors[i]) { log_skip(paths[i], errors[i]); continue; }
+//       index.add(segments[i]);
+//   }
+//
+// -----------------------------------------------------------------------------
+
+#include "mio/mmap.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace mio {
+
+// -----------------------------------------------------------------------------
+// map_files - Parallel batch mapping
+// -----------------------------------------------------------------------------
+
+/**
+ * Maps every file in `paths`, parallelizing the per-file open + mmap
+ * sequence across up to hardware_concurrency() threads.
+ *
+ * Results and errors are positional: result[i] is the mapping of paths[i],
+ * and errors[i] is its error code. A failed file yields an empty mapping
+ * (is_open() == false) and a set error code; the rest of the batch is
+ * unaffected.
+ *
+ * The mappings are whole-file, like the single-path factories without an
+ * explicit range.
+ *
+ * @tparam MMap The mapping type to produce (e.g. mmap_source, mmap_sink,
+ *              or any basic_mmap instantiation).
+ *
+ * @param paths   The files to map.
+ * @param options Mapping options applied to every file.
+ * @param errors  Per-file error codes, resized to match `paths`.
+ * @return One mapping per path, in the same order.
+ */
+template<typename MMap = mmap_source>
+std::vector<MMap> map_files(const std::vector<std::filesystem::path>& paths,
+        const map_options& options, std::vector<std::error_code>& errors)
+{
+    std::vector<MMap> results(paths.size());
+    errors.assign(paths.size(), std::error_code());
+    if(paths.empty()) { return results; }
+
+    const size_t num_threads = std::min<size_t>(
+            std::max(1u, std::thread::hardware_concurrency()), paths.size());
+
+    // Workers claim file indices from a shared counter, so fast files do
+    // not idle a thread while a slow one (cold metadata, network fs)
+    // finishes elsewhere.
+    std::atomic<size_t> next_index{0};
+    const auto worker = [&]
+    {
+        for(size_t i = next_index.fetch_add(1, std::memory_order_relaxed);
+                i < paths.size();
+                i = next_index.fetch_add(1, std::memory_order_relaxed))
+        {
+            results[i].map(paths[i], 0, map_entire_file, options, errors[i]);
+        }
+    };
+
+    if(num_threads == 1)
+    {
+        worker();
+        return results;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for(size_t t = 0; t < num_threads; ++t) { threads.emplace_back(worker); }
+    for(auto& thread : threads) { thread.join(); }
+    return results;
+}
+
+/**
+ * Maps every file in `paths` with default options.
+ *
+ * Convenience overload of map_files(paths, options, errors).
+ *
+ * @tparam MMap The mapping type to produce.
+ *
+ * @param paths  The files to map.
+ * @param errors Per-file error codes, resized to match `paths`.
+ * @return One mapping per path, in the same order.
+ */
+template<typename MMap = mmap_source>
+std::vector<MMap> map_files(const std::vector<std::filesystem::path>& paths,
+        std::vector<std::error_code>& errors)
+{
+    return map_files<MMap>(paths, map_options(), errors);
+}
+
+} // namespace mio
+
+#endif // MIO_MMAP_BATCH_HEADER
@@ -0,0 +1,303 @@
+/* Copyright 2017 https://github.com/mandreyel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MIO_MMAP_STREAM_HEADER
+#define MIO_MMAP_STREAM_HEADER
+
+// -----------------------------------------------------------------------------
+// mmap_stream.hpp - Pipelined sequential reading of memory-mapped files
+// -----------------------------------------------------------------------------
+//
+// This header provides basic_mmap_stream, a read-once sequential reader over
+// a memory-mapped file. Iterating a plain mmap_source sequentially has two
+// costs the kernel's readahead only partially hides: the consumer stalls on
+// every readahead miss, and pages that have been consumed stay resident,
+// polluting the page cache for the rest of the job.
+//
+// The stream divides the mapping into fixed-size windows and drives an
+// advice pipeline from the iterator: while the consumer iterates window k,
+// windows k+1..k+depth are prefetched with advice::will_need (asynchronous
+// readahead at device bandwidth), and windows the consumer has fully passed
+// are released with advice::dont_need. The consumer thus runs against warm
+// pages with near-zero resident overhead, through the same iterator
+// interface as mmap.hpp.
+//
+// Usage:
+//   std::error_code ec;
+//   mio::mmap_stream log;
+//   log.open("service.log", ec);
+//   if (ec) { handle_error(ec); }
+//   for (const char c : log) { consume(c); }
+//
+// The pipeline is advisory: iterators remain valid regardless of window
+// state, and released pages are transparently re-read on access. Iterating
+// a stream twice works but re-reads the file from disk.
+//
+// -----------------------------------------------------------------------------
+
+#include "mio/mmap.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <system_error>
+
+namespace mio {
+
+// -----------------------------------------------------------------------------
+// basic_mmap_stream - Read-once sequential reader with window prefetch
+// -----------------------------------------------------------------------------
+
+/**
+ * A sequential, read-once view of a memory-mapped file with pipelined
+ * prefetch and eager release of consumed pages.
+ *
+ * The file is mapped whole (so the data is addressable and iterators are
+ * plain pointers underneath), but residency is managed in windows: the
+ * iterator prefetches ahead of the read position and drops what it has
+ * passed. Random access through data() still works - the stream only adds
+ * hints, never restrictions.
+ *
+ * @tparam ByteT The byte type for the mapped data. Must be 1 byte in size.
+ *
+ * Ownership semantics: move-only RAII, like basic_mmap.
+ *
+ * Thread safety: none; one consumer per stream. Separate streams over the
+ * same file are independent.
+ */
+template<typename ByteT>
+class basic_mmap_stream
+{
+public:
+    using mmap_type = basic_mmap_source<ByteT>;
+    using value_type = typename mmap_type::value_type;
+    using size_type = typename mmap_type::size_type;
+    using const_pointer = typename mmap_type::const_pointer;
+    using const_reference = typename mmap_type::const_reference;
+
+    /// Default prefetch window size (4MB); rounded up to a page multiple.
+    static constexpr size_type default_window_size = size_type(1) << 22;
+
+    /// Default number of windows kept in flight ahead of the read position.
+    static constexpr size_type default_prefetch_depth = 2;
+
+private:
+    mmap_type map_;
+    size_type window_size_ = default_window_size;
+    size_type prefetch_depth_ = default_prefetch_depth;
+    size_type prefetched_end_ = 0;  ///< Bytes already submitted for readahead.
+    size_type released_end_ = 0;    ///< Bytes already released behind the reader.
+
+    /**
+     * Advances the advice pipeline when the reader crosses into the window
+     * containing `offset`: releases the windows it has fully passed and
+     * tops the readahead back up to the configured depth. Failures are
+     * ignored - the pipeline is purely advisory.
+     */
+    void advance_pipeline(const size_type offset)
+    {
+        std::error_code ignored;
+        const size_type window_start = offset / window_size_ * window_size_;
+
+        if(window_start > released_end_)
+        {
+            map_.advise(advice::dont_need, released_end_,
+                    window_start - released_end_, ignored);
+            released_end_ = window_start;
+        }
+
+        const size_type target = std::min(
+                window_start + (prefetch_depth_ + 1) * window_size_,
+                map_.size());
+        if(target > prefetched_end_)
+        {
+            map_.advise(advice::will_need, prefetched_end_,
+                    target - prefetched_end_, ignored);
+            prefetched_end_ = target;
+        }
+    }
+
+public:
+    /**
+     * Read-only forward iterator that drives the prefetch pipeline.
+     *
+     * Dereference and comparison are pointer operations; the only overhead
+     * over a raw pointer is one comparison per increment against the next
+     * window boundary. Crossing a boundary advances the pipeline.
+     */
+    class iterator
+    {
+        friend class basic_mmap_stream;
+
+        const_pointer ptr_ = nullptr;
+        const_pointer boundary_ = nullptr;  ///< Next window crossing (or end).
+        basic_mmap_stream* stream_ = nullptr;
+
+        iterator(const_pointer ptr, basic_mmap_stream* stream) noexcept
+            : ptr_(ptr), stream_(stream)
+        {
+            if(stream_ != nullptr) { update_boundary(); }
+        }
+
+        void update_boundary() noexcept
+        {
+            const size_type offset = static_cast<size_type>(
+                    ptr_ - stream_->data());
+            const size_type next = std::min(
+                    (offset / stream_->window_size() + 1)
+                            * stream_->window_size(),
+                    stream_->size());
+            boundary_ = stream_->data() + next;
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename mmap_type::value_type;
+        using difference_type = typename mmap_type::difference_type;
+        using pointer = typename mmap_type::const_pointer;
+        using reference = typename mmap_type::const_reference;
+
+        iterator() = default;
+
+        [[nodiscard]] reference operator*() const noexcept { return *ptr_; }
+        [[nodiscard]] pointer operator->() const noexcept { return ptr_; }
+
+        iterator& operator++()
+        {
+            ++ptr_;
+            if(ptr_ == boundary_ && ptr_ != stream_->data() + stream_->size())
+            {
+                stream_->advance_pipeline(static_cast<size_type>(
+                        ptr_ - stream_->data()));
+                update_boundary();
+            }
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            iterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        [[nodiscard]] friend bool operator==(const iterator& a,
+                const iterator& b) noexcept { return a.ptr_ == b.ptr_; }
+        [[nodiscard]] friend bool operator!=(const iterator& a,
+                const iterator& b) noexcept { return a.ptr_ != b.ptr_; }
+    };
+
+    using const_iterator = iterator;
+
+    /**
+     * Constructs a closed stream.
+     *
+     * @param window_size    Size of each pipeline window in bytes; rounded
+     *                       up to a multiple of the page size on open().
+     * @param prefetch_depth Number of windows kept in flight ahead of the
+     *                       read position.
+     */
+    explicit basic_mmap_stream(
+            const size_type window_size = default_window_size,
+            const size_type prefetch_depth = default_prefetch_depth)
+        : window_size_(window_size), prefetch_depth_(prefetch_depth)
+    {}
+
+    basic_mmap_stream(basic_mmap_stream&&) = default;
+    basic_mmap_stream& operator=(basic_mmap_stream&&) = default;
+    basic_mmap_stream(const basic_mmap_stream&) = delete;
+    basic_mmap_stream& operator=(const basic_mmap_stream&) = delete;
+
+    /**
+     * Opens and maps the file at `path` and primes the readahead pipeline.
+     *
+     * @param path  Path of the file to stream.
+     * @param error Output parameter for error reporting.
+     */
+    void open(const std::filesystem::path& path, std::error_code& error)
+    {
+        error.clear();
+
+        if(window_size_ == 0)
+        {
+            error = std::make_error_code(std::errc::invalid_argument);
+            return;
+        }
+
+        mmap_type map;
+        map.map(path, error);
+        if(error) { return; }
+
+        map_ = std::move(map);
+        const size_type page_size_ = page_size();
+        window_size_ = (window_size_ + page_size_ - 1) / page_size_ * page_size_;
+        prefetched_end_ = released_end_ = 0;
+
+        // Tell the kernel the access pattern up front and kick off the
+        // first windows; failures are harmless.
+        std::error_code ignored;
+        map_.advise(advice::sequential, ignored);
+        advance_pipeline(0);
+    }
+
+    /** Unmaps the file. Safe to call on a closed stream (no-op). */
+    void close() { map_.unmap(); }
+
+    /** Returns whether a file is open. */
+    [[nodiscard]] bool is_open() const noexcept { return map_.is_open(); }
+
+    /** Returns the file size in bytes (0 when closed). */
+    [[nodiscard]] size_type size() const noexcept { return map_.size(); }
+
+    /** Returns whether the stream is empty (closed or zero-length file). */
+    [[nodiscard]] bool empty() const noexcept { return map_.empty(); }
+
+    /** Returns the (page-rounded) pipeline window size in bytes. */
+    [[nodiscard]] size_type window_size() const noexcept { return window_size_; }
+
+    /** Returns the configured prefetch depth in windows. */
+    [[nodiscard]] size_type prefetch_depth() const noexcept
+    {
+        return prefetch_depth_;
+    }
+
+    /** Returns a pointer to the start of the mapped data. */
+    [[nodiscard]] const_pointer data() const noexcept { return map_.data(); }
+
+    /** Returns an iterator to the first byte. */
+    [[nodiscard]] iterator begin() noexcept { return iterator(data(), this); }
+
+    /** Returns an iterator one past the last byte. */
+    [[nodiscard]] iterator end() noexcept
+    {
+        return iterator(data() + size(), this);
+    }
+};
+
+// -----------------------------------------------------------------------------
+// Convenience type aliases
+// -----------------------------------------------------------------------------
+
+using mmap_stream = basic_mmap_stream<char>;           ///< Streaming reader, char
+using ummap_stream = basic_mmap_stream<unsigned char>; ///< Streaming reader, unsigned char
+using bmmap_stream = basic_mmap_stream<std::byte>;     ///< Streaming reader, std::byte
+
+} // namespace mio
+
+#endif // MIO_MMAP_STREAM_HEADER
@@ -0,0 +1,369 @@
+/* Copyright 2017 https://github.com/mandreyel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MIO_MMAP_WINDOW_HEADER
+#define MIO_MMAP_WINDOW_HEADER
+
+// -----------------------------------------------------------------------------
+// mmap_window.hpp - Windowed access to files too large to map whole
+// -----------------------------------------------------------------------------
+//
+// This header provides basic_mmap_window, which exposes a file of arbitrary
+// size through a bounded set of page-aligned mapped windows with LRU
+// replacement, instead of one mapping spanning the whole file.
+//
+// Mapping a multi-terabyte file in one piece works, but is expensive in ways
+// that scale with mapping size rather than with the bytes actually touched:
+// the kernel's bookkeeping for the region, page-table teardown on unmap, and
+// the address space consumed all grow with the mapping. A windowed mapper
+// bounds all three while keeping mmap's zero-copy access model: view() hands
+// out direct pointers into the page cache, remapping windows only on miss.
+//
+// Usage:
+//   std::error_code ec;
+//   mio::mmap_window_source archive;
+//   archive.open("huge-archive.bin", ec);
+//   if (ec) { handle_error(ec); }
+//
+//   // Pointer valid until max_windows() later view() calls (LRU eviction)
+//   const char* record = archive.view(record_offset, record_size, ec);
+//
+// Pointer validity:
+// A pointer returned by view() stays valid until its window is evicted, which
+// can happen on any later view() miss. Callers that hold views across many
+// lookups should size max_windows accordingly or copy the data out.
+//
+// -----------------------------------------------------------------------------
+
+#include "mio/mmap.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mio {
+
+// -----------------------------------------------------------------------------
+// basic_mmap_window - Bounded-footprint view over a large file
+// -----------------------------------------------------------------------------
+
+/**
+ * Exposes a file of arbitrary size through a fixed budget of mapped windows.
+ *
+ * Windows are aligned to a grid of window_size bytes, so repeated views into
+ * the same region reuse one mapping. A view that straddles a grid boundary
+ * gets a window extended to cover it, so view() never fails for ranges up to
+ * the file size. When the window budget is exhausted, the least recently
+ * used window is unmapped.
+ *
+ * Template parameters mirror basic_mmap:
+ * @tparam AccessMode `access_mode::read` or `access_mode::write`.
+ * @tparam ByteT      The byte type for the mapped data. Must be 1 byte in size.
+ *
+ * Ownership semantics:
+ * - Move-only, like basic_mmap: the object owns the file handle and windows.
+ * - RAII: destruction unmaps all windows and closes the file.
+ *
+ * Thread safety: none. The window set is mutated by view(); callers sharing
+ * one instance across threads must synchronize externally (or give each
+ * thread its own instance, which the kernel page cache deduplicates anyway).
+ */
+template<
+    access_mode AccessMode,
+    typename ByteT
+> class basic_mmap_window
+{
+public:
+    using mmap_type = basic_mmap<AccessMode, ByteT>;
+    using value_type = typename mmap_type::value_type;
+    using size_type = typename mmap_type::size_type;
+    using pointer = typename mmap_type::pointer;
+    using const_pointer = typename mmap_type::const_pointer;
+    using handle_type = typename mmap_type::handle_type;
+
+    /**
+     * Pointer type returned by view(): const for read-only mappers, mutable
+     * for sinks, mirroring basic_mmap's data() overloads.
+     */
+    using view_pointer = std::conditional_t<
+            AccessMode == access_mode::read, const_pointer, pointer>;
+
+    /// Default window size (64MB); always rounded up to a page multiple.
+    static constexpr size_type default_window_size = size_type(1) << 26;
+
+    /// Default number of simultaneously mapped windows.
+    static constexpr size_type default_max_windows = 16;
+
+private:
+    /// One mapped window and the bookkeeping for LRU replacement.
+    struct window
+    {
+        size_type start;    ///< File offset of the window's first byte.
+        mmap_type map;      ///< The mapping covering [start, start + map.size()).
+        uint64_t last_use;  ///< Stamp of the most recent view() hit.
+    };
+
+    std::vector<window> windows_;
+    handle_type file_handle_ = invalid_handle;
+    size_type file_size_ = 0;
+    size_type window_size_ = default_window_size;
+    size_type max_windows_ = default_max_windows;
+    uint64_t use_counter_ = 0;
+
+    /// Start-of-data pointer with the right constness for the access mode.
+    static view_pointer window_data(mmap_type& map) noexcept
+    {
+        if constexpr(AccessMode == access_mode::read)
+        {
+            return std::as_const(map).data();
+        }
+        else
+        {
+            return map.data();
+        }
+    }
+
+public:
+    /**
+     * Constructs a closed windowed mapper.
+     *
+     * @param window_size Size of each window in bytes; rounded up to a
+     *                    multiple of the page size on open().
+     * @param max_windows Maximum number of simultaneously mapped windows
+     *                    (must be at least 1).
+     */
+    explicit basic_mmap_window(
+            const size_type window_size = default_window_size,
+            const size_type max_windows = default_max_windows)
+        : window_size_(window_size), max_windows_(max_windows)
+    {}
+
+    ~basic_mmap_window() { close(); }
+
+    /** Moving transfers the file handle and all windows. */
+    basic_mmap_window(basic_mmap_window&& other) noexcept
+        : windows_(std::move(other.windows_))
+        , file_handle_(other.file_handle_)
+        , file_size_(other.file_size_)
+        , window_size_(other.window_size_)
+        , max_windows_(other.max_windows_)
+        , use_counter_(other.use_counter_)
+    {
+        other.windows_.clear();
+        other.file_handle_ = invalid_handle;
+        other.file_size_ = 0;
+    }
+
+    /** @copydoc basic_mmap_window(basic_mmap_window&&) */
+    basic_mmap_window& operator=(basic_mmap_window&& other) noexcept
+    {
+        if(this != &other)
+        {
+            close();
+            windows_ = std::move(other.windows_);
+            file_handle_ = other.file_handle_;
+            file_size_ = other.file_size_;
+            window_size_ = other.window_size_;
+            max_windows_ = other.max_windows_;
+            use_counter_ = other.use_counter_;
+            other.windows_.clear();
+            other.file_handle_ = invalid_handle;
+            other.file_size_ = 0;
+        }
+        return *this;
+    }
+
+    // Windows own kernel resources; copying is not meaningful.
+    basic_mmap_window(const basic_mmap_window&) = delete;
+    basic_mmap_window& operator=(const basic_mmap_window&) = delete;
+
+    /** Returns whether a file is open. */
+    [[nodiscard]] bool is_open() const noexcept
+    {
+        return file_handle_ != invalid_handle;
+    }
+
+    /** Returns the size of the open file in bytes (0 when closed). */
+    [[nodiscard]] size_type file_size() const noexcept { return file_size_; }
+
+    /** Returns the (page-rounded) window size in bytes. */
+    [[nodiscard]] size_type window_size() const noexcept { return window_size_; }
+
+    /** Returns the window budget. */
+    [[nodiscard]] size_type max_windows() const noexcept { return max_windows_; }
+
+    /** Returns the number of currently mapped windows. */
+    [[nodiscard]] size_type mapped_windows() const noexcept
+    {
+        return windows_.size();
+    }
+
+    /**
+     * Opens the file at `path` for windowed access.
+     *
+     * No mapping is established yet; windows are created lazily by view().
+     * A zero window budget or a zero window size is rejected, as is a file
+     * that cannot be opened for the access mode.
+     *
+     * @param path  Path of the file to open.
+     * @param error Output parameter for error reporting.
+     */
+    void open(const std::filesystem::path& path, std::error_code& error)
+    {
+        error.clear();
+
+        if(max_windows_ == 0 || window_size_ == 0)
+        {
+            error = std::make_error_code(std::errc::invalid_argument);
+            return;
+        }
+
+        const auto handle = detail::open_file(path, AccessMode, error);
+        if(error) { return; }
+        const auto file_size = detail::query_file_size(handle, error);
+        if(error)
+        {
+            detail::close_file(handle);
+            return;
+        }
+
+        close();
+        file_handle_ = handle;
+        file_size_ = file_size;
+        // Round the window size up to a page multiple so grid-aligned
+        // window starts are valid mapping offsets.
+        const size_type page_size_ = page_size();
+        window_size_ = (window_size_ + page_size_ - 1) / page_size_ * page_size_;
+        windows_.reserve(max_windows_);
+    }
+
+    /**
+     * Returns a pointer to `length` contiguous mapped bytes at `offset`.
+     *
+     * On a hit the call is a lookup over the (small) window set; on a miss
+     * one window is mapped, evicting the least recently used window if the
+     * budget is exhausted. The returned pointer stays valid until the
+     * backing window is evicted by a later view() miss.
+     *
+     * @param offset File offset of the first byte of the view.
+     * @param length Number of bytes the view must cover; the range must lie
+     *               within the file.
+     * @param error  Output parameter for error reporting.
+     * @return Pointer to the first byte of the view, or nullptr on error.
+     */
+    [[nodiscard]] view_pointer view(const size_type offset, const size_type length,
+            std::error_code& error)
+    {
+        error.clear();
+
+        if(!is_open())
+        {
+            error = std::make_error_code(std::errc::bad_file_descriptor);
+            return nullptr;
+        }
+        if(offset > file_size_ || length > file_size_ - offset)
+        {
+            error = std::make_error_code(std::errc::invalid_argument);
+            return nullptr;
+        }
+
+        // Fast path: a mapped window already covers the range.
+        for(auto& w : windows_)
+        {
+            if(offset >= w.start && offset + length <= w.start + w.map.size())
+            {
+                w.last_use = ++use_counter_;
+                return window_data(w.map) + (offset - w.start);
+            }
+        }
+
+        // Miss: map the grid window containing offset, extended to cover a
+        // range that straddles a grid boundary and clamped to the file.
+        const size_type start = offset / window_size_ * window_size_;
+        const size_type end = std::min(
+                std::max(start + window_size_, offset + length), file_size_);
+
+        mmap_type map;
+        map.map(file_handle_, start, end - start, error);
+        if(error) { return nullptr; }
+
+        if(windows_.size() >= max_windows_)
+        {
+            auto lru = windows_.begin();
+            for(auto it = std::next(lru); it != windows_.end(); ++it)
+            {
+                if(it->last_use < lru->last_use) { lru = it; }
+            }
+            // Reuse the evicted slot instead of erase+push_back.
+            lru->start = start;
+            lru->map = std::move(map);
+            lru->last_use = ++use_counter_;
+            return window_data(lru->map) + (offset - start);
+        }
+
+        windows_.push_back(window{start, std::move(map), ++use_counter_});
+        return window_data(windows_.back().map) + (offset - start);
+    }
+
+    /**
+     * Unmaps all windows and closes the file.
+     *
+     * Outstanding view() pointers are invalidated. Safe to call on a closed
+     * object (no-op).
+     */
+    void close()
+    {
+        windows_.clear();
+        if(file_handle_ != invalid_handle)
+        {
+            detail::close_file(file_handle_);
+            file_handle_ = invalid_handle;
+        }
+        file_size_ = 0;
+        use_counter_ = 0;
+    }
+};
+
+// -----------------------------------------------------------------------------
+// Convenience type aliases
+// -----------------------------------------------------------------------------
+
+/// Read-only windowed mapper template over the byte type.
+template<typename ByteT>
+using basic_mmap_window_source = basic_mmap_window<access_mode::read, ByteT>;
+
+/// Read-write windowed mapper template over the byte type.
+template<typename ByteT>
+using basic_mmap_window_sink = basic_mmap_window<access_mode::write, ByteT>;
+
+using mmap_window_source = basic_mmap_window_source<char>;           ///< Read-only, char
+using ummap_window_source = basic_mmap_window_source<unsigned char>; ///< Read-only, unsigned char
+using bmmap_window_source = basic_mmap_window_source<std::byte>;     ///< Read-only, std::byte
+
+using mmap_window_sink = basic_mmap_window_sink<char>;           ///< Read-write, char
+using ummap_window_sink = basic_mmap_window_sink<unsigned char>; ///< Read-write, unsigned char
+using bmmap_window_sink = basic_mmap_window_sink<std::byte>;     ///< Read-write, std::byte
+
+} // namespace mio
+
+#endif // MIO_MMAP_WINDOW_HEADER
@@ -39,6 +39,12 @@
 //   size_t ps = mio::page_size();  // Get system page size (cached after first call)
 //   size_t aligned = mio::make_offset_page_aligned(offset);  // Align to page boundary
 //
+// Deployments that know their page granularity at build time can define
+// MIO_FIXED_PAGE_SIZE (e.g. -DMIO_FIXED_PAGE_SIZE=4096) to make page_size()
+// and the alignment math constant-foldable - no static-initialization guard
+// and no runtime arithmetic against a loaded value. Call assume_page_size()
+// once at startup to verify the assumption against the running system.
+//
 // -----------------------------------------------------------------------------
 
 #ifdef _WIN32
@@ -47,6 +53,12 @@
 # include <unistd.h>
 #endif
 
+#ifdef __linux__
+# include <cstdio>
+#endif
+
+#include <cstddef>
+
 namespace mio {
 
 /**
@@ -58,15 +70,74 @@ namespace mio {
  * - On Windows: PAGE_READONLY vs PAGE_READWRITE for CreateFileMapping(),
  *               FILE_MAP_READ vs FILE_MAP_WRITE for MapViewOfFile()
  *
+ * Copy-on-write mappings are writable in memory but private to the process:
+ * the first write to a page creates a private copy of it, and no change is
+ * ever written back to the file. This makes speculative modification of
+ * large read-only datasets lazy and per-page instead of requiring an
+ * up-front copy of the whole file:
+ * - On POSIX: PROT_READ|PROT_WRITE with MAP_PRIVATE
+ * - On Windows: PAGE_WRITECOPY / FILE_MAP_COPY
+ *
  * Note: There is no write-only mode because memory-mapped regions that are
  * writable must also be readable on most operating systems.
  */
 enum class access_mode
 {
-    read,   ///< Read-only access. Writes to mapped memory cause segfaults.
-    write   ///< Read-write access. Changes are synced to the file.
+    read,          ///< Read-only access. Writes to mapped memory cause segfaults.
+    write,         ///< Read-write access. Changes are synced to the file.
+    copy_on_write  ///< Private writable access. Changes never reach the file.
 };
 
+/**
+ * Compile-time page arithmetic for a known page allocation granularity.
+ *
+ * Page sizes are always powers of two, so once the granularity is a
+ * compile-time constant, every alignment operation reduces to a single
+ * mask instruction - no division and no static-initialization guard on a
+ * cached syscall result. This matters in paths that create mappings at
+ * high rates, where the alignment math in map() is otherwise measurable.
+ *
+ * The traits are pure arithmetic: they do not verify that `PageSize`
+ * matches the running system. Use assume_page_size() for that, or define
+ * MIO_FIXED_PAGE_SIZE to route the library's own alignment through a
+ * fixed granularity (see page_size() below).
+ *
+ * @tparam PageSize The page allocation granularity in bytes; must be a
+ *                  power of two.
+ */
+template<size_t PageSize>
+struct basic_page_traits
+{
+    static_assert(PageSize != 0 && (PageSize & (PageSize - 1)) == 0,
+            "page size must be a power of two");
+
+    /** Returns the page allocation granularity in bytes. */
+    [[nodiscard]] static constexpr size_t page_size() noexcept
+    {
+        return PageSize;
+    }
+
+    /** Rounds `offset` down to the nearest page boundary. */
+    [[nodiscard]] static constexpr size_t
+    make_offset_page_aligned(const size_t offset) noexcept
+    {
+        return offset & ~(PageSize - 1);
+    }
+
+    /** Rounds `length` up to the nearest page boundary. */
+    [[nodiscard]] static constexpr size_t
+    make_length_page_aligned(const size_t length) noexcept
+    {
+        return (length + PageSize - 1) & ~(PageSize - 1);
+    }
+};
+
+/// Page arithmetic for the 4KB granularity of typical Linux systems.
+using page_traits_4k = basic_page_traits<4096>;
+
+/// Page arithmetic for the 64KB allocation granularity of Windows.
+using page_traits_64k = basic_page_traits<size_t(1) << 16>;
+
 /**
  * Returns the operating system's page allocation granularity in bytes.
  *
@@ -83,10 +154,20 @@ enum class access_mode
  * not the page size. This function returns the correct value for mapping.
  *
  * Performance: The value is queried once on first call and cached in a static
- * variable, so subsequent calls have no syscall overhead.
+ * variable, so subsequent calls have no syscall overhead. Defining
+ * MIO_FIXED_PAGE_SIZE replaces the cached lookup with that constant, which
+ * also removes the thread-safe-initialization guard check from every call;
+ * the deployment is then responsible for verifying the value once via
+ * assume_page_size().
  *
  * @return The system's page allocation granularity in bytes.
  */
+#ifdef MIO_FIXED_PAGE_SIZE
+[[nodiscard]] constexpr size_t page_size() noexcept
+{
+    return basic_page_traits<MIO_FIXED_PAGE_SIZE>::page_size();
+}
+#else
 [[nodiscard]] inline size_t page_size()
 {
     // Use a lambda for static initialization - thread-safe in C++11 and later.
@@ -107,6 +188,83 @@ enum class access_mode
     }();
     return page_size;
 }
+#endif // MIO_FIXED_PAGE_SIZE
+
+/**
+ * Verifies a compile-time page-size assumption against the running system.
+ *
+ * The escape hatch for basic_page_traits and MIO_FIXED_PAGE_SIZE: call it
+ * once at startup and refuse to run (or fall back to a build without the
+ * fixed size) when it returns false, instead of discovering a mismatched
+ * granularity through failing map() calls later.
+ *
+ * @tparam PageSize The assumed page allocation granularity in bytes.
+ * @return Whether the system's actual granularity matches `PageSize`.
+ */
+template<size_t PageSize>
+[[nodiscard]] inline bool assume_page_size() noexcept
+{
+    // Query the OS directly: with MIO_FIXED_PAGE_SIZE defined, page_size()
+    // reports the assumption itself and could not detect a mismatch.
+#ifdef _WIN32
+    SYSTEM_INFO SystemInfo;
+    GetSystemInfo(&SystemInfo);
+    const size_t actual = SystemInfo.dwAllocationGranularity;
+#else
+    const size_t actual = static_cast<size_t>(sysconf(_SC_PAGE_SIZE));
+#endif
+    return basic_page_traits<PageSize>::page_size() == actual;
+}
+
+/**
+ * Returns the operating system's default large ("huge") page size in bytes.
+ *
+ * Large pages reduce TLB pressure and page-fault counts for big mappings,
+ * but must be explicitly requested when creating a mapping (MAP_HUGETLB on
+ * Linux, SEC_LARGE_PAGES on Windows). This function reports the size the
+ * system would use for such a mapping so callers can check alignment and
+ * size requirements up front.
+ *
+ * Implementation details:
+ * - On Windows: GetLargePageMinimum() (typically 2MB; 0 if unsupported)
+ * - On Linux: Hugepagesize from /proc/meminfo (typically 2MB)
+ * - Elsewhere: 0 (huge pages not supported through this library)
+ *
+ * Performance: Queried once on first call and cached, like page_size().
+ *
+ * @return The default large page size in bytes, or 0 if unavailable.
+ */
+[[nodiscard]] inline size_t large_page_size()
+{
+    static const size_t large_page_size = []() -> size_t
+    {
+#ifdef _WIN32
+        return GetLargePageMinimum();
+#elif defined(__linux__)
+        // The default huge page size is exposed as "Hugepagesize: N kB"
+        // in /proc/meminfo. Parse it once; failures report 0.
+        size_t size = 0;
+        if(std::FILE* meminfo = std::fopen("/proc/meminfo", "r"))
+        {
+            char line[256];
+            while(std::fgets(line, sizeof(line), meminfo))
+            {
+                unsigned long long kb = 0;
+                if(std::sscanf(line, "Hugepagesize: %llu kB", &kb) == 1)
+                {
+                    size = static_cast<size_t>(kb) * 1024;
+                    break;
+                }
+            }
+            std::fclose(meminfo);
+        }
+        return size;
+#else
+        return 0;
+#endif
+    }();
+    return large_page_size;
+}
 
 /**
  * Rounds down an offset to the nearest page-aligned boundary.
@@ -135,11 +293,10 @@ enum class access_mode
  */
 [[nodiscard]] inline size_t make_offset_page_aligned(size_t offset) noexcept
 {
-    const size_t page_size_ = page_size();
-    // Integer division truncates toward zero, effectively rounding down.
-    // Then multiply back to get the aligned value.
-    // Example: offset=5000, page_size=4096 -> 5000/4096=1 -> 1*4096=4096
-    return offset / page_size_ * page_size_;
+    // Page sizes are powers of two on every supported system, so rounding
+    // down is a mask: clearing the low bits of the offset.
+    // Example: offset=5000, page_size=4096 -> 5000 & ~4095 -> 4096
+    return offset & ~(page_size() - 1);
 }
 
 } // namespace mio
@@ -0,0 +1,241 @@
+/* Copyright 2017 https://github.com/mandreyel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MIO_PARALLEL_HEADER
+#define MIO_PARALLEL_HEADER
+
+// -----------------------------------------------------------------------------
+// parallel.hpp - Parallel chunked algorithms over mapped regions
+// -----------------------------------------------------------------------------
+//
+// This header provides parallel drivers for scanning a mapping with
+// multiple threads: parallel_for_each_chunk() applies a functor to
+// page-aligned chunks of the mapping, and parallel_reduce_chunk()
+// additionally combines per-chunk results into one value.
+//
+// Scanning a cold mapping with std::for_each is both single-threaded and
+// fault-bound: every major fault stalls the one thread at device latency.
+// The drivers here run chunks on a thread pool with dynamic chunk claiming
+// (so skewed per-chunk costs rebalance automatically) and advise each
+// claimed chunk plus a lookahead chunk with `will_need`, which starts
+// kernel readahead for upcoming data while the current chunk computes.
+//
+// Usage:
+//   mio::mmap_source map("big.bin", ec);
+//   const uint64_t sum = mio::parallel_reduce_chunk(map,
+//           1 << 22, uint64_t{0},
+//           [](const char* data, size_t size, size_t) {
+//               return checksum(data, size);
+//           },
+//           std::plus<uint64_t>{});
+//
+// The functor is called concurrently from pool threads and must be safe
+// to run in parallel on disjoint chunks. Exceptions it throws are
+// captured and the first one is rethrown on the calling thread after all
+// workers have stopped.
+//
+// -----------------------------------------------------------------------------
+
+#include "mio/mmap.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace mio {
+
+namespace detail {
+
+/**
+ * Shared driver: partitions `map` into page-aligned chunks and invokes
+ * `chunk_op(chunk_index, data, size, offset)` across `thread_count`
+ * threads. Chunks are claimed from a shared atomic counter - the same
+ * dynamic load balancing work stealing provides, without per-thread
+ * deques - and each claim advises its own chunk plus the chunk
+ * `thread_count` claims ahead with `will_need`, overlapping readahead
+ * with compute.
+ */
+template<typename MMap, typename ChunkOp>
+void parallel_chunk_driver(MMap& map, const size_t chunk_size,
+        const size_t thread_count, ChunkOp chunk_op)
+{
+    if(!map.is_open() || map.empty()) { return; }
+
+    // Chunk boundaries must be page-aligned so each worker's advise()
+    // calls and faults touch disjoint pages. Page sizes are powers of
+    // two, so rounding up is a mask.
+    const size_t page_mask = page_size() - 1;
+    const size_t chunk_bytes = std::max(
+            (chunk_size + page_mask) & ~page_mask, page_size());
+    const size_t chunk_count = (map.size() + chunk_bytes - 1) / chunk_bytes;
+    const size_t workers = std::max<size_t>(1,
+            std::min(thread_count, chunk_count));
+
+    std::atomic<size_t> next_chunk(0);
+    std::mutex error_mutex;
+    std::exception_ptr first_error;
+
+    const auto worker = [&](){
+        for(;;)
+        {
+            const size_t chunk = next_chunk.fetch_add(1,
+                    std::memory_order_relaxed);
+            if(chunk >= chunk_count) { return; }
+
+            const size_t offset = chunk * chunk_bytes;
+            const size_t size = std::min(chunk_bytes, map.size() - offset);
+
+            // Kick off readahead for this chunk and for the chunk this
+            // worker is likely to claim next; the kernel faults it in
+            // while the current chunk computes. Purely advisory.
+            std::error_code ignored;
+            map.advise(advice::will_need, offset, size, ignored);
+            const size_t lookahead = chunk + workers;
+            if(lookahead < chunk_count)
+            {
+                const size_t lookahead_offset = lookahead * chunk_bytes;
+                map.advise(advice::will_need, lookahead_offset,
+                        std::min(chunk_bytes, map.size() - lookahead_offset),
+                        ignored);
+            }
+
+            try
+            {
+                // The mapping is taken by non-const reference for
+                // advise(); read through the const accessor so read-only
+                // mappings work.
+                chunk_op(chunk, std::as_const(map).data() + offset, size,
+                        offset);
+            }
+            catch(...)
+            {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if(!first_error)
+                {
+                    first_error = std::current_exception();
+                }
+                return;
+            }
+        }
+    };
+
+    if(workers == 1)
+    {
+        worker();
+    }
+    else
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(workers);
+        for(size_t i = 0; i < workers; ++i)
+        {
+            threads.emplace_back(worker);
+        }
+        for(auto& thread : threads) { thread.join(); }
+    }
+
+    if(first_error) { std::rethrow_exception(first_error); }
+}
+
+} // namespace detail
+
+/**
+ * Applies `fn` to page-aligned chunks of the mapping in parallel.
+ *
+ * The mapping is split into chunks of `chunk_size` bytes rounded up to a
+ * page multiple (the final chunk holds the remainder); `fn(data, size,
+ * offset)` is invoked once per chunk from a pool of `thread_count`
+ * threads, where `offset` is the chunk's byte offset into the mapping.
+ * Chunks are claimed dynamically, so uneven per-chunk costs keep all
+ * threads busy, and each claim prefetches ahead with `will_need` so
+ * faulting overlaps compute.
+ *
+ * A closed or empty mapping is a no-op. The first exception thrown by
+ * `fn` is rethrown on the calling thread once all workers have stopped;
+ * remaining chunks may be skipped.
+ *
+ * @param map          The mapping to scan (any access mode; non-const
+ *                     because advise() mutates kernel state).
+ * @param chunk_size   Requested chunk size in bytes; rounded up to a page
+ *                     multiple, minimum one page.
+ * @param fn           Functor invoked as fn(const ByteT* data, size_t
+ *                     size, size_t offset); must be safe to call
+ *                     concurrently on disjoint chunks.
+ * @param thread_count Number of worker threads; defaults to the hardware
+ *                     concurrency.
+ */
+template<typename MMap, typename Fn>
+void parallel_for_each_chunk(MMap& map, const size_t chunk_size, Fn fn,
+        const size_t thread_count = std::thread::hardware_concurrency())
+{
+    detail::parallel_chunk_driver(map, chunk_size, thread_count,
+            [&fn](const size_t, const auto* data, const size_t size,
+                    const size_t offset)
+            {
+                fn(data, size, offset);
+            });
+}
+
+/**
+ * Reduces the mapping to a single value over page-aligned chunks in
+ * parallel.
+ *
+ * `chunk_fn(data, size, offset)` maps each chunk to a value of type `T`
+ * and `combine(T, T)` merges values. `combine` must be associative;
+ * chunks are combined in an unspecified order, so it should also be
+ * commutative unless all runs use one thread. Scheduling, prefetching,
+ * and exception behavior match parallel_for_each_chunk().
+ *
+ * @param map          The mapping to scan.
+ * @param chunk_size   Requested chunk size in bytes; rounded up to a page
+ *                     multiple, minimum one page.
+ * @param init         Identity value the reduction starts from.
+ * @param chunk_fn     Functor invoked as chunk_fn(const ByteT* data,
+ *                     size_t size, size_t offset) -> T.
+ * @param combine      Binary functor merging two T values.
+ * @param thread_count Number of worker threads; defaults to the hardware
+ *                     concurrency.
+ * @return The combined value, or `init` for a closed or empty mapping.
+ */
+template<typename MMap, typename T, typename ChunkFn, typename Combine>
+T parallel_reduce_chunk(MMap& map, const size_t chunk_size, T init,
+        ChunkFn chunk_fn, Combine combine,
+        const size_t thread_count = std::thread::hardware_concurrency())
+{
+    std::mutex result_mutex;
+    T result = std::move(init);
+    detail::parallel_chunk_driver(map, chunk_size, thread_count,
+            [&](const size_t, const auto* data, const size_t size,
+                    const size_t offset)
+            {
+                T partial = chunk_fn(data, size, offset);
+                std::lock_guard<std::mutex> lock(result_mutex);
+                result = combine(std::move(result), std::move(partial));
+            });
+    return result;
+}
+
+} // namespace mio
+
+#endif // MIO_PARALLEL_HEADER
@@ -65,6 +65,10 @@
 #include <cassert>
 #include <system_error>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
 
 namespace mio {
 
@@ -368,7 +372,7 @@ public:
      *
      * @return Const pointer to mapped data, or nullptr if not mapped.
      */
-    [[nodiscard]] const_pointer data() const noexcept { return pimpl_ ? pimpl_->data() : nullptr; }
+    [[nodiscard]] const_pointer data() const noexcept { return pimpl_ ? std::as_const(*pimpl_).data() : nullptr; }
 
     // -------------------------------------------------------------------------
     // Iterator access
@@ -391,7 +395,7 @@ public:
     /** @copydoc begin() */
     [[nodiscard]] const_iterator begin() const noexcept {
         assert(pimpl_ && "begin() called on empty shared_mmap");
-        return pimpl_->begin();
+        return std::as_const(*pimpl_).begin();
     }
 
     /** @copydoc begin() */
@@ -417,7 +421,7 @@ public:
     /** @copydoc end() */
     [[nodiscard]] const_iterator end() const noexcept {
         assert(pimpl_ && "end() called on empty shared_mmap");
-        return pimpl_->end();
+        return std::as_const(*pimpl_).end();
     }
 
     /** @copydoc end() */
@@ -442,7 +446,7 @@ public:
     /** @copydoc rbegin() */
     [[nodiscard]] const_reverse_iterator rbegin() const noexcept {
         assert(pimpl_ && "rbegin() called on empty shared_mmap");
-        return pimpl_->rbegin();
+        return std::as_const(*pimpl_).rbegin();
     }
 
     /** @copydoc rbegin() */
@@ -467,7 +471,7 @@ public:
     /** @copydoc rend() */
     [[nodiscard]] const_reverse_iterator rend() const noexcept {
         assert(pimpl_ && "rend() called on empty shared_mmap");
-        return pimpl_->rend();
+        return std::as_const(*pimpl_).rend();
     }
 
     /** @copydoc rend() */
@@ -497,7 +501,7 @@ public:
     /** @copydoc operator[]() */
     [[nodiscard]] const_reference operator[](const size_type i) const noexcept {
         assert(pimpl_ && "operator[] called on empty shared_mmap");
-        return (*pimpl_)[i];
+        return std::as_const(*pimpl_)[i];
     }
 
     // -------------------------------------------------------------------------
@@ -847,6 +851,148 @@ shared_mmap_sink make_shared_mmap_sink(const MappingToken& token, std::error_cod
     return make_shared_mmap_sink(token, 0, map_entire_file, error);
 }
 
+// -----------------------------------------------------------------------------
+// mmap_registry - Process-wide deduplication of read-only mappings
+// -----------------------------------------------------------------------------
+
+/**
+ * Process-wide registry resolving concurrent opens of the same file to one
+ * underlying mapping.
+ *
+ * Two independent `make_shared_mmap_source("same/file")` calls create two
+ * kernel mappings and two file handles even though the page cache backs
+ * both with the same physical pages. For workloads that open the same hot
+ * files from many threads, the registry collapses those into a single
+ * mapping: opens of an already-mapped file are a stat + hash lookup instead
+ * of an open + mmap syscall pair, and the process's file handle and VMA
+ * counts stay proportional to the number of distinct files.
+ *
+ * Files are keyed by on-disk identity (device + inode / volume + file
+ * index), so different paths to the same file - symlinks, hard links,
+ * relative paths - share one mapping. Entries are weak references: the
+ * mapping lives for as long as any returned shared_mmap_source does, and
+ * expired entries are reclaimed lazily (or eagerly via purge()).
+ *
+ * Only whole-file read-only mappings are deduplicated; write mappings have
+ * caller-visible lifetime semantics (sync on destruction) that sharing
+ * would silently change.
+ *
+ * Thread safety: all members are safe to call concurrently. Lookups take a
+ * shared lock, so the hot path scales across reader threads; only a miss
+ * (first open of a file) takes the exclusive lock.
+ *
+ * Opt-in: use mio::make_cached_mmap_source() or instance() directly;
+ * mappings made through the regular factories never enter the registry.
+ */
+class mmap_registry
+{
+public:
+    /** Returns the process-wide registry instance. */
+    static mmap_registry& instance()
+    {
+        static mmap_registry registry;
+        return registry;
+    }
+
+    /**
+     * Opens a whole-file read-only mapping, reusing a live mapping of the
+     * same file if one exists.
+     *
+     * @param path  Path of the file to map.
+     * @param error Output parameter for error reporting.
+     * @return A shared_mmap_source sharing the deduplicated mapping; empty
+     *         on error.
+     */
+    shared_mmap_source open(const std::filesystem::path& path,
+            std::error_code& error)
+    {
+        error.clear();
+
+        const detail::file_id id = detail::query_file_id(path, error);
+        if(error) { return {}; }
+
+        // Fast path: the file is already mapped.
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            const auto it = cache_.find(id);
+            if(it != cache_.end())
+            {
+                if(auto existing = it->second.lock())
+                {
+                    return shared_mmap_source(std::move(existing));
+                }
+            }
+        }
+
+        // Miss: map the file under the exclusive lock. Re-check the cache
+        // first - another thread may have mapped it while we waited.
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        const auto it = cache_.find(id);
+        if(it != cache_.end())
+        {
+            if(auto existing = it->second.lock())
+            {
+                return shared_mmap_source(std::move(existing));
+            }
+        }
+
+        mmap_source map;
+        map.map(path, error);
+        if(error) { return {}; }
+
+        auto shared = std::make_shared<mmap_source>(std::move(map));
+        cache_[id] = shared;
+        return shared_mmap_source(std::move(shared));
+    }
+
+    /** Returns the number of live (non-expired) mappings in the registry. */
+    [[nodiscard]] size_t size() const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        size_t count = 0;
+        for(const auto& entry : cache_)
+        {
+            if(!entry.second.expired()) { ++count; }
+        }
+        return count;
+    }
+
+    /** Drops expired entries (mappings whose last owner has gone away). */
+    void purge()
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        for(auto it = cache_.begin(); it != cache_.end();)
+        {
+            if(it->second.expired()) { it = cache_.erase(it); }
+            else { ++it; }
+        }
+    }
+
+private:
+    mmap_registry() = default;
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<detail::file_id, std::weak_ptr<mmap_source>,
+            detail::file_id_hash> cache_;
+};
+
+/**
+ * Creates a whole-file read-only mapping through the process-wide registry.
+ *
+ * Equivalent to mmap_registry::instance().open(path, error): concurrent
+ * opens of the same file (by any path reaching it) share one underlying
+ * mapping and file handle.
+ *
+ * @param path  Path of the file to map.
+ * @param error Output parameter for error reporting.
+ * @return A shared_mmap_source sharing the deduplicated mapping.
+ */
+inline shared_mmap_source make_cached_mmap_source(
+        const std::filesystem::path& path, std::error_code& error)
+{
+    return mmap_registry::instance().open(path, error);
+}
+
 } // namespace mio
 
 #endif // MIO_SHARED_MMAP_HEADER
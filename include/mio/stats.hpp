@@ -0,0 +1,300 @@
+/* Copyright 2017 https://github.com/mandreyel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MIO_STATS_HEADER
+#define MIO_STATS_HEADER
+
+// -----------------------------------------------------------------------------
+// stats.hpp - Opt-in instrumentation of mapping operations
+// -----------------------------------------------------------------------------
+//
+// This header provides a process-wide counter of mio's operations - maps,
+// unmaps, syncs, bytes mapped, sync wall time, failures - for feeding an
+// observability stack. When a latency regression appears, the counters say
+// whether msync stalled or mapping slowed down without attaching a tracer
+// to production.
+//
+// The facility is compiled out by default. Define MIO_ENABLE_STATS to turn
+// it on; without it, the recording hooks in detail/mmap.ipp are empty
+// inline functions the optimizer deletes, so the disabled build pays
+// nothing - not even a branch. The stats API itself stays available in
+// both builds (reporting zeros when disabled) so monitoring code compiles
+// unconditionally.
+//
+// Usage:
+//   mio::stats::instance().set_callback([](const mio::stats_event& e) {
+//       metrics.count("mio.op", 1, {{"op", name(e.operation)},
+//                                   {"failed", e.failed}});
+//   });
+//   ...
+//   const auto snap = mio::stats::instance().snapshot();
+//   report(snap.sync_count, snap.sync_duration_ns);
+//
+// Counters cover operations that reach the OS; argument-validation
+// failures (closed mapping, bad range) are rejected before the hooks run.
+//
+// -----------------------------------------------------------------------------
+
+#include <cstdint>
+
+#ifdef MIO_ENABLE_STATS
+# include <atomic>
+# include <chrono>
+# include <functional>
+# include <mutex>
+# include <system_error>
+# include <utility>
+#else
+# include <system_error>
+#endif
+
+namespace mio {
+
+/** The kind of operation a stats_event describes. */
+enum class stats_operation
+{
+    map,    ///< A file-backed or anonymous mapping was created.
+    unmap,  ///< A mapping was released.
+    sync    ///< A mapping range was flushed.
+};
+
+/**
+ * One recorded operation, as delivered to the registered callback.
+ */
+struct stats_event
+{
+    stats_operation operation; ///< What happened.
+    uint64_t bytes;            ///< Bytes mapped (map events; 0 otherwise).
+    uint64_t duration_ns;      ///< Wall time (sync events; 0 otherwise).
+    bool failed;               ///< Whether the operation reported an error.
+};
+
+/**
+ * Aggregated view of all operations recorded so far.
+ */
+struct stats_snapshot
+{
+    uint64_t map_count = 0;           ///< Successful map operations.
+    uint64_t unmap_count = 0;         ///< Unmap operations.
+    uint64_t sync_count = 0;          ///< Successful sync operations.
+    uint64_t failed_operations = 0;   ///< Operations that reported an error.
+    uint64_t bytes_mapped = 0;        ///< Cumulative bytes over successful maps.
+    uint64_t sync_duration_ns = 0;    ///< Cumulative wall time spent in sync.
+    uint64_t max_sync_duration_ns = 0;///< Slowest single sync observed.
+};
+
+#ifdef MIO_ENABLE_STATS
+
+/**
+ * Process-wide operation counters with an optional per-event callback.
+ *
+ * Thread safety: recording and snapshotting use relaxed atomics (the
+ * counters are statistics, not synchronization); the callback is invoked
+ * under a mutex, so a slow callback serializes recording - keep it cheap
+ * and hand off to the metrics pipeline asynchronously.
+ */
+class stats
+{
+public:
+    using callback_type = std::function<void(const stats_event&)>;
+
+    /** Returns the process-wide instance. */
+    static stats& instance()
+    {
+        static stats instance_;
+        return instance_;
+    }
+
+    /** Returns a consistent-enough copy of the counters. */
+    [[nodiscard]] stats_snapshot snapshot() const noexcept
+    {
+        stats_snapshot snap;
+        snap.map_count = map_count_.load(std::memory_order_relaxed);
+        snap.unmap_count = unmap_count_.load(std::memory_order_relaxed);
+        snap.sync_count = sync_count_.load(std::memory_order_relaxed);
+        snap.failed_operations =
+                failed_operations_.load(std::memory_order_relaxed);
+        snap.bytes_mapped = bytes_mapped_.load(std::memory_order_relaxed);
+        snap.sync_duration_ns =
+                sync_duration_ns_.load(std::memory_order_relaxed);
+        snap.max_sync_duration_ns =
+                max_sync_duration_ns_.load(std::memory_order_relaxed);
+        return snap;
+    }
+
+    /**
+     * Registers a callback invoked once per recorded event; pass an empty
+     * callback to unregister.
+     */
+    void set_callback(callback_type callback)
+    {
+        std::lock_guard<std::mutex> lock(callback_mutex_);
+        callback_ = std::move(callback);
+    }
+
+    /** Resets every counter to zero. The callback stays registered. */
+    void reset() noexcept
+    {
+        map_count_.store(0, std::memory_order_relaxed);
+        unmap_count_.store(0, std::memory_order_relaxed);
+        sync_count_.store(0, std::memory_order_relaxed);
+        failed_operations_.store(0, std::memory_order_relaxed);
+        bytes_mapped_.store(0, std::memory_order_relaxed);
+        sync_duration_ns_.store(0, std::memory_order_relaxed);
+        max_sync_duration_ns_.store(0, std::memory_order_relaxed);
+    }
+
+    /** Records one event. Called from the hooks in detail/mmap.ipp. */
+    void record(const stats_event& event)
+    {
+        if(event.failed)
+        {
+            failed_operations_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else switch(event.operation)
+        {
+        case stats_operation::map:
+            map_count_.fetch_add(1, std::memory_order_relaxed);
+            bytes_mapped_.fetch_add(event.bytes, std::memory_order_relaxed);
+            break;
+        case stats_operation::unmap:
+            unmap_count_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case stats_operation::sync:
+            sync_count_.fetch_add(1, std::memory_order_relaxed);
+            sync_duration_ns_.fetch_add(event.duration_ns,
+                    std::memory_order_relaxed);
+            uint64_t seen =
+                    max_sync_duration_ns_.load(std::memory_order_relaxed);
+            while(event.duration_ns > seen
+                  && !max_sync_duration_ns_.compare_exchange_weak(seen,
+                        event.duration_ns, std::memory_order_relaxed))
+            {}
+            break;
+        }
+
+        std::lock_guard<std::mutex> lock(callback_mutex_);
+        if(callback_) { callback_(event); }
+    }
+
+private:
+    stats() = default;
+
+    std::atomic<uint64_t> map_count_{0};
+    std::atomic<uint64_t> unmap_count_{0};
+    std::atomic<uint64_t> sync_count_{0};
+    std::atomic<uint64_t> failed_operations_{0};
+    std::atomic<uint64_t> bytes_mapped_{0};
+    std::atomic<uint64_t> sync_duration_ns_{0};
+    std::atomic<uint64_t> max_sync_duration_ns_{0};
+
+    mutable std::mutex callback_mutex_;
+    callback_type callback_;
+};
+
+namespace detail {
+
+/** Records a map attempt that reached the OS. */
+inline void stats_on_map(const uint64_t bytes, const bool failed)
+{
+    stats::instance().record({stats_operation::map, bytes, 0, failed});
+}
+
+/** Records an unmap of `bytes` mapped bytes. */
+inline void stats_on_unmap(const uint64_t bytes)
+{
+    stats::instance().record({stats_operation::unmap, bytes, 0, false});
+}
+
+/**
+ * Times the enclosing sync operation and records it on scope exit,
+ * reading the operation's error code to classify success.
+ */
+class stats_sync_timer
+{
+    const std::error_code& error_;
+    std::chrono::steady_clock::time_point start_;
+
+public:
+    explicit stats_sync_timer(const std::error_code& error) noexcept
+        : error_(error), start_(std::chrono::steady_clock::now())
+    {}
+
+    ~stats_sync_timer()
+    {
+        const auto elapsed = std::chrono::duration_cast<
+                std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start_);
+        stats::instance().record({stats_operation::sync, 0,
+                static_cast<uint64_t>(elapsed.count()),
+                static_cast<bool>(error_)});
+    }
+
+    stats_sync_timer(const stats_sync_timer&) = delete;
+    stats_sync_timer& operator=(const stats_sync_timer&) = delete;
+};
+
+} // namespace detail
+
+#else // MIO_ENABLE_STATS not defined
+
+/**
+ * Disabled stand-in for the stats facility: same interface, no recording,
+ * so monitoring code compiles whether or not the build enables stats.
+ */
+class stats
+{
+public:
+    static stats& instance() noexcept
+    {
+        static stats instance_;
+        return instance_;
+    }
+
+    [[nodiscard]] stats_snapshot snapshot() const noexcept { return {}; }
+
+    template<typename Callback>
+    void set_callback(Callback&&) noexcept {}
+
+    void reset() noexcept {}
+
+private:
+    stats() = default;
+};
+
+namespace detail {
+
+// No-op hooks: with the calls inlined away, the disabled build carries no
+// trace of the facility.
+inline void stats_on_map(uint64_t, bool) noexcept {}
+inline void stats_on_unmap(uint64_t) noexcept {}
+
+struct stats_sync_timer
+{
+    explicit stats_sync_timer(const std::error_code&) noexcept {}
+};
+
+} // namespace detail
+
+#endif // MIO_ENABLE_STATS
+
+} // namespace mio
+
+#endif // MIO_STATS_HEADER
@@ -0,0 +1,115 @@
+/* Copyright 2017 https://github.com/mandreyel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// -----------------------------------------------------------------------------
+// mio.cppm - C++20 module interface for the core mapping API
+// -----------------------------------------------------------------------------
+//
+// Importing `mio` gives consumers basic_mmap, basic_shared_mmap, their
+// aliases, and the make_* factories without re-parsing mio's headers -
+// or <windows.h> and <filesystem> behind them - in every translation
+// unit. The headers are included in the global module fragment below, so
+// WIN32_LEAN_AND_MEAN / NOMINMAX stay contained here instead of leaking
+// into user code.
+//
+// Usage:
+//   import mio;
+//   std::error_code ec;
+//   mio::mmap_source file = mio::make_mmap_source("data.bin", ec);
+//
+// Built by the `mio_module` CMake target (requires CMake 3.28+ and a
+// compiler with C++20 module support); header-only consumption is
+// unaffected.
+//
+// -----------------------------------------------------------------------------
+
+module;
+
+#include <mio/mmap.hpp>
+#include <mio/shared_mmap.hpp>
+
+export module mio;
+
+export namespace mio {
+
+// Constants and supporting types the mapping API is used with
+using ::mio::map_entire_file;
+using ::mio::invalid_handle;
+using ::mio::file_handle_type;
+using ::mio::access_mode;
+using ::mio::advice;
+using ::mio::page_mode;
+using ::mio::numa_policy;
+using ::mio::map_options;
+using ::mio::sync_mode;
+using ::mio::page_size;
+using ::mio::large_page_size;
+using ::mio::make_offset_page_aligned;
+
+// Core mapping class and its aliases
+using ::mio::basic_mmap;
+using ::mio::basic_mmap_source;
+using ::mio::basic_mmap_sink;
+using ::mio::basic_cow_mmap;
+using ::mio::mmap_source;
+using ::mio::ummap_source;
+using ::mio::bmmap_source;
+using ::mio::mmap_sink;
+using ::mio::ummap_sink;
+using ::mio::bmmap_sink;
+using ::mio::mmap_cow;
+using ::mio::ummap_cow;
+using ::mio::bmmap_cow;
+
+// Shared-ownership wrapper and its aliases
+using ::mio::basic_shared_mmap;
+using ::mio::basic_shared_mmap_source;
+using ::mio::basic_shared_mmap_sink;
+using ::mio::shared_mmap_source;
+using ::mio::shared_ummap_source;
+using ::mio::shared_bmmap_source;
+using ::mio::shared_mmap_sink;
+using ::mio::shared_ummap_sink;
+using ::mio::shared_bmmap_sink;
+
+// Factories
+using ::mio::make_mmap;
+using ::mio::make_mmap_source;
+using ::mio::make_mmap_sink;
+using ::mio::make_mmap_cow;
+using ::mio::make_shared_mmap_source;
+using ::mio::make_shared_mmap_sink;
+
+// Free functions over mappings
+using ::mio::copy_to;
+using ::mio::copy_from;
+using ::mio::fill;
+using ::mio::clone_range;
+
+// Comparison operators participate via ADL on the exported types, but
+// exporting them keeps qualified uses working too.
+using ::mio::operator==;
+using ::mio::operator!=;
+using ::mio::operator<;
+using ::mio::operator<=;
+using ::mio::operator>;
+using ::mio::operator>=;
+
+} // export namespace mio
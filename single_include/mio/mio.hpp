@@ -18,6 +18,57 @@
  * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#ifndef MIO_ASYNC_HEADER
+#define MIO_ASYNC_HEADER
+
+// -----------------------------------------------------------------------------
+// async.hpp - Asynchronous mapping, prefetch, and sync operations
+// -----------------------------------------------------------------------------
+//
+// This header provides async_engine, which moves mio's potentially blocking
+// operations off the calling thread: mapping a cold file (open + fstat +
+// mmap touch disk for metadata), prefetching a range into residency (page
+// faults at device latency), and sync() (writeback). In an async server,
+// any of these on a reactor thread stalls every connection it serves; the
+// engine runs them on its own workers and reports completion through a
+// std::future, or through co_await in C++20.
+//
+// Usage (futures):
+//   mio::async_engine engine;
+//   auto pending = engine.map<mio::mmap_source>("data.bin");
+//   ... // do other work
+//   auto [map, ec] = pending.get();
+//
+// Usage (C++20 coroutines):
+//   auto [map, ec] = co_await engine.async_map<mio::mmap_source>("data.bin");
+//   co_await engine.async_prefetch(map, 0, mio::map_entire_file);
+//
+// The coroutine is resumed on an engine worker thread; reschedule onto your
+// own executor after co_await if thread affinity matters.
+//
+// -----------------------------------------------------------------------------
+
+// #include "mio/mmap.hpp"
+/* Copyright 2017 https://github.com/mandreyel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
 #ifndef MIO_MMAP_HEADER
 #define MIO_MMAP_HEADER
 
@@ -60,6 +111,239 @@
 //
 // -----------------------------------------------------------------------------
 
+// #include "mio/detail/nontemporal.hpp"
+/* Copyright 2017 https://github.com/mandreyel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MIO_DETAIL_NONTEMPORAL_HEADER
+#define MIO_DETAIL_NONTEMPORAL_HEADER
+
+// -----------------------------------------------------------------------------
+// nontemporal.hpp - Cache-bypassing bulk copy and fill kernels
+// -----------------------------------------------------------------------------
+//
+// Low-level kernels behind mio::copy_to / mio::fill / mio::copy_from in
+// mmap.hpp. Writing a large range through the cache costs a
+// read-for-ownership on every destination line and evicts the working set
+// with data that will not be re-read; non-temporal (streaming) stores skip
+// both. On x86 the kernels use AVX or SSE2 streaming stores when the
+// compiler targets them, with a prefetchnta hint on the source; everywhere
+// else they compile to plain memcpy/memset.
+//
+// Small ranges always take the memcpy/memset path: below a few hundred KiB
+// the data plausibly fits in cache and bypassing it only hurts.
+//
+// -----------------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64) \
+        || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <immintrin.h>
+# define MIO_NONTEMPORAL_SIMD 1
+#endif
+
+namespace mio {
+namespace detail {
+
+/**
+ * Transfers below this size use plain memcpy/memset: the range plausibly
+ * fits in cache, where keeping it is a win and bypassing it a loss.
+ */
+inline constexpr size_t nontemporal_threshold = size_t(1) << 18; // 256 KiB
+
+#ifdef MIO_NONTEMPORAL_SIMD
+/** Source prefetch distance for the streaming loops. */
+inline constexpr size_t nontemporal_prefetch_distance = 512;
+#endif
+
+/**
+ * Copies `length` bytes from `src` to `dst`, with streaming stores for
+ * large ranges where the target supports them.
+ *
+ * The destination is brought to vector alignment with a scalar head,
+ * the bulk is streamed with unaligned loads and non-temporal stores,
+ * and the remainder is handled by memcpy. A store fence at the end
+ * makes the streamed data visible before the call returns, so callers
+ * need no ordering awareness.
+ *
+ * @param dst    Destination (no alignment requirement).
+ * @param src    Source (no alignment requirement, must not overlap dst).
+ * @param length Number of bytes to copy.
+ */
+inline void nontemporal_copy(void* const dst, const void* const src,
+        const size_t length)
+{
+#ifdef MIO_NONTEMPORAL_SIMD
+    if(length >= nontemporal_threshold)
+    {
+        unsigned char* d = static_cast<unsigned char*>(dst);
+        const unsigned char* s = static_cast<const unsigned char*>(src);
+        size_t n = length;
+
+# ifdef __AVX__
+        constexpr size_t vector_size = sizeof(__m256i);
+# else
+        constexpr size_t vector_size = sizeof(__m128i);
+# endif
+        const size_t misalignment =
+                reinterpret_cast<uintptr_t>(d) & (vector_size - 1);
+        if(misalignment != 0)
+        {
+            const size_t head = vector_size - misalignment;
+            std::memcpy(d, s, head);
+            d += head;
+            s += head;
+            n -= head;
+        }
+
+        while(n >= vector_size)
+        {
+            _mm_prefetch(reinterpret_cast<const char*>(s)
+                    + nontemporal_prefetch_distance, _MM_HINT_NTA);
+# ifdef __AVX__
+            _mm256_stream_si256(reinterpret_cast<__m256i*>(d),
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s)));
+# else
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d),
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(s)));
+# endif
+            d += vector_size;
+            s += vector_size;
+            n -= vector_size;
+        }
+        _mm_sfence();
+
+        if(n != 0) { std::memcpy(d, s, n); }
+        return;
+    }
+#endif // MIO_NONTEMPORAL_SIMD
+    std::memcpy(dst, src, length);
+}
+
+/**
+ * Fills `length` bytes at `dst` with `value`, with streaming stores for
+ * large ranges where the target supports them.
+ *
+ * Same structure as nontemporal_copy(): scalar head to alignment,
+ * streamed bulk, memset tail, store fence.
+ *
+ * @param dst    Destination (no alignment requirement).
+ * @param value  Byte value to fill with.
+ * @param length Number of bytes to fill.
+ */
+inline void nontemporal_fill(void* const dst, const unsigned char value,
+        const size_t length)
+{
+#ifdef MIO_NONTEMPORAL_SIMD
+    if(length >= nontemporal_threshold)
+    {
+        unsigned char* d = static_cast<unsigned char*>(dst);
+        size_t n = length;
+
+# ifdef __AVX__
+        constexpr size_t vector_size = sizeof(__m256i);
+        const __m256i pattern = _mm256_set1_epi8(static_cast<char>(value));
+# else
+        constexpr size_t vector_size = sizeof(__m128i);
+        const __m128i pattern = _mm_set1_epi8(static_cast<char>(value));
+# endif
+        const size_t misalignment =
+                reinterpret_cast<uintptr_t>(d) & (vector_size - 1);
+        if(misalignment != 0)
+        {
+            const size_t head = vector_size - misalignment;
+            std::memset(d, value, head);
+            d += head;
+            n -= head;
+        }
+
+        while(n >= vector_size)
+        {
+# ifdef __AVX__
+            _mm256_stream_si256(reinterpret_cast<__m256i*>(d), pattern);
+# else
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d), pattern);
+# endif
+            d += vector_size;
+            n -= vector_size;
+        }
+        _mm_sfence();
+
+        if(n != 0) { std::memset(d, value, n); }
+        return;
+    }
+#endif // MIO_NONTEMPORAL_SIMD
+    std::memset(dst, value, length);
+}
+
+#ifdef MIO_NONTEMPORAL_SIMD
+
+/** Cacheline granularity assumed by flush_cachelines(). */
+inline constexpr size_t cacheline_size = 64;
+
+/**
+ * Flushes every cacheline covering [address, address + length) to the
+ * memory controller and fences.
+ *
+ * On persistent-memory (DAX/CXL) mappings this is the whole durability
+ * story: once the lines have left the cache hierarchy, ADR guarantees
+ * they reach media. Uses clwb where the build targets it (keeps the line
+ * cached), clflushopt next, and the universally available clflush
+ * otherwise.
+ *
+ * Only defined on x86 targets; MIO_CACHELINE_FLUSH advertises its
+ * availability so callers can fall back to msync().
+ *
+ * @param address Start of the range (no alignment requirement).
+ * @param length  Number of bytes whose lines to flush.
+ */
+inline void flush_cachelines(const void* const address, const size_t length)
+{
+    const char* line = reinterpret_cast<const char*>(
+            reinterpret_cast<uintptr_t>(address) & ~(cacheline_size - 1));
+    const char* const end =
+            reinterpret_cast<const char*>(address) + length;
+    for(; line < end; line += cacheline_size)
+    {
+# if defined(__CLWB__)
+        _mm_clwb(const_cast<char*>(line));
+# elif defined(__CLFLUSHOPT__)
+        _mm_clflushopt(const_cast<char*>(line));
+# else
+        _mm_clflush(line);
+# endif
+    }
+    _mm_sfence();
+}
+
+# define MIO_CACHELINE_FLUSH 1
+#endif // MIO_NONTEMPORAL_SIMD
+
+} // namespace detail
+} // namespace mio
+
+#endif // MIO_DETAIL_NONTEMPORAL_HEADER
+
 // #include "mio/page.hpp"
 /* Copyright 2017 https://github.com/mandreyel
  *
@@ -102,6 +386,12 @@
 //   size_t ps = mio::page_size();  // Get system page size (cached after first call)
 //   size_t aligned = mio::make_offset_page_aligned(offset);  // Align to page boundary
 //
+// Deployments that know their page granularity at build time can define
+// MIO_FIXED_PAGE_SIZE (e.g. -DMIO_FIXED_PAGE_SIZE=4096) to make page_size()
+// and the alignment math constant-foldable - no static-initialization guard
+// and no runtime arithmetic against a loaded value. Call assume_page_size()
+// once at startup to verify the assumption against the running system.
+//
 // -----------------------------------------------------------------------------
 
 #ifdef _WIN32
@@ -110,6 +400,12 @@
 # include <unistd.h>
 #endif
 
+#ifdef __linux__
+# include <cstdio>
+#endif
+
+#include <cstddef>
+
 namespace mio {
 
 /**
@@ -121,15 +417,74 @@ namespace mio {
  * - On Windows: PAGE_READONLY vs PAGE_READWRITE for CreateFileMapping(),
  *               FILE_MAP_READ vs FILE_MAP_WRITE for MapViewOfFile()
  *
+ * Copy-on-write mappings are writable in memory but private to the process:
+ * the first write to a page creates a private copy of it, and no change is
+ * ever written back to the file. This makes speculative modification of
+ * large read-only datasets lazy and per-page instead of requiring an
+ * up-front copy of the whole file:
+ * - On POSIX: PROT_READ|PROT_WRITE with MAP_PRIVATE
+ * - On Windows: PAGE_WRITECOPY / FILE_MAP_COPY
+ *
  * Note: There is no write-only mode because memory-mapped regions that are
  * writable must also be readable on most operating systems.
  */
 enum class access_mode
 {
-    read,   ///< Read-only access. Writes to mapped memory cause segfaults.
-    write   ///< Read-write access. Changes are synced to the file.
+    read,          ///< Read-only access. Writes to mapped memory cause segfaults.
+    write,         ///< Read-write access. Changes are synced to the file.
+    copy_on_write  ///< Private writable access. Changes never reach the file.
+};
+
+/**
+ * Compile-time page arithmetic for a known page allocation granularity.
+ *
+ * Page sizes are always powers of two, so once the granularity is a
+ * compile-time constant, every alignment operation reduces to a single
+ * mask instruction - no division and no static-initialization guard on a
+ * cached syscall result. This matters in paths that create mappings at
+ * high rates, where the alignment math in map() is otherwise measurable.
+ *
+ * The traits are pure arithmetic: they do not verify that `PageSize`
+ * matches the running system. Use assume_page_size() for that, or define
+ * MIO_FIXED_PAGE_SIZE to route the library's own alignment through a
+ * fixed granularity (see page_size() below).
+ *
+ * @tparam PageSize The page allocation granularity in bytes; must be a
+ *                  power of two.
+ */
+template<size_t PageSize>
+struct basic_page_traits
+{
+    static_assert(PageSize != 0 && (PageSize & (PageSize - 1)) == 0,
+            "page size must be a power of two");
+
+    /** Returns the page allocation granularity in bytes. */
+    [[nodiscard]] static constexpr size_t page_size() noexcept
+    {
+        return PageSize;
+    }
+
+    /** Rounds `offset` down to the nearest page boundary. */
+    [[nodiscard]] static constexpr size_t
+    make_offset_page_aligned(const size_t offset) noexcept
+    {
+        return offset & ~(PageSize - 1);
+    }
+
+    /** Rounds `length` up to the nearest page boundary. */
+    [[nodiscard]] static constexpr size_t
+    make_length_page_aligned(const size_t length) noexcept
+    {
+        return (length + PageSize - 1) & ~(PageSize - 1);
+    }
 };
 
+/// Page arithmetic for the 4KB granularity of typical Linux systems.
+using page_traits_4k = basic_page_traits<4096>;
+
+/// Page arithmetic for the 64KB allocation granularity of Windows.
+using page_traits_64k = basic_page_traits<size_t(1) << 16>;
+
 /**
  * Returns the operating system's page allocation granularity in bytes.
  *
@@ -146,10 +501,20 @@ enum class access_mode
  * not the page size. This function returns the correct value for mapping.
  *
  * Performance: The value is queried once on first call and cached in a static
- * variable, so subsequent calls have no syscall overhead.
+ * variable, so subsequent calls have no syscall overhead. Defining
+ * MIO_FIXED_PAGE_SIZE replaces the cached lookup with that constant, which
+ * also removes the thread-safe-initialization guard check from every call;
+ * the deployment is then responsible for verifying the value once via
+ * assume_page_size().
  *
  * @return The system's page allocation granularity in bytes.
  */
+#ifdef MIO_FIXED_PAGE_SIZE
+[[nodiscard]] constexpr size_t page_size() noexcept
+{
+    return basic_page_traits<MIO_FIXED_PAGE_SIZE>::page_size();
+}
+#else
 [[nodiscard]] inline size_t page_size()
 {
     // Use a lambda for static initialization - thread-safe in C++11 and later.
@@ -170,6 +535,83 @@ enum class access_mode
     }();
     return page_size;
 }
+#endif // MIO_FIXED_PAGE_SIZE
+
+/**
+ * Verifies a compile-time page-size assumption against the running system.
+ *
+ * The escape hatch for basic_page_traits and MIO_FIXED_PAGE_SIZE: call it
+ * once at startup and refuse to run (or fall back to a build without the
+ * fixed size) when it returns false, instead of discovering a mismatched
+ * granularity through failing map() calls later.
+ *
+ * @tparam PageSize The assumed page allocation granularity in bytes.
+ * @return Whether the system's actual granularity matches `PageSize`.
+ */
+template<size_t PageSize>
+[[nodiscard]] inline bool assume_page_size() noexcept
+{
+    // Query the OS directly: with MIO_FIXED_PAGE_SIZE defined, page_size()
+    // reports the assumption itself and could not detect a mismatch.
+#ifdef _WIN32
+    SYSTEM_INFO SystemInfo;
+    GetSystemInfo(&SystemInfo);
+    const size_t actual = SystemInfo.dwAllocationGranularity;
+#else
+    const size_t actual = static_cast<size_t>(sysconf(_SC_PAGE_SIZE));
+#endif
+    return basic_page_traits<PageSize>::page_size() == actual;
+}
+
+/**
+ * Returns the operating system's default large ("huge") page size in bytes.
+ *
+ * Large pages reduce TLB pressure and page-fault counts for big mappings,
+ * but must be explicitly requested when creating a mapping (MAP_HUGETLB on
+ * Linux, SEC_LARGE_PAGES on Windows). This function reports the size the
+ * system would use for such a mapping so callers can check alignment and
+ * size requirements up front.
+ *
+ * Implementation details:
+ * - On Windows: GetLargePageMinimum() (typically 2MB; 0 if unsupported)
+ * - On Linux: Hugepagesize from /proc/meminfo (typically 2MB)
+ * - Elsewhere: 0 (huge pages not supported through this library)
+ *
+ * Performance: Queried once on first call and cached, like page_size().
+ *
+ * @return The default large page size in bytes, or 0 if unavailable.
+ */
+[[nodiscard]] inline size_t large_page_size()
+{
+    static const size_t large_page_size = []() -> size_t
+    {
+#ifdef _WIN32
+        return GetLargePageMinimum();
+#elif defined(__linux__)
+        // The default huge page size is exposed as "Hugepagesize: N kB"
+        // in /proc/meminfo. Parse it once; failures report 0.
+        size_t size = 0;
+        if(std::FILE* meminfo = std::fopen("/proc/meminfo", "r"))
+        {
+            char line[256];
+            while(std::fgets(line, sizeof(line), meminfo))
+            {
+                unsigned long long kb = 0;
+                if(std::sscanf(line, "Hugepagesize: %llu kB", &kb) == 1)
+                {
+                    size = static_cast<size_t>(kb) * 1024;
+                    break;
+                }
+            }
+            std::fclose(meminfo);
+        }
+        return size;
+#else
+        return 0;
+#endif
+    }();
+    return large_page_size;
+}
 
 /**
  * Rounds down an offset to the nearest page-aligned boundary.
@@ -198,11 +640,10 @@ enum class access_mode
  */
 [[nodiscard]] inline size_t make_offset_page_aligned(size_t offset) noexcept
 {
-    const size_t page_size_ = page_size();
-    // Integer division truncates toward zero, effectively rounding down.
-    // Then multiply back to get the aligned value.
-    // Example: offset=5000, page_size=4096 -> 5000/4096=1 -> 1*4096=4096
-    return offset / page_size_ * page_size_;
+    // Page sizes are powers of two on every supported system, so rounding
+    // down is a mask: clearing the low bits of the offset.
+    // Example: offset=5000, page_size=4096 -> 5000 & ~4095 -> 4096
+    return offset & ~(page_size() - 1);
 }
 
 } // namespace mio
@@ -216,6 +657,7 @@ enum class access_mode
 #include <cstdint>
 #include <cstddef>
 #include <filesystem>
+#include <vector>
 
 #if __cplusplus >= 202002L
 #include <span>
@@ -250,6 +692,228 @@ namespace mio {
  */
 inline constexpr size_t map_entire_file = 0;
 
+/**
+ * Memory-access advice for a mapped region.
+ *
+ * These hints tell the kernel how the application intends to access the
+ * mapped pages so it can tune readahead and page-cache behavior. They map
+ * onto `madvise()` on POSIX and `PrefetchVirtualMemory`/`DiscardVirtualMemory`
+ * on Windows (where no direct equivalent exists, the hint is a no-op).
+ *
+ * Typical uses:
+ * - `sequential` before a linear scan: aggressive readahead keeps the scan
+ *   at device bandwidth.
+ * - `random` before index lookups: disables readahead so point accesses do
+ *   not pollute the page cache with unwanted neighboring pages.
+ * - `will_need` to asynchronously prefetch a range that is about to be used.
+ * - `dont_need` / `free` to release pages that will not be touched again.
+ *
+ * @see basic_mmap::advise()
+ */
+enum class advice
+{
+    normal,      ///< Reset to default kernel behavior (MADV_NORMAL).
+    sequential,  ///< Expect sequential access; enables aggressive readahead (MADV_SEQUENTIAL).
+    random,      ///< Expect random access; disables readahead (MADV_RANDOM).
+    will_need,   ///< Range will be accessed soon; prefetch it (MADV_WILLNEED).
+    dont_need,   ///< Range will not be accessed soon; pages may be reclaimed (MADV_DONTNEED).
+    free         ///< Contents are disposable; lazily reclaimable (MADV_FREE, falls back to MADV_DONTNEED).
+};
+
+/**
+ * Durability tier for sync() operations.
+ *
+ * Flushing a large dirty mapping with full durability can block for hundreds
+ * of milliseconds; most of the time only a small range actually needs to be
+ * durable, or the caller merely wants writeback scheduled in the background.
+ * The tiers let callers pick the cheapest semantics that are still correct
+ * for them (e.g. a write-ahead-log writer can issue async range flushes per
+ * transaction and a single full flush at group-commit time).
+ *
+ * Platform behavior:
+ * - `async`: schedule writeback of the range and return immediately
+ *   (msync MS_ASYNC / FlushViewOfFile without FlushFileBuffers).
+ * - `sync`: wait until the range's data has been written
+ *   (msync MS_SYNC / FlushViewOfFile + FlushFileBuffers).
+ * - `full`: `sync` plus a file-level flush (fsync) so file metadata
+ *   (size, allocation) is durable as well.
+ */
+enum class sync_mode
+{
+    async,  ///< Initiate writeback of the range without waiting.
+    sync,   ///< Block until the range's data is written.
+    full    ///< Block until data and file metadata are durable.
+};
+
+/**
+ * Page-size selection for a mapping.
+ *
+ * Large ("huge") pages reduce TLB misses and the number of page faults taken
+ * while warming up big mappings, at the cost of coarser-grained memory
+ * accounting. They are strictly opt-in.
+ *
+ * Platform behavior:
+ * - Linux: `MAP_HUGETLB` (with an explicit 2MB/1GB size where requested).
+ *   Explicit hugetlb mappings require hugetlbfs backing; when that is
+ *   unavailable (the common case for regular files), the mapping falls back
+ *   to normal pages with `MADV_HUGEPAGE` so transparent huge pages can
+ *   still be used.
+ * - Windows: `SEC_LARGE_PAGES` in CreateFileMapping (requires the
+ *   SeLockMemoryPrivilege); falls back to normal pages on failure.
+ *
+ * Use basic_mmap::page_granularity() to find out what a mapping actually got.
+ */
+enum class page_mode
+{
+    normal,    ///< Default system page size.
+    huge,      ///< System default huge page size (see mio::large_page_size()).
+    huge_2mb,  ///< Explicit 2MB huge pages.
+    huge_1gb   ///< Explicit 1GB huge pages.
+};
+
+/**
+ * Memory-placement policy for a mapping on NUMA systems.
+ *
+ * A mapping faulted in by one thread lands entirely on that thread's node
+ * under the kernel's default first-touch policy; readers on the other
+ * socket then pay cross-node memory latency on every access. These
+ * policies control placement per mapping instead:
+ * - `bind` places all pages on one node, for mappings consumed by threads
+ *   pinned to that node.
+ * - `interleave` spreads pages round-robin across the nodes with memory,
+ *   evening out latency and bandwidth for mappings shared by all sockets.
+ *
+ * Platform behavior:
+ * - Linux: mbind() on the mapped range (with page migration, so it also
+ *   applies to pages prefaulted by the populate option).
+ * - Elsewhere: requesting a policy fails with function_not_supported.
+ */
+enum class numa_policy
+{
+    none,       ///< Kernel default (first-touch) placement.
+    bind,       ///< Place all pages on map_options::numa_node.
+    interleave  ///< Spread pages round-robin across all memory nodes.
+};
+
+/**
+ * Optional parameters controlling how a mapping is established.
+ *
+ * Passed to the map() overloads that take options. A default-constructed
+ * map_options reproduces the behavior of the overloads without one exactly,
+ * so existing callers are unaffected.
+ */
+struct map_options
+{
+    /// Page-size selection for the mapping (huge pages are opt-in).
+    page_mode pages = page_mode::normal;
+
+    /**
+     * Create the backing file if it does not exist and extend it so the
+     * requested range [offset, offset + length) exists (via ftruncate /
+     * SetEndOfFile). Existing file contents are never truncated away; the
+     * file is only ever grown.
+     *
+     * Only meaningful for write mappings opened by path, and requires an
+     * explicit length (a freshly created file is empty, so mapping
+     * `map_entire_file` of it would yield an empty mapping). Read mappings
+     * with this flag set fail with invalid_argument.
+     */
+    bool create = false;
+
+    /**
+     * Fault the whole mapping in at map() time instead of on first touch.
+     *
+     * Demand paging spreads the cost of reading a cold file across every
+     * first access, one page fault at a time; prefaulting moves that cost
+     * to map(), where it runs at full device bandwidth. map() blocks until
+     * the mapping is resident. For asynchronous warming of a subrange,
+     * use advise(advice::will_need) instead.
+     *
+     * Implemented with MAP_POPULATE on Linux and a page-touching pass
+     * elsewhere (after PrefetchVirtualMemory on Windows, which initiates
+     * the reads in bulk).
+     */
+    bool populate = false;
+
+    /**
+     * Map with synchronous page faults for persistent memory (Linux).
+     *
+     * On a DAX filesystem (pmem or CXL-backed), requests
+     * MAP_SHARED_VALIDATE | MAP_SYNC so that stores go straight to the
+     * device and user-space cacheline flushes alone make them durable -
+     * sync() then flushes and fences instead of calling msync(). On
+     * non-DAX mounts (where the kernel rejects MAP_SYNC) and on other
+     * platforms the request falls back cleanly to a regular mapping with
+     * the syscall-based sync() path; is_pmem() reports which one was
+     * established.
+     *
+     * Only meaningful for write mappings; ignored otherwise.
+     */
+    bool pmem = false;
+
+    /**
+     * File-level access-pattern hint applied when the file is opened.
+     *
+     * advise() covers hints on the established mapping, but some hints can
+     * only take effect at open time: the Windows cache manager's
+     * FILE_FLAG_SEQUENTIAL_SCAN / FILE_FLAG_RANDOM_ACCESS are CreateFile
+     * flags, and posix_fadvise() readahead hints shape how the very first
+     * faults of the mapping are read. Only meaningful for mappings opened
+     * by path; sequential and random are honored on Windows, the full set
+     * maps to posix_fadvise() elsewhere. Purely advisory - failures are
+     * ignored.
+     */
+    advice access_pattern = advice::normal;
+
+    /**
+     * NUMA placement policy for the mapping's pages (Linux).
+     *
+     * Applied with mbind() right after the mapping is established, so
+     * pages are placed per the policy as they are faulted in. See
+     * mio::numa_policy for the available policies.
+     */
+    numa_policy numa = numa_policy::none;
+
+    /**
+     * Target node for numa_policy::bind; ignored for the other policies.
+     * Must name an online node with memory.
+     */
+    int numa_node = -1;
+};
+
+/**
+ * Result of a basic_mmap::residency() query.
+ *
+ * Describes which pages of the queried range were in physical memory at the
+ * time of the call. The bitmap is a snapshot: the kernel may fault pages in
+ * or reclaim them at any moment, so treat the result as a hint for policies
+ * (what to prefetch, what to pin), not as a guarantee.
+ */
+struct page_residency
+{
+    /// One entry per page of the queried range; true if the page was resident.
+    std::vector<bool> pages;
+
+    /// Size in bytes of the pages described by the bitmap.
+    size_t page_size = 0;
+
+    /// Number of resident pages in the range.
+    size_t resident_pages = 0;
+
+    /**
+     * Number of contiguous runs of resident pages. Together with
+     * resident_pages this summarizes fragmentation: a warm mapping has few
+     * long runs, a randomly-accessed cold one has many short runs.
+     */
+    size_t resident_runs = 0;
+
+    /// Number of resident bytes (resident_pages scaled by the page size).
+    [[nodiscard]] size_t resident_bytes() const noexcept
+    {
+        return resident_pages * page_size;
+    }
+};
+
 // -----------------------------------------------------------------------------
 // Platform-specific types
 // -----------------------------------------------------------------------------
@@ -361,6 +1025,16 @@ private:
     // start of the mapping to a page boundary. Always >= length_.
     size_type mapped_length_ = 0;
 
+    // The page size backing this mapping. Equals mio::page_size() for normal
+    // mappings, or the huge page size when a huge-page request was honored.
+    // Zero when unmapped.
+    size_type page_granularity_ = 0;
+
+    // The byte offset into the file at which data() begins (the offset the
+    // user passed to map()). Needed to grow the file and re-derive file
+    // positions for resize() and other file-level operations.
+    size_type file_offset_ = 0;
+
     // The file handle used for the mapping. On Windows, this is the original
     // file handle (HANDLE); on POSIX, this is the file descriptor (int).
     handle_type file_handle_ = INVALID_HANDLE_VALUE;
@@ -377,6 +1051,11 @@ private:
     // False when map() was called with an existing handle (user owns it).
     bool is_handle_internal_ = false;
 
+    // Whether the mapping was established with MAP_SYNC on a DAX
+    // filesystem, making user-space cacheline flushes sufficient for
+    // durability (see map_options::pmem and sync()).
+    bool sync_map_ = false;
+
 public:
     // -------------------------------------------------------------------------
     // Constructors and destructor
@@ -521,9 +1200,15 @@ public:
      * An open mapping has accessible data via data(), begin(), end(), and
      * operator[]. Accessing data on a closed mapping is undefined behavior.
      *
+     * Anonymous mappings (see map_anonymous()) have no file handle but are
+     * still open while mapped.
+     *
      * @return true if the mapping is open and valid.
      */
-    [[nodiscard]] bool is_open() const noexcept { return file_handle_ != invalid_handle; }
+    [[nodiscard]] bool is_open() const noexcept
+    {
+        return file_handle_ != invalid_handle || data_ != nullptr;
+    }
 
     /**
      * Returns true if the mapping is empty (zero length).
@@ -604,7 +1289,42 @@ public:
         return mapped_length_ - length_;
     }
 
-    // -------------------------------------------------------------------------
+    /**
+     * Returns the effective page granularity of this mapping in bytes.
+     *
+     * For normal mappings this equals mio::page_size(). For mappings created
+     * with a huge-page option (see mio::page_mode) that the kernel honored,
+     * this is the huge page size actually in use (e.g. 2MB). If a huge-page
+     * request fell back to normal pages, this reports the normal page size.
+     *
+     * @return The page size backing the mapping, or 0 if not mapped.
+     */
+    [[nodiscard]] size_type page_granularity() const noexcept { return page_granularity_; }
+
+    /**
+     * Returns the byte offset into the file at which data() begins.
+     *
+     * This is the offset that was passed to map(), i.e. file position
+     * file_offset() + i corresponds to data()[i].
+     *
+     * @return The mapping's starting offset within the file.
+     */
+    [[nodiscard]] size_type file_offset() const noexcept { return file_offset_; }
+
+    /**
+     * Returns whether the mapping was established with synchronous page
+     * faults (MAP_SYNC) on a DAX filesystem.
+     *
+     * When true, sync() flushes CPU cachelines and fences instead of
+     * calling msync(), turning a commit into a handful of instructions.
+     * False when the map_options::pmem request fell back to a regular
+     * mapping, and always false on non-Linux platforms.
+     *
+     * @return Whether user-space flushes alone make stores durable.
+     */
+    [[nodiscard]] bool is_pmem() const noexcept { return sync_map_; }
+
+    // -------------------------------------------------------------------------
     // Data access
     // -------------------------------------------------------------------------
 
@@ -619,7 +1339,7 @@ public:
      * @return Pointer to mapped data, or nullptr if not mapped.
      */
     [[nodiscard]] pointer data() noexcept {
-        static_assert(AccessMode == access_mode::write, "non-const data() requires write access");
+        static_assert(AccessMode != access_mode::read, "non-const data() requires write or copy-on-write access");
         return data_;
     }
 
@@ -639,7 +1359,7 @@ public:
      * @return Iterator to the first byte.
      */
     [[nodiscard]] iterator begin() noexcept {
-        static_assert(AccessMode == access_mode::write, "non-const begin() requires write access");
+        static_assert(AccessMode != access_mode::read, "non-const begin() requires write or copy-on-write access");
         return data();
     }
     /** @copydoc begin() */
@@ -656,7 +1376,7 @@ public:
      * @return Iterator past the last byte.
      */
     [[nodiscard]] iterator end() noexcept {
-        static_assert(AccessMode == access_mode::write, "non-const end() requires write access");
+        static_assert(AccessMode != access_mode::read, "non-const end() requires write or copy-on-write access");
         return data() + length();
     }
     /** @copydoc end() */
@@ -673,7 +1393,7 @@ public:
      * @return Reverse iterator to the last byte.
      */
     [[nodiscard]] reverse_iterator rbegin() noexcept {
-        static_assert(AccessMode == access_mode::write, "non-const rbegin() requires write access");
+        static_assert(AccessMode != access_mode::read, "non-const rbegin() requires write or copy-on-write access");
         return reverse_iterator(end());
     }
     /** @copydoc rbegin() */
@@ -692,7 +1412,7 @@ public:
      * @return Reverse iterator before the first byte.
      */
     [[nodiscard]] reverse_iterator rend() noexcept {
-        static_assert(AccessMode == access_mode::write, "non-const rend() requires write access");
+        static_assert(AccessMode != access_mode::read, "non-const rend() requires write or copy-on-write access");
         return reverse_iterator(begin());
     }
     /** @copydoc rend() */
@@ -718,7 +1438,7 @@ public:
      * @return Reference to the byte at index i.
      */
     [[nodiscard]] reference operator[](const size_type i) noexcept {
-        static_assert(AccessMode == access_mode::write, "non-const operator[] requires write access");
+        static_assert(AccessMode != access_mode::read, "non-const operator[] requires write or copy-on-write access");
         return data_[i];
     }
     /** @copydoc operator[]() */
@@ -748,7 +1468,7 @@ public:
      *
      * @return A mutable span viewing the entire mapped region.
      */
-    template<access_mode A = AccessMode, std::enable_if_t<A == access_mode::write, int> = 0>
+    template<access_mode A = AccessMode, std::enable_if_t<A != access_mode::read, int> = 0>
     [[nodiscard]] std::span<value_type> as_span() noexcept {
         return {data(), length()};
     }
@@ -789,12 +1509,30 @@ public:
     void map(const std::filesystem::path& path, const size_type offset,
             const size_type length, std::error_code& error);
 
+    /**
+     * Establishes a memory mapping from a file path with explicit options.
+     *
+     * Identical to the overload without options, but allows requesting
+     * non-default mapping behavior such as huge pages (see mio::map_options).
+     *
+     * @param path    Path to an existing file. Empty paths cause an error.
+     * @param offset  Byte offset where mapping starts.
+     * @param length  Number of bytes to map, or `map_entire_file`.
+     * @param options Mapping options (page size selection, etc.).
+     * @param error   Output parameter for error reporting.
+     */
+    void map(const std::filesystem::path& path, const size_type offset,
+            const size_type length, const map_options& options,
+            std::error_code& error);
+
     /**
      * Overload for const char* paths with null-pointer checking.
      *
-     * Passing nullptr to std::filesystem::path constructor is undefined
-     * behavior. This overload provides safe handling by checking for null
-     * first and returning an error instead of UB.
+     * This is the allocation-free fast path on POSIX: the string goes
+     * straight to open() without constructing a std::filesystem::path
+     * (which heap-allocates). On Windows, narrow strings still pass
+     * through std::filesystem::path for correct Unicode re-encoding; use
+     * the const wchar_t* overload there to skip it.
      *
      * @param path   C-string path, or nullptr (which causes an error).
      * @param offset Byte offset where mapping starts.
@@ -803,13 +1541,70 @@ public:
      */
     void map(const char* path, const size_type offset,
             const size_type length, std::error_code& error)
+    {
+        map(path, offset, length, map_options{}, error);
+    }
+
+    /**
+     * Overload for const char* paths with explicit options.
+     *
+     * Provides the same null-pointer checking and allocation-free POSIX
+     * fast path as the overload without options.
+     *
+     * @param path    C-string path, or nullptr (which causes an error).
+     * @param offset  Byte offset where mapping starts.
+     * @param length  Number of bytes to map, or `map_entire_file`.
+     * @param options Mapping options (page size selection, file creation, etc.).
+     * @param error   Output parameter for error reporting.
+     */
+    void map(const char* path, const size_type offset, const size_type length,
+            const map_options& options, std::error_code& error)
+    {
+        if (!path) {
+            error = std::make_error_code(std::errc::invalid_argument);
+            return;
+        }
+        map_with_path(path, offset, length, options, error);
+    }
+
+#ifdef _WIN32
+    /**
+     * Overload for native wide paths (Windows only).
+     *
+     * The string goes straight to CreateFileW with no
+     * std::filesystem::path construction and no re-encoding, so mapping
+     * performs zero heap allocations. This is the preferred overload for
+     * high-rate mapping loops on Windows.
+     *
+     * @param path   Wide C-string path, or nullptr (which causes an error).
+     * @param offset Byte offset where mapping starts.
+     * @param length Number of bytes to map, or `map_entire_file`.
+     * @param error  Output parameter for error reporting.
+     */
+    void map(const wchar_t* path, const size_type offset,
+            const size_type length, std::error_code& error)
+    {
+        map(path, offset, length, map_options{}, error);
+    }
+
+    /** @copydoc map(const wchar_t*,size_type,size_type,std::error_code&) */
+    void map(const wchar_t* path, const size_type offset,
+            const size_type length, const map_options& options,
+            std::error_code& error)
     {
         if (!path) {
             error = std::make_error_code(std::errc::invalid_argument);
             return;
         }
-        map(std::filesystem::path(path), offset, length, error);
+        map_with_path(path, offset, length, options, error);
+    }
+
+    /** Maps the entire file from a native wide path (Windows only). */
+    void map(const wchar_t* path, std::error_code& error)
+    {
+        map(path, 0, map_entire_file, error);
     }
+#endif // _WIN32
 
     /**
      * Maps the entire file starting at offset 0.
@@ -834,11 +1629,7 @@ public:
      */
     void map(const char* path, std::error_code& error)
     {
-        if (!path) {
-            error = std::make_error_code(std::errc::invalid_argument);
-            return;
-        }
-        map(std::filesystem::path(path), 0, map_entire_file, error);
+        map(path, 0, map_entire_file, error);
     }
 
     /**
@@ -868,6 +1659,22 @@ public:
     void map(const handle_type handle, const size_type offset,
             const size_type length, std::error_code& error);
 
+    /**
+     * Establishes a memory mapping from an existing handle with explicit options.
+     *
+     * Identical to the overload without options, but allows requesting
+     * non-default mapping behavior such as huge pages (see mio::map_options).
+     *
+     * @param handle  Valid file handle.
+     * @param offset  Byte offset where mapping starts.
+     * @param length  Number of bytes to map, or `map_entire_file`.
+     * @param options Mapping options (page size selection, etc.).
+     * @param error   Output parameter for error reporting.
+     */
+    void map(const handle_type handle, const size_type offset,
+            const size_type length, const map_options& options,
+            std::error_code& error);
+
     /**
      * Maps the entire file from an existing handle.
      *
@@ -881,6 +1688,42 @@ public:
         map(handle, 0, map_entire_file, error);
     }
 
+    /**
+     * Establishes an anonymous (file-less) memory mapping.
+     *
+     * The mapping is backed by zero-initialized demand-paged memory
+     * (MAP_ANONYMOUS on POSIX, a pagefile-backed section on Windows) instead
+     * of a file. It reuses all of the RAII, iterator, advise() and huge-page
+     * machinery of file-backed mappings, which makes it a drop-in scratch
+     * buffer: unlike a std::vector it performs no heap allocation, can be
+     * given huge pages via map_options, and can return memory to the OS
+     * in-place with advise(advice::dont_need).
+     *
+     * sync() on an anonymous mapping is a no-op (there is no file to flush
+     * to), and file_handle() returns invalid_handle.
+     *
+     * @param length Number of bytes to map (must be > 0).
+     * @param error  Output parameter for error reporting.
+     */
+    void map_anonymous(const size_type length, std::error_code& error)
+    {
+        map_anonymous(length, map_options{}, error);
+    }
+
+    /**
+     * Establishes an anonymous memory mapping with explicit options.
+     *
+     * Identical to map_anonymous(length, error), but allows requesting
+     * non-default behavior such as huge pages (see mio::map_options).
+     * The create flag is meaningless for anonymous mappings and is ignored.
+     *
+     * @param length  Number of bytes to map (must be > 0).
+     * @param options Mapping options (page size selection, etc.).
+     * @param error   Output parameter for error reporting.
+     */
+    void map_anonymous(const size_type length, const map_options& options,
+            std::error_code& error);
+
     /**
      * Releases the memory mapping and associated resources.
      *
@@ -927,6 +1770,276 @@ public:
      */
     void sync(std::error_code& error);
 
+    /**
+     * Flushes a subrange of modified pages to the underlying file.
+     *
+     * Equivalent to sync(offset, length, sync_mode::sync, error): blocks
+     * until the range's data has been written. Offsets are relative to
+     * data(), like operator[]; the range is page-aligned internally.
+     *
+     * @param offset Byte offset into the mapping where the flush starts.
+     * @param length Number of bytes to flush, or `map_entire_file` for the
+     *               rest of the mapping from offset.
+     * @param error  Output parameter for error reporting.
+     */
+    void sync(const size_type offset, const size_type length, std::error_code& error)
+    {
+        sync(offset, length, sync_mode::sync, error);
+    }
+
+    /**
+     * Flushes a subrange of modified pages with an explicit durability tier.
+     *
+     * This is the most general flush operation; see mio::sync_mode for the
+     * semantics of each tier. Flushing only the dirty range instead of the
+     * whole mapping keeps flush latency proportional to the amount of dirty
+     * data rather than to the mapping size.
+     *
+     * Implementation:
+     * - Windows: FlushViewOfFile over the range; FlushFileBuffers for the
+     *   `sync` and `full` tiers
+     * - POSIX: msync() with MS_ASYNC or MS_SYNC; fsync() for `full`
+     *
+     * Only available for write access mode (compile-time check).
+     *
+     * @param offset Byte offset into the mapping where the flush starts.
+     * @param length Number of bytes to flush, or `map_entire_file` for the
+     *               rest of the mapping from offset.
+     * @param mode   Durability tier for the flush.
+     * @param error  Output parameter for error reporting.
+     */
+    void sync(const size_type offset, const size_type length,
+            const sync_mode mode, std::error_code& error);
+
+    /**
+     * Grows or shrinks the mapping in place, extending the file if needed.
+     *
+     * This avoids the unmap()/map() cycle that would otherwise be required
+     * to change a mapping's length, which tears down and refaults every
+     * resident page. When growing, the backing file is first extended (with
+     * zero fill) so the range file_offset() + new_length exists; the file
+     * itself is never shrunk.
+     *
+     * Implementation:
+     * - Linux: mremap(MREMAP_MAYMOVE) - resident pages are preserved, but
+     *   the mapping may move, so data() can change (raw pointers into the
+     *   region must be re-derived from data() after a resize)
+     * - Windows and other POSIX: a new view is created before the old one is
+     *   released, so failure leaves the mapping unchanged; resident pages
+     *   stay in the page cache but are refaulted on next access
+     *
+     * Only available for write access mode (compile-time check).
+     *
+     * @param new_length The desired mapping length in bytes (must be > 0).
+     * @param error      Output parameter for error reporting.
+     */
+    void resize(const size_type new_length, std::error_code& error);
+
+    /**
+     * Releases a retired range: the bytes read back as zero, the backing
+     * file's blocks are deallocated, and the resident pages are dropped.
+     *
+     * For ring-buffer-over-file designs that retire old regions
+     * continuously, this caps the file's on-disk footprint and the
+     * mapping's resident set at the live window, without remapping. The
+     * file's logical size is unchanged (the hole is transparent to
+     * readers), and the mapping stays valid: accessing a discarded range
+     * is permitted and faults in zero pages.
+     *
+     * Implementation:
+     * - Linux: fallocate(FALLOC_FL_PUNCH_HOLE) on the byte range (the
+     *   filesystem zeroes partial blocks), then madvise(MADV_DONTNEED)
+     *   over the fully-covered pages to drop them from memory. Anonymous
+     *   mappings zero the partial edge pages and MADV_DONTNEED the rest.
+     * - Windows: the file is marked sparse and the range zeroed with
+     *   FSCTL_SET_ZERO_DATA; the memory manager reclaims the clean pages.
+     * - Other POSIX: fails with function_not_supported (no portable
+     *   hole-punching primitive).
+     *
+     * Only available for write access mode (compile-time check).
+     *
+     * @param offset Byte offset into the mapping where the discard starts.
+     * @param length Number of bytes to discard, or `map_entire_file` for
+     *               the rest of the mapping from offset.
+     * @param error  Output parameter for error reporting.
+     */
+    void discard(const size_type offset, const size_type length,
+            std::error_code& error);
+
+    /**
+     * Pins a subrange of the mapping into physical memory.
+     *
+     * Locked pages are faulted in immediately and are exempt from reclaim,
+     * so subsequent accesses never take a major fault. Pinning just the hot
+     * ranges of a large mapping keeps the memory budget bounded while still
+     * guaranteeing residency where tail latency matters.
+     *
+     * Offsets are relative to data(); the range is page-aligned internally.
+     * Locks are per-range, not reference counted: unlocking a range releases
+     * it regardless of how many times it was locked.
+     *
+     * Implementation:
+     * - POSIX: mlock() (subject to RLIMIT_MEMLOCK)
+     * - Windows: VirtualLock() (subject to the process working-set quota;
+     *   see SetProcessWorkingSetSize to raise it)
+     *
+     * @param offset Byte offset into the mapping where the lock starts.
+     * @param length Number of bytes to lock, or `map_entire_file` for the
+     *               rest of the mapping from offset.
+     * @param error  Output parameter for error reporting.
+     */
+    void lock(const size_type offset, const size_type length, std::error_code& error);
+
+    /**
+     * Pins the entire mapping into physical memory.
+     *
+     * Convenience overload equivalent to lock(0, map_entire_file, error).
+     *
+     * @param error Output parameter for error reporting.
+     */
+    void lock(std::error_code& error) { lock(0, map_entire_file, error); }
+
+    /**
+     * Releases a previously pinned subrange of the mapping.
+     *
+     * The pages become reclaimable again; their contents are unaffected.
+     * Unlocking a range that was never locked is harmless.
+     *
+     * Implementation:
+     * - POSIX: munlock()
+     * - Windows: VirtualUnlock()
+     *
+     * @param offset Byte offset into the mapping where the unlock starts.
+     * @param length Number of bytes to unlock, or `map_entire_file` for the
+     *               rest of the mapping from offset.
+     * @param error  Output parameter for error reporting.
+     */
+    void unlock(const size_type offset, const size_type length, std::error_code& error);
+
+    /**
+     * Releases all pinned pages of the mapping.
+     *
+     * Convenience overload equivalent to unlock(0, map_entire_file, error).
+     *
+     * @param error Output parameter for error reporting.
+     */
+    void unlock(std::error_code& error) { unlock(0, map_entire_file, error); }
+
+    /**
+     * Advises the kernel about the expected access pattern for a subrange.
+     *
+     * Offsets are relative to data() (the user's requested offset), just like
+     * operator[]. The range is page-aligned internally against the actual
+     * mapping start, so callers never need to reason about mapping_offset()
+     * or page boundaries themselves.
+     *
+     * Implementation:
+     * - POSIX: madvise() with the corresponding MADV_* flag
+     * - Windows: PrefetchVirtualMemory for `will_need`, DiscardVirtualMemory
+     *   for `dont_need`/`free`; pattern hints (sequential/random) are no-ops
+     *
+     * Note: This is a hint; the kernel is free to ignore it. `dont_need` on a
+     * shared file mapping does not lose data (pages are re-read from the file
+     * on next access).
+     *
+     * @param adv    The access pattern hint to apply.
+     * @param offset Byte offset into the mapping where the hint starts.
+     * @param length Number of bytes the hint covers, or `map_entire_file`
+     *               for the rest of the mapping from offset.
+     * @param error  Output parameter for error reporting.
+     */
+    void advise(const advice adv, const size_type offset,
+            const size_type length, std::error_code& error);
+
+    /**
+     * Advises the kernel about the access pattern for the entire mapping.
+     *
+     * Convenience overload equivalent to advise(adv, 0, map_entire_file, error).
+     *
+     * @param adv   The access pattern hint to apply.
+     * @param error Output parameter for error reporting.
+     */
+    void advise(const advice adv, std::error_code& error)
+    {
+        advise(adv, 0, map_entire_file, error);
+    }
+
+    /**
+     * Reports which pages of a subrange are resident in physical memory.
+     *
+     * Accessing a resident page is a memory read; accessing a non-resident
+     * one takes a page fault and potentially a disk read. Querying residency
+     * lets callers warm exactly the missing ranges (advise(advice::will_need)
+     * or lock()) instead of prefetching blindly, and lets capacity planning
+     * measure how much of a mapping is actually held in RAM.
+     *
+     * Offsets are relative to data(); the range is page-aligned internally,
+     * so the first bitmap entry covers the page containing `offset`.
+     *
+     * Implementation:
+     * - POSIX: mincore()
+     * - Windows: QueryWorkingSetEx() (reports working-set membership, the
+     *   closest Windows equivalent of residency)
+     *
+     * @param offset Byte offset into the mapping where the query starts.
+     * @param length Number of bytes to query, or `map_entire_file` for the
+     *               rest of the mapping from offset.
+     * @param error  Output parameter for error reporting.
+     * @return Per-page bitmap and summary statistics; empty on error.
+     */
+    [[nodiscard]] page_residency residency(const size_type offset,
+            const size_type length, std::error_code& error) const;
+
+    /**
+     * Reports residency of the entire mapping.
+     *
+     * Convenience overload equivalent to residency(0, map_entire_file, error).
+     *
+     * @param error Output parameter for error reporting.
+     * @return Per-page bitmap and summary statistics; empty on error.
+     */
+    [[nodiscard]] page_residency residency(std::error_code& error) const
+    {
+        return residency(0, map_entire_file, error);
+    }
+
+    /**
+     * Reports the NUMA node each page of a subrange currently resides on.
+     *
+     * Complements residency(): once a page is known to be in RAM, this
+     * tells you which socket's memory holds it, so shard-to-core
+     * assignments can be checked against actual placement.
+     *
+     * Offsets are relative to data(); the range is page-aligned internally.
+     *
+     * Implementation:
+     * - Linux: move_pages() in query mode
+     * - Elsewhere: fails with function_not_supported
+     *
+     * @param offset Byte offset into the mapping where the query starts.
+     * @param length Number of bytes to query, or `map_entire_file` for the
+     *               rest of the mapping from offset.
+     * @param error  Output parameter for error reporting.
+     * @return One entry per page: the node id, or a negative errno-style
+     *         value for pages that are not resident. Empty on error.
+     */
+    [[nodiscard]] std::vector<int> numa_nodes(const size_type offset,
+            const size_type length, std::error_code& error) const;
+
+    /**
+     * Reports NUMA placement of the entire mapping.
+     *
+     * Convenience overload equivalent to
+     * numa_nodes(0, map_entire_file, error).
+     *
+     * @param error Output parameter for error reporting.
+     * @return One node entry per page; empty on error.
+     */
+    [[nodiscard]] std::vector<int> numa_nodes(std::error_code& error) const
+    {
+        return numa_nodes(0, map_entire_file, error);
+    }
+
 private:
     // -------------------------------------------------------------------------
     // Private helpers
@@ -952,6 +2065,18 @@ private:
         return !data_ ? nullptr : data_ - mapping_offset();
     }
 
+    /**
+     * Shared body of the path-based map() overloads.
+     *
+     * Templated on the path representation so const char* (POSIX) and
+     * const wchar_t* (Windows) callers resolve to the native open_file()
+     * overloads and never construct a std::filesystem::path.
+     */
+    template<typename Path>
+    void map_with_path(const Path& path, const size_type offset,
+            const size_type length, const map_options& options,
+            std::error_code& error);
+
     /**
      * Conditionally syncs the mapping based on access mode.
      *
@@ -998,42 +2123,243 @@ template<access_mode AccessMode, typename ByteT>
         const basic_mmap<AccessMode, ByteT>& b);
 
 // -----------------------------------------------------------------------------
-// Type aliases for common use cases
+// Non-temporal bulk transfer
 // -----------------------------------------------------------------------------
 
 /**
- * Read-only memory mapping template.
+ * Copies `count` bytes from `src` into the mapping at `offset`, bypassing
+ * the CPU cache for large ranges.
  *
- * Use this for mappings where you only need to read data. Attempting to
- * modify the mapped data will cause a segmentation fault.
+ * Bulk-writing a large mapping with std::copy or memcpy pulls every
+ * destination line into cache first (read-for-ownership) and evicts the
+ * working set with data that will not be re-read. On x86 this uses
+ * streaming stores for ranges of a few hundred KiB and up; small ranges
+ * and other targets degrade to memcpy. See detail/nontemporal.hpp.
  *
- * @tparam ByteT The byte type (char, unsigned char, std::byte).
+ * The source must not overlap the mapping.
+ *
+ * @param map    A writable mapping.
+ * @param offset Byte offset into the mapping where writing starts.
+ * @param src    Source buffer of at least `count` bytes.
+ * @param count  Number of bytes to copy.
+ * @param error  Output parameter for error reporting.
  */
-template<typename ByteT>
-using basic_mmap_source = basic_mmap<access_mode::read, ByteT>;
+template<access_mode AccessMode, typename ByteT>
+void copy_to(basic_mmap<AccessMode, ByteT>& map, const size_t offset,
+        const ByteT* const src, const size_t count, std::error_code& error)
+{
+    static_assert(AccessMode != access_mode::read,
+            "copy_to requires write or copy-on-write access");
+    error.clear();
+
+    if(!map.is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return;
+    }
+
+    // Validate that the range lies within the mapping
+    if(offset > map.size() || count > map.size() - offset)
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
+
+    detail::nontemporal_copy(map.data() + offset, src, count);
+}
 
 /**
- * Read-write memory mapping template.
+ * Fills `length` bytes of the mapping at `offset` with `value`, bypassing
+ * the CPU cache for large ranges.
  *
- * Use this for mappings where you need to modify the file contents.
- * Changes are visible immediately in memory and are synced to disk
- * on unmap (or explicit sync()).
+ * The streaming-store counterpart of std::fill / memset; see copy_to()
+ * for when the cache bypass engages.
  *
- * @tparam ByteT The byte type (char, unsigned char, std::byte).
+ * @param map    A writable mapping.
+ * @param offset Byte offset into the mapping where filling starts.
+ * @param length Number of bytes to fill, or `map_entire_file` for the
+ *               rest of the mapping from offset.
+ * @param value  Byte value to fill with.
+ * @param error  Output parameter for error reporting.
  */
-template<typename ByteT>
-using basic_mmap_sink = basic_mmap<access_mode::write, ByteT>;
-
-// Convenient type aliases for the most common byte types:
+template<access_mode AccessMode, typename ByteT>
+void fill(basic_mmap<AccessMode, ByteT>& map, const size_t offset,
+        const size_t length, const ByteT value, std::error_code& error)
+{
+    static_assert(AccessMode != access_mode::read,
+            "fill requires write or copy-on-write access");
+    error.clear();
 
-/// Read-only mapping with char bytes (most common)
-using mmap_source = basic_mmap_source<char>;
+    if(!map.is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return;
+    }
 
-/// Read-only mapping with unsigned char bytes
-using ummap_source = basic_mmap_source<unsigned char>;
+    if(offset > map.size()
+       || (length != map_entire_file && length > map.size() - offset))
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
 
-/// Read-only mapping with std::byte bytes (C++17)
-using bmmap_source = basic_mmap_source<std::byte>;
+    const size_t fill_length =
+            length == map_entire_file ? map.size() - offset : length;
+    detail::nontemporal_fill(map.data() + offset,
+            static_cast<unsigned char>(value), fill_length);
+}
+
+/**
+ * Copies `count` bytes from the mapping at `offset` into `dst`, keeping
+ * the transfer out of the CPU cache for large ranges.
+ *
+ * The read counterpart of copy_to(): the destination buffer is written
+ * with streaming stores and the mapped source is prefetched with a
+ * non-temporal hint, so draining a multi-GB mapping into an I/O buffer
+ * does not flush the working set.
+ *
+ * The destination must not overlap the mapping.
+ *
+ * @param map    The mapping to read from (any access mode).
+ * @param offset Byte offset into the mapping where reading starts.
+ * @param dst    Destination buffer of at least `count` bytes.
+ * @param count  Number of bytes to copy.
+ * @param error  Output parameter for error reporting.
+ */
+template<access_mode AccessMode, typename ByteT>
+void copy_from(const basic_mmap<AccessMode, ByteT>& map, const size_t offset,
+        ByteT* const dst, const size_t count, std::error_code& error)
+{
+    error.clear();
+
+    if(!map.is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return;
+    }
+
+    if(offset > map.size() || count > map.size() - offset)
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
+
+    detail::nontemporal_copy(dst, map.data() + offset, count);
+}
+
+#if __cplusplus >= 202002L
+/**
+ * Span overload of copy_to(): copies `src.size()` bytes from `src` into
+ * the mapping at `offset`.
+ */
+template<access_mode AccessMode, typename ByteT>
+void copy_to(basic_mmap<AccessMode, ByteT>& map, const size_t offset,
+        const std::span<const ByteT> src, std::error_code& error)
+{
+    copy_to(map, offset, src.data(), src.size(), error);
+}
+
+/**
+ * Span overload of copy_from(): fills `dst` with `dst.size()` bytes read
+ * from the mapping at `offset`.
+ */
+template<access_mode AccessMode, typename ByteT>
+void copy_from(const basic_mmap<AccessMode, ByteT>& map, const size_t offset,
+        const std::span<ByteT> dst, std::error_code& error)
+{
+    copy_from(map, offset, dst.data(), dst.size(), error);
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// Zero-copy range cloning
+// -----------------------------------------------------------------------------
+
+/**
+ * Copies `length` bytes from `source` at `src_offset` into `dest` at
+ * `dst_offset`, offloading the copy to the kernel where possible.
+ *
+ * When both mappings are file-backed and the platform supports it (Linux
+ * copy_file_range()), the transfer happens inside the kernel: on a
+ * filesystem with reflink support (Btrfs, XFS) the extents are shared
+ * rather than copied, and elsewhere the copy runs at page-cache speed
+ * without the data crossing into user space. Rewriting data between
+ * mapped segment files this way pays no read+write memory bandwidth
+ * through the mappings and leaves the CPU cache untouched.
+ *
+ * Anonymous mappings, copy-on-write mappings on either side (a COW
+ * source's private dirty pages never reach the file, so only the mapped
+ * copy sees the live view), cross-filesystem copies, and platforms
+ * without a kernel copy primitive fall back to a non-temporal copy
+ * through the mappings (see copy_to()).
+ *
+ * The ranges must not overlap. Shared file mappings are coherent with
+ * the page cache, so both mappings observe the new contents on return.
+ *
+ * @param source     The mapping to read from (any access mode).
+ * @param dest       A writable mapping.
+ * @param src_offset Byte offset into `source` where reading starts.
+ * @param dst_offset Byte offset into `dest` where writing starts.
+ * @param length     Number of bytes to copy, or `map_entire_file` for
+ *                   the rest of `source` from `src_offset`.
+ * @param error      Output parameter for error reporting.
+ */
+template<access_mode SrcAccessMode, access_mode DstAccessMode, typename ByteT>
+void clone_range(const basic_mmap<SrcAccessMode, ByteT>& source,
+        basic_mmap<DstAccessMode, ByteT>& dest, const size_t src_offset,
+        const size_t dst_offset, const size_t length, std::error_code& error);
+
+// -----------------------------------------------------------------------------
+// Type aliases for common use cases
+// -----------------------------------------------------------------------------
+
+/**
+ * Read-only memory mapping template.
+ *
+ * Use this for mappings where you only need to read data. Attempting to
+ * modify the mapped data will cause a segmentation fault.
+ *
+ * @tparam ByteT The byte type (char, unsigned char, std::byte).
+ */
+template<typename ByteT>
+using basic_mmap_source = basic_mmap<access_mode::read, ByteT>;
+
+/**
+ * Read-write memory mapping template.
+ *
+ * Use this for mappings where you need to modify the file contents.
+ * Changes are visible immediately in memory and are synced to disk
+ * on unmap (or explicit sync()).
+ *
+ * @tparam ByteT The byte type (char, unsigned char, std::byte).
+ */
+template<typename ByteT>
+using basic_mmap_sink = basic_mmap<access_mode::write, ByteT>;
+
+/**
+ * Copy-on-write memory mapping template.
+ *
+ * Use this to mutate a view of a file without ever modifying the file
+ * itself: the first write to a page lazily creates a private copy of just
+ * that page. Peak memory overhead is proportional to the pages actually
+ * touched, not to the file size. sync() is not available (there is nothing
+ * to write back).
+ *
+ * @tparam ByteT The byte type (char, unsigned char, std::byte).
+ */
+template<typename ByteT>
+using basic_cow_mmap = basic_mmap<access_mode::copy_on_write, ByteT>;
+
+// Convenient type aliases for the most common byte types:
+
+/// Read-only mapping with char bytes (most common)
+using mmap_source = basic_mmap_source<char>;
+
+/// Read-only mapping with unsigned char bytes
+using ummap_source = basic_mmap_source<unsigned char>;
+
+/// Read-only mapping with std::byte bytes (C++17)
+using bmmap_source = basic_mmap_source<std::byte>;
 
 /// Read-write mapping with char bytes (most common)
 using mmap_sink = basic_mmap_sink<char>;
@@ -1044,6 +2370,15 @@ using ummap_sink = basic_mmap_sink<unsigned char>;
 /// Read-write mapping with std::byte bytes (C++17)
 using bmmap_sink = basic_mmap_sink<std::byte>;
 
+/// Copy-on-write mapping with char bytes (most common)
+using mmap_cow = basic_cow_mmap<char>;
+
+/// Copy-on-write mapping with unsigned char bytes
+using ummap_cow = basic_cow_mmap<unsigned char>;
+
+/// Copy-on-write mapping with std::byte bytes (C++17)
+using bmmap_cow = basic_cow_mmap<std::byte>;
+
 // -----------------------------------------------------------------------------
 // Factory functions
 // -----------------------------------------------------------------------------
@@ -1076,6 +2411,24 @@ template<
     return mmap;
 }
 
+/**
+ * Generic factory function for creating memory mappings with explicit options.
+ *
+ * Identical to make_mmap() without options, but forwards a mio::map_options
+ * (page size selection, file creation, etc.) to map().
+ */
+template<
+    typename MMap,
+    typename MappingToken
+> MMap make_mmap(const MappingToken& token,
+        typename MMap::size_type offset, typename MMap::size_type length,
+        const map_options& options, std::error_code& error)
+{
+    MMap mmap;
+    mmap.map(token, offset, length, options, error);
+    return mmap;
+}
+
 /**
  * Creates a read-only memory mapping.
  *
@@ -1109,6 +2462,18 @@ mmap_source make_mmap_source(const MappingToken& token, mmap_source::size_type o
     return make_mmap<mmap_source>(token, offset, length, error);
 }
 
+/**
+ * Creates a read-only memory mapping with explicit options.
+ *
+ * Overload forwarding a mio::map_options (e.g. huge pages) to map().
+ */
+template<typename MappingToken>
+mmap_source make_mmap_source(const MappingToken& token, mmap_source::size_type offset,
+        mmap_source::size_type length, const map_options& options, std::error_code& error)
+{
+    return make_mmap<mmap_source>(token, offset, length, options, error);
+}
+
 /**
  * Creates a read-only mapping of an entire file.
  *
@@ -1155,6 +2520,24 @@ mmap_sink make_mmap_sink(const MappingToken& token, mmap_sink::size_type offset,
     return make_mmap<mmap_sink>(token, offset, length, error);
 }
 
+/**
+ * Creates a read-write memory mapping with explicit options.
+ *
+ * With options.create set, this produces a ready writable mapping of a file
+ * that did not previously exist (or was shorter than the requested range)
+ * in a single call:
+ *
+ *   mio::map_options opts;
+ *   opts.create = true;
+ *   auto sink = mio::make_mmap_sink("out.bin", 0, segment_size, opts, ec);
+ */
+template<typename MappingToken>
+mmap_sink make_mmap_sink(const MappingToken& token, mmap_sink::size_type offset,
+        mmap_sink::size_type length, const map_options& options, std::error_code& error)
+{
+    return make_mmap<mmap_sink>(token, offset, length, options, error);
+}
+
 /**
  * Creates a read-write mapping of an entire file.
  *
@@ -1170,6 +2553,50 @@ mmap_sink make_mmap_sink(const MappingToken& token, std::error_code& error)
     return make_mmap_sink(token, 0, map_entire_file, error);
 }
 
+/**
+ * Creates a copy-on-write memory mapping.
+ *
+ * The mapped memory is writable, but all changes stay private to this
+ * process; the file is opened read-only and is never modified.
+ *
+ * @tparam MappingToken Type that can identify a file (path or handle).
+ *
+ * @param token  The file path or handle to map.
+ * @param offset Byte offset where mapping starts.
+ * @param length Number of bytes to map, or `map_entire_file`.
+ * @param error  Output parameter for error reporting.
+ *
+ * @return The created mmap_cow.
+ *
+ * Example:
+ *   std::error_code ec;
+ *   auto view = mio::make_mmap_cow("reference.bin", ec);
+ *   if (!ec) {
+ *       view[0] = 'X';  // Copies one page; reference.bin is untouched
+ *   }
+ */
+template<typename MappingToken>
+mmap_cow make_mmap_cow(const MappingToken& token, mmap_cow::size_type offset,
+        mmap_cow::size_type length, std::error_code& error)
+{
+    return make_mmap<mmap_cow>(token, offset, length, error);
+}
+
+/**
+ * Creates a copy-on-write mapping of an entire file.
+ *
+ * Convenience overload that maps from offset 0 to end of file.
+ *
+ * @param token The file path or handle to map.
+ * @param error Output parameter for error reporting.
+ * @return The created mmap_cow.
+ */
+template<typename MappingToken>
+mmap_cow make_mmap_cow(const MappingToken& token, std::error_code& error)
+{
+    return make_mmap_cow(token, 0, map_entire_file, error);
+}
+
 } // namespace mio
 
 // Include the implementation (template definitions)
@@ -1291,97 +2718,441 @@ namespace detail {
 
 #endif // MIO_STRING_UTIL_HEADER
 
+// #include "mio/stats.hpp"
+/* Copyright 2017 https://github.com/mandreyel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MIO_STATS_HEADER
+#define MIO_STATS_HEADER
 
-#include <algorithm>
-#include <filesystem>
+// -----------------------------------------------------------------------------
+// stats.hpp - Opt-in instrumentation of mapping operations
+// -----------------------------------------------------------------------------
+//
+// This header provides a process-wide counter of mio's operations - maps,
+// unmaps, syncs, bytes mapped, sync wall time, failures - for feeding an
+// observability stack. When a latency regression appears, the counters say
+// whether msync stalled or mapping slowed down without attaching a tracer
+// to production.
+//
+// The facility is compiled out by default. Define MIO_ENABLE_STATS to turn
+// it on; without it, the recording hooks in detail/mmap.ipp are empty
+// inline functions the optimizer deletes, so the disabled build pays
+// nothing - not even a branch. The stats API itself stays available in
+// both builds (reporting zeros when disabled) so monitoring code compiles
+// unconditionally.
+//
+// Usage:
+//   mio::stats::instance().set_callback([](const mio::stats_event& e) {
+//       metrics.count("mio.op", 1, {{"op", name(e.operation)},
+//                                   {"failed", e.failed}});
+//   });
+//   ...
+//   const auto snap = mio::stats::instance().snapshot();
+//   report(snap.sync_count, snap.sync_duration_ns);
+//
+// Counters cover operations that reach the OS; argument-validation
+// failures (closed mapping, bad range) are rejected before the hooks run.
+//
+// -----------------------------------------------------------------------------
 
-#ifndef _WIN32
-# include <unistd.h>
-# include <fcntl.h>
-# include <sys/mman.h>
-# include <sys/stat.h>
+#include <cstdint>
+
+#ifdef MIO_ENABLE_STATS
+# include <atomic>
+# include <chrono>
+# include <functional>
+# include <mutex>
+# include <system_error>
+# include <utility>
+#else
+# include <system_error>
 #endif
 
 namespace mio {
-namespace detail {
-
-// -----------------------------------------------------------------------------
-// Windows-specific helpers
-// -----------------------------------------------------------------------------
 
-#ifdef _WIN32
-namespace win {
+/** The kind of operation a stats_event describes. */
+enum class stats_operation
+{
+    map,    ///< A file-backed or anonymous mapping was created.
+    unmap,  ///< A mapping was released.
+    sync    ///< A mapping range was flushed.
+};
 
 /**
- * Extracts the upper 32 bits of a 64-bit integer.
- *
- * Windows APIs often split 64-bit values into separate high/low DWORD
- * parameters (e.g., SetFilePointer, MapViewOfFile). This helper extracts
- * the upper 32 bits for such APIs.
- *
- * @param n A 64-bit integer value.
- * @return The upper 32 bits as a DWORD.
+ * One recorded operation, as delivered to the registered callback.
  */
-inline DWORD int64_high(int64_t n) noexcept
+struct stats_event
 {
-    return static_cast<DWORD>(static_cast<uint64_t>(n) >> 32);
-}
+    stats_operation operation; ///< What happened.
+    uint64_t bytes;            ///< Bytes mapped (map events; 0 otherwise).
+    uint64_t duration_ns;      ///< Wall time (sync events; 0 otherwise).
+    bool failed;               ///< Whether the operation reported an error.
+};
 
 /**
- * Extracts the lower 32 bits of a 64-bit integer.
- *
- * @param n A 64-bit integer value.
- * @return The lower 32 bits as a DWORD.
+ * Aggregated view of all operations recorded so far.
  */
-inline DWORD int64_low(int64_t n) noexcept
+struct stats_snapshot
 {
-    return n & 0xffffffff;
-}
+    uint64_t map_count = 0;           ///< Successful map operations.
+    uint64_t unmap_count = 0;         ///< Unmap operations.
+    uint64_t sync_count = 0;          ///< Successful sync operations.
+    uint64_t failed_operations = 0;   ///< Operations that reported an error.
+    uint64_t bytes_mapped = 0;        ///< Cumulative bytes over successful maps.
+    uint64_t sync_duration_ns = 0;    ///< Cumulative wall time spent in sync.
+    uint64_t max_sync_duration_ns = 0;///< Slowest single sync observed.
+};
+
+#ifdef MIO_ENABLE_STATS
 
 /**
- * Opens a file for memory mapping on Windows.
- *
- * Uses CreateFileW to support Unicode paths via std::filesystem::path.
- * The file is opened with sharing enabled for both reads and writes,
- * allowing other processes to access the file while it's mapped.
+ * Process-wide operation counters with an optional per-event callback.
  *
- * @param path The file path (Unicode-aware via std::filesystem).
- * @param mode Whether to open for read-only or read-write access.
- * @return The file handle, or INVALID_HANDLE_VALUE on failure.
+ * Thread safety: recording and snapshotting use relaxed atomics (the
+ * counters are statistics, not synchronization); the callback is invoked
+ * under a mutex, so a slow callback serializes recording - keep it cheap
+ * and hand off to the metrics pipeline asynchronously.
  */
-inline file_handle_type open_file_helper(const std::filesystem::path& path, const access_mode mode)
+class stats
 {
-    return ::CreateFileW(
-            path.c_str(),  // Use wide string for Unicode support
-            mode == access_mode::read ? GENERIC_READ : GENERIC_READ | GENERIC_WRITE,
-            FILE_SHARE_READ | FILE_SHARE_WRITE,  // Allow others to read/write
-            0,                                    // Default security attributes
-            OPEN_EXISTING,                        // File must exist
-            FILE_ATTRIBUTE_NORMAL,                // No special flags
-            0);                                   // No template file
-}
+public:
+    using callback_type = std::function<void(const stats_event&)>;
 
-} // namespace win
-#endif // _WIN32
+    /** Returns the process-wide instance. */
+    static stats& instance()
+    {
+        static stats instance_;
+        return instance_;
+    }
 
-// -----------------------------------------------------------------------------
-// Cross-platform helpers
-// -----------------------------------------------------------------------------
+    /** Returns a consistent-enough copy of the counters. */
+    [[nodiscard]] stats_snapshot snapshot() const noexcept
+    {
+        stats_snapshot snap;
+        snap.map_count = map_count_.load(std::memory_order_relaxed);
+        snap.unmap_count = unmap_count_.load(std::memory_order_relaxed);
+        snap.sync_count = sync_count_.load(std::memory_order_relaxed);
+        snap.failed_operations =
+                failed_operations_.load(std::memory_order_relaxed);
+        snap.bytes_mapped = bytes_mapped_.load(std::memory_order_relaxed);
+        snap.sync_duration_ns =
+                sync_duration_ns_.load(std::memory_order_relaxed);
+        snap.max_sync_duration_ns =
+                max_sync_duration_ns_.load(std::memory_order_relaxed);
+        return snap;
+    }
 
-/**
- * Returns the last system error as a std::error_code.
- *
- * This should be called immediately after a failed system call to capture
- * the error before it's overwritten by subsequent calls.
- *
- * Implementation:
- * - Windows: GetLastError() with system_category
- * - POSIX: errno with system_category
- *
- * @return The last system error wrapped in std::error_code.
- */
-inline std::error_code last_error() noexcept
-{
+    /**
+     * Registers a callback invoked once per recorded event; pass an empty
+     * callback to unregister.
+     */
+    void set_callback(callback_type callback)
+    {
+        std::lock_guard<std::mutex> lock(callback_mutex_);
+        callback_ = std::move(callback);
+    }
+
+    /** Resets every counter to zero. The callback stays registered. */
+    void reset() noexcept
+    {
+        map_count_.store(0, std::memory_order_relaxed);
+        unmap_count_.store(0, std::memory_order_relaxed);
+        sync_count_.store(0, std::memory_order_relaxed);
+        failed_operations_.store(0, std::memory_order_relaxed);
+        bytes_mapped_.store(0, std::memory_order_relaxed);
+        sync_duration_ns_.store(0, std::memory_order_relaxed);
+        max_sync_duration_ns_.store(0, std::memory_order_relaxed);
+    }
+
+    /** Records one event. Called from the hooks in detail/mmap.ipp. */
+    void record(const stats_event& event)
+    {
+        if(event.failed)
+        {
+            failed_operations_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else switch(event.operation)
+        {
+        case stats_operation::map:
+            map_count_.fetch_add(1, std::memory_order_relaxed);
+            bytes_mapped_.fetch_add(event.bytes, std::memory_order_relaxed);
+            break;
+        case stats_operation::unmap:
+            unmap_count_.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case stats_operation::sync:
+            sync_count_.fetch_add(1, std::memory_order_relaxed);
+            sync_duration_ns_.fetch_add(event.duration_ns,
+                    std::memory_order_relaxed);
+            uint64_t seen =
+                    max_sync_duration_ns_.load(std::memory_order_relaxed);
+            while(event.duration_ns > seen
+                  && !max_sync_duration_ns_.compare_exchange_weak(seen,
+                        event.duration_ns, std::memory_order_relaxed))
+            {}
+            break;
+        }
+
+        std::lock_guard<std::mutex> lock(callback_mutex_);
+        if(callback_) { callback_(event); }
+    }
+
+private:
+    stats() = default;
+
+    std::atomic<uint64_t> map_count_{0};
+    std::atomic<uint64_t> unmap_count_{0};
+    std::atomic<uint64_t> sync_count_{0};
+    std::atomic<uint64_t> failed_operations_{0};
+    std::atomic<uint64_t> bytes_mapped_{0};
+    std::atomic<uint64_t> sync_duration_ns_{0};
+    std::atomic<uint64_t> max_sync_duration_ns_{0};
+
+    mutable std::mutex callback_mutex_;
+    callback_type callback_;
+};
+
+namespace detail {
+
+/** Records a map attempt that reached the OS. */
+inline void stats_on_map(const uint64_t bytes, const bool failed)
+{
+    stats::instance().record({stats_operation::map, bytes, 0, failed});
+}
+
+/** Records an unmap of `bytes` mapped bytes. */
+inline void stats_on_unmap(const uint64_t bytes)
+{
+    stats::instance().record({stats_operation::unmap, bytes, 0, false});
+}
+
+/**
+ * Times the enclosing sync operation and records it on scope exit,
+ * reading the operation's error code to classify success.
+ */
+class stats_sync_timer
+{
+    const std::error_code& error_;
+    std::chrono::steady_clock::time_point start_;
+
+public:
+    explicit stats_sync_timer(const std::error_code& error) noexcept
+        : error_(error), start_(std::chrono::steady_clock::now())
+    {}
+
+    ~stats_sync_timer()
+    {
+        const auto elapsed = std::chrono::duration_cast<
+                std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start_);
+        stats::instance().record({stats_operation::sync, 0,
+                static_cast<uint64_t>(elapsed.count()),
+                static_cast<bool>(error_)});
+    }
+
+    stats_sync_timer(const stats_sync_timer&) = delete;
+    stats_sync_timer& operator=(const stats_sync_timer&) = delete;
+};
+
+} // namespace detail
+
+#else // MIO_ENABLE_STATS not defined
+
+/**
+ * Disabled stand-in for the stats facility: same interface, no recording,
+ * so monitoring code compiles whether or not the build enables stats.
+ */
+class stats
+{
+public:
+    static stats& instance() noexcept
+    {
+        static stats instance_;
+        return instance_;
+    }
+
+    [[nodiscard]] stats_snapshot snapshot() const noexcept { return {}; }
+
+    template<typename Callback>
+    void set_callback(Callback&&) noexcept {}
+
+    void reset() noexcept {}
+
+private:
+    stats() = default;
+};
+
+namespace detail {
+
+// No-op hooks: with the calls inlined away, the disabled build carries no
+// trace of the facility.
+inline void stats_on_map(uint64_t, bool) noexcept {}
+inline void stats_on_unmap(uint64_t) noexcept {}
+
+struct stats_sync_timer
+{
+    explicit stats_sync_timer(const std::error_code&) noexcept {}
+};
+
+} // namespace detail
+
+#endif // MIO_ENABLE_STATS
+
+} // namespace mio
+
+#endif // MIO_STATS_HEADER
+
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+
+#ifdef _WIN32
+# include <psapi.h> // QueryWorkingSetEx, for residency()
+#else
+# include <unistd.h>
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# ifdef __linux__
+#  include <cstdio>
+#  include <cstdlib>
+#  include <sys/syscall.h> // mbind/move_pages, for NUMA placement
+# endif
+// Some BSD-derived systems spell MAP_ANONYMOUS as MAP_ANON.
+# if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#  define MAP_ANONYMOUS MAP_ANON
+# endif
+// MAP_SYNC (synchronous page faults on DAX filesystems) and the
+// MAP_SHARED_VALIDATE it requires are kernel ABI constants that older
+// libcs do not expose.
+# ifdef __linux__
+#  ifndef MAP_SHARED_VALIDATE
+#   define MAP_SHARED_VALIDATE 0x03
+#  endif
+#  ifndef MAP_SYNC
+#   define MAP_SYNC 0x80000
+#  endif
+// fallocate() mode flags for discard(); kernel ABI constants that only
+// newer libcs expose through <fcntl.h>.
+#  ifndef FALLOC_FL_KEEP_SIZE
+#   define FALLOC_FL_KEEP_SIZE 0x01
+#  endif
+#  ifndef FALLOC_FL_PUNCH_HOLE
+#   define FALLOC_FL_PUNCH_HOLE 0x02
+#  endif
+# endif
+#endif
+
+namespace mio {
+namespace detail {
+
+// -----------------------------------------------------------------------------
+// Windows-specific helpers
+// -----------------------------------------------------------------------------
+
+#ifdef _WIN32
+namespace win {
+
+/**
+ * Extracts the upper 32 bits of a 64-bit integer.
+ *
+ * Windows APIs often split 64-bit values into separate high/low DWORD
+ * parameters (e.g., SetFilePointer, MapViewOfFile). This helper extracts
+ * the upper 32 bits for such APIs.
+ *
+ * @param n A 64-bit integer value.
+ * @return The upper 32 bits as a DWORD.
+ */
+inline DWORD int64_high(int64_t n) noexcept
+{
+    return static_cast<DWORD>(static_cast<uint64_t>(n) >> 32);
+}
+
+/**
+ * Extracts the lower 32 bits of a 64-bit integer.
+ *
+ * @param n A 64-bit integer value.
+ * @return The lower 32 bits as a DWORD.
+ */
+inline DWORD int64_low(int64_t n) noexcept
+{
+    return n & 0xffffffff;
+}
+
+/**
+ * Opens a file for memory mapping on Windows.
+ *
+ * Uses CreateFileW so Unicode paths work; callers with narrow strings
+ * convert through std::filesystem::path first. The file is opened with
+ * sharing enabled for both reads and writes, allowing other processes to
+ * access the file while it's mapped.
+ *
+ * @param path   The file path as a native wide NUL-terminated string.
+ * @param mode   Whether to open for read-only or read-write access.
+ * @param create Whether to create the file if it does not exist.
+ * @param access Access-pattern hint for the cache manager; sequential and
+ *               random translate to the corresponding CreateFile flags,
+ *               which can only be set at open time.
+ * @return The file handle, or INVALID_HANDLE_VALUE on failure.
+ */
+inline file_handle_type open_file_helper(const wchar_t* path, const access_mode mode,
+        const bool create, const advice access)
+{
+    DWORD flags = FILE_ATTRIBUTE_NORMAL;
+    if(access == advice::sequential) { flags |= FILE_FLAG_SEQUENTIAL_SCAN; }
+    else if(access == advice::random) { flags |= FILE_FLAG_RANDOM_ACCESS; }
+
+    return ::CreateFileW(
+            path,          // Use wide string for Unicode support
+            mode == access_mode::write ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+            FILE_SHARE_READ | FILE_SHARE_WRITE,  // Allow others to read/write
+            0,                                    // Default security attributes
+            create ? OPEN_ALWAYS : OPEN_EXISTING, // Create if missing, or require existence
+            flags,                                // Cache-manager hints, if any
+            0);                                   // No template file
+}
+
+} // namespace win
+#endif // _WIN32
+
+// -----------------------------------------------------------------------------
+// Cross-platform helpers
+// -----------------------------------------------------------------------------
+
+/**
+ * Returns the last system error as a std::error_code.
+ *
+ * This should be called immediately after a failed system call to capture
+ * the error before it's overwritten by subsequent calls.
+ *
+ * Implementation:
+ * - Windows: GetLastError() with system_category
+ * - POSIX: errno with system_category
+ *
+ * @return The last system error wrapped in std::error_code.
+ */
+inline std::error_code last_error() noexcept
+{
     std::error_code error;
 #ifdef _WIN32
     error.assign(static_cast<int>(GetLastError()), std::system_category());
@@ -1391,19 +3162,102 @@ inline std::error_code last_error() noexcept
     return error;
 }
 
+/**
+ * Opens a file from a native NUL-terminated path, allocation-free.
+ *
+ * The std::filesystem::path overload below heap-allocates just to build
+ * the path object (and re-encodes the string on Windows); high-rate
+ * mapping loops resolve to these overloads instead. On POSIX the narrow
+ * string goes straight to open(). On Windows the wide string goes
+ * straight to CreateFileW, while narrow strings still convert through
+ * std::filesystem::path because the narrow system encoding must be
+ * re-encoded. Parameters as in the std::filesystem::path overload.
+ */
+inline file_handle_type open_file(const char* path, const access_mode mode,
+        const bool create, const advice access, std::error_code& error)
+{
+    error.clear();
+
+    // Check for null/empty path before attempting to open
+    if(path == nullptr || *path == '\0')
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return invalid_handle;
+    }
+
+#ifdef _WIN32
+    const auto handle = win::open_file_helper(
+            std::filesystem::path(path).c_str(), mode, create, access);
+#else // POSIX
+    // O_RDWR for write mode, O_RDONLY otherwise; copy-on-write mappings only
+    // ever read from the file, so they open it read-only like read mode.
+    const auto handle = ::open(path,
+            mode == access_mode::write ? (O_RDWR | (create ? O_CREAT : 0)) : O_RDONLY,
+            0644);
+
+# ifdef POSIX_FADV_NORMAL
+    // Shape file-level readahead before the first page of the mapping is
+    // ever faulted; advisory, so a failing or unsupported fadvise (e.g. on
+    // a pipe or some network filesystems) is ignored.
+    if(handle != invalid_handle && access != advice::normal)
+    {
+        const int hint = access == advice::sequential ? POSIX_FADV_SEQUENTIAL
+                : access == advice::random ? POSIX_FADV_RANDOM
+                : access == advice::will_need ? POSIX_FADV_WILLNEED
+                : access == advice::dont_need ? POSIX_FADV_DONTNEED
+                : POSIX_FADV_NOREUSE; // advice::free: drop from cache after use
+        ::posix_fadvise(handle, 0, 0, hint);
+    }
+# endif
+#endif
+
+    if(handle == invalid_handle)
+    {
+        error = detail::last_error();
+    }
+    return handle;
+}
+
+#ifdef _WIN32
+/** @copydoc open_file(const char*,access_mode,bool,advice,std::error_code&) */
+inline file_handle_type open_file(const wchar_t* path, const access_mode mode,
+        const bool create, const advice access, std::error_code& error)
+{
+    error.clear();
+
+    if(path == nullptr || *path == L'\0')
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return invalid_handle;
+    }
+
+    const auto handle = win::open_file_helper(path, mode, create, access);
+    if(handle == invalid_handle)
+    {
+        error = detail::last_error();
+    }
+    return handle;
+}
+#endif // _WIN32
+
 /**
  * Opens a file and returns its handle.
  *
  * Platform-independent file opening with appropriate access permissions.
  * The caller is responsible for closing the returned handle.
  *
- * @param path  Path to the file to open.
- * @param mode  Access mode (read or read-write).
- * @param error Output parameter for error reporting.
+ * @param path   Path to the file to open.
+ * @param mode   Access mode (read or read-write).
+ * @param create Whether to create the file if it does not exist
+ *               (write mode only).
+ * @param access Access-pattern hint applied at open time: CreateFile
+ *               cache-manager flags on Windows, posix_fadvise() on the fd
+ *               elsewhere. Advisory; failures to apply it are ignored.
+ * @param error  Output parameter for error reporting.
  * @return The file handle, or invalid_handle on failure.
  */
 inline file_handle_type open_file(const std::filesystem::path& path, const access_mode mode,
-        std::error_code& error)
+        const bool create, const advice access, std::error_code& error)
 {
     error.clear();
 
@@ -1415,18 +3269,76 @@ inline file_handle_type open_file(const std::filesystem::path& path, const acces
     }
 
 #ifdef _WIN32
-    const auto handle = win::open_file_helper(path, mode);
+    const auto handle = win::open_file_helper(path.c_str(), mode, create, access);
+    if(handle == invalid_handle)
+    {
+        error = detail::last_error();
+    }
+    return handle;
 #else // POSIX
-    // O_RDONLY for read mode, O_RDWR for write mode (mmap requires read access)
-    const auto handle = ::open(path.c_str(),
-            mode == access_mode::read ? O_RDONLY : O_RDWR);
+    // fs::path::c_str() is already the native narrow string; take the
+    // allocation-free native overload below.
+    return open_file(path.c_str(), mode, create, access, error);
 #endif
+}
 
-    if(handle == invalid_handle)
+/** @copydoc open_file(const std::filesystem::path&,access_mode,bool,advice,std::error_code&) */
+inline file_handle_type open_file(const std::filesystem::path& path, const access_mode mode,
+        const bool create, std::error_code& error)
+{
+    return open_file(path, mode, create, advice::normal, error);
+}
+
+/** @copydoc open_file(const std::filesystem::path&,access_mode,bool,advice,std::error_code&) */
+inline file_handle_type open_file(const std::filesystem::path& path, const access_mode mode,
+        std::error_code& error)
+{
+    return open_file(path, mode, false, error);
+}
+
+/**
+ * Closes a file handle, ignoring errors.
+ *
+ * Used on cleanup paths where an error has already been recorded.
+ */
+inline void close_file(file_handle_type handle) noexcept
+{
+#ifdef _WIN32
+    ::CloseHandle(handle);
+#else // POSIX
+    ::close(handle);
+#endif
+}
+
+/**
+ * Sets the size of a file, growing or shrinking it as needed.
+ *
+ * Newly added bytes read as zero. The mapping layer uses this to grow a
+ * file so a requested range exists before mapping it.
+ *
+ * @param handle   Valid file handle opened with write access.
+ * @param new_size The desired file size in bytes.
+ * @param error    Output parameter for error reporting.
+ */
+inline void resize_file(file_handle_type handle, const size_t new_size,
+        std::error_code& error)
+{
+    error.clear();
+
+#ifdef _WIN32
+    LARGE_INTEGER size;
+    size.QuadPart = static_cast<LONGLONG>(new_size);
+    if(::SetFilePointerEx(handle, size, 0, FILE_BEGIN) == 0
+       || ::SetEndOfFile(handle) == 0)
     {
         error = detail::last_error();
     }
-    return handle;
+#else // POSIX
+    if(::ftruncate(handle, static_cast<off_t>(new_size)) == -1)
+    {
+        error = detail::last_error();
+    }
+#endif
 }
 
 /**
@@ -1463,23 +3375,265 @@ inline size_t query_file_size(file_handle_type handle, std::error_code& error)
 }
 
 /**
- * Result structure for memory_map().
+ * Identity of a file on disk, independent of the path used to reach it.
  *
- * Contains all the information needed to populate a basic_mmap after
- * a successful mapping operation.
+ * Two handles refer to the same file exactly when their file_ids compare
+ * equal (device + inode on POSIX, volume serial + file index on Windows).
+ * Used by the mapping registry to deduplicate mappings of the same file
+ * opened through different paths (symlinks, hard links, relative paths).
  */
-struct mmap_context
+struct file_id
 {
-    char* data;              ///< Pointer to user's requested offset (not mapping start)
-    int64_t length;          ///< User-requested length
-    int64_t mapped_length;   ///< Actual mapped length (>= length due to alignment)
-#ifdef _WIN32
-    file_handle_type file_mapping_handle;  ///< Windows file mapping object handle
-#endif
+    uint64_t device = 0;  ///< Device / volume identifier.
+    uint64_t inode = 0;   ///< Inode / file index within the device.
+
+    friend bool operator==(const file_id& a, const file_id& b) noexcept
+    {
+        return a.device == b.device && a.inode == b.inode;
+    }
+    friend bool operator!=(const file_id& a, const file_id& b) noexcept
+    {
+        return !(a == b);
+    }
+};
+
+/** Hash functor for file_id, for use with unordered containers. */
+struct file_id_hash
+{
+    size_t operator()(const file_id& id) const noexcept
+    {
+        // Boost-style hash combine of the two halves.
+        const size_t h = std::hash<uint64_t>{}(id.device);
+        return h ^ (std::hash<uint64_t>{}(id.inode)
+                + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2));
+    }
 };
 
 /**
- * Creates a memory mapping of a file region.
+ * Queries the on-disk identity of an open file.
+ *
+ * @param handle Valid file handle.
+ * @param error  Output parameter for error reporting.
+ * @return The file's identity, or a default file_id on error.
+ */
+inline file_id query_file_id(file_handle_type handle, std::error_code& error)
+{
+    error.clear();
+    file_id id;
+
+#ifdef _WIN32
+    BY_HANDLE_FILE_INFORMATION info;
+    if(::GetFileInformationByHandle(handle, &info) == 0)
+    {
+        error = detail::last_error();
+        return id;
+    }
+    id.device = info.dwVolumeSerialNumber;
+    id.inode = (static_cast<uint64_t>(info.nFileIndexHigh) << 32)
+            | info.nFileIndexLow;
+#else // POSIX
+    struct stat sbuf;
+    if(::fstat(handle, &sbuf) == -1)
+    {
+        error = detail::last_error();
+        return id;
+    }
+    id.device = static_cast<uint64_t>(sbuf.st_dev);
+    id.inode = static_cast<uint64_t>(sbuf.st_ino);
+#endif
+    return id;
+}
+
+/**
+ * Queries the on-disk identity of the file at `path`.
+ *
+ * Opens the file read-only just long enough to query its identity; on
+ * POSIX this is a plain stat() without opening at all.
+ *
+ * @param path  Path of the file.
+ * @param error Output parameter for error reporting.
+ * @return The file's identity, or a default file_id on error.
+ */
+inline file_id query_file_id(const std::filesystem::path& path,
+        std::error_code& error)
+{
+    error.clear();
+    file_id id;
+
+#ifdef _WIN32
+    const auto handle = open_file(path, access_mode::read, error);
+    if(error) { return id; }
+    id = query_file_id(handle, error);
+    close_file(handle);
+#else // POSIX
+    if(path.empty())
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return id;
+    }
+    struct stat sbuf;
+    if(::stat(path.c_str(), &sbuf) == -1)
+    {
+        error = detail::last_error();
+        return id;
+    }
+    id.device = static_cast<uint64_t>(sbuf.st_dev);
+    id.inode = static_cast<uint64_t>(sbuf.st_ino);
+#endif
+    return id;
+}
+
+/**
+ * Result structure for memory_map().
+ *
+ * Contains all the information needed to populate a basic_mmap after
+ * a successful mapping operation.
+ */
+struct mmap_context
+{
+    char* data;              ///< Pointer to user's requested offset (not mapping start)
+    int64_t length;          ///< User-requested length
+    int64_t mapped_length;   ///< Actual mapped length (>= length due to alignment)
+    size_t page_granularity; ///< Page size backing the mapping (huge or normal)
+    bool sync_map = false;   ///< Whether MAP_SYNC was established (DAX/pmem)
+#ifdef _WIN32
+    file_handle_type file_mapping_handle;  ///< Windows file mapping object handle
+#endif
+};
+
+/**
+ * Returns the page size a page_mode request resolves to.
+ *
+ * For the explicit sizes this is a constant; for page_mode::huge it is the
+ * system default huge page size. Returns 0 when huge pages are unavailable.
+ */
+inline size_t requested_page_size(const page_mode pages)
+{
+    switch(pages)
+    {
+    case page_mode::huge_2mb: return size_t(1) << 21;
+    case page_mode::huge_1gb: return size_t(1) << 30;
+    case page_mode::huge:     return large_page_size();
+    default:                  return page_size();
+    }
+}
+
+/**
+ * Faults in every page of a mapped range by touching one byte per page.
+ *
+ * Used to implement map_options::populate on platforms without a
+ * MAP_POPULATE equivalent. The volatile access forces the compiler to
+ * emit the load, which makes the kernel fault the page in.
+ *
+ * @param address Start of the range (should be page-aligned).
+ * @param length  Number of bytes to touch.
+ */
+inline void prefault(const char* const address, const size_t length)
+{
+    const size_t step = page_size();
+    for(size_t i = 0; i < length; i += step)
+    {
+        [[maybe_unused]] volatile char byte = address[i];
+    }
+}
+
+#ifdef __linux__
+// The MPOL_* constants live in <numaif.h>, which ships with libnuma's
+// development headers rather than glibc. The values are kernel ABI, so
+// define the ones we use locally instead of adding a dependency.
+# ifndef MPOL_BIND
+#  define MPOL_BIND 2
+# endif
+# ifndef MPOL_INTERLEAVE
+#  define MPOL_INTERLEAVE 3
+# endif
+# ifndef MPOL_MF_MOVE
+#  define MPOL_MF_MOVE (1 << 1)
+# endif
+
+/**
+ * Returns a bitmask of the online NUMA nodes, for interleaved placement.
+ *
+ * Parsed once from /sys/devices/system/node/online (a range list such as
+ * "0" or "0-3,8"); falls back to node 0 when sysfs is unavailable.
+ */
+inline unsigned long numa_online_nodes_mask()
+{
+    static const unsigned long mask = []() -> unsigned long
+    {
+        unsigned long nodes = 0;
+        if(std::FILE* online = std::fopen("/sys/devices/system/node/online", "r"))
+        {
+            char line[256];
+            if(std::fgets(line, sizeof(line), online))
+            {
+                const char* p = line;
+                while(*p != '\0' && *p != '\n')
+                {
+                    char* end = nullptr;
+                    const long first = std::strtol(p, &end, 10);
+                    long last = first;
+                    if(*end == '-') { last = std::strtol(end + 1, &end, 10); }
+                    for(long node = first; node >= 0 && node <= last
+                            && node < long(8 * sizeof(unsigned long)); ++node)
+                    {
+                        nodes |= 1UL << node;
+                    }
+                    p = *end == ',' ? end + 1 : end;
+                    if(end == nullptr || *end == '\0' || *end == '\n') { break; }
+                }
+            }
+            std::fclose(online);
+        }
+        return nodes != 0 ? nodes : 1;
+    }();
+    return mask;
+}
+
+/**
+ * Applies the requested NUMA placement policy to a mapped range.
+ *
+ * Uses the mbind() syscall directly (raw syscall; no libnuma dependency).
+ * MPOL_MF_MOVE migrates any pages that were already faulted in - e.g. by
+ * MAP_POPULATE - so the policy holds regardless of option order.
+ *
+ * @param address Start of the mapped range (page-aligned).
+ * @param length  Length of the range in bytes.
+ * @param options Mapping options carrying the policy and target node.
+ * @param error   Output parameter for error reporting.
+ */
+inline void apply_numa_policy(void* const address, const size_t length,
+        const map_options& options, std::error_code& error)
+{
+    int policy_mode;
+    unsigned long nodemask;
+    if(options.numa == numa_policy::bind)
+    {
+        if(options.numa_node < 0
+           || options.numa_node >= int(8 * sizeof(unsigned long)))
+        {
+            error = std::make_error_code(std::errc::invalid_argument);
+            return;
+        }
+        policy_mode = MPOL_BIND;
+        nodemask = 1UL << options.numa_node;
+    }
+    else
+    {
+        policy_mode = MPOL_INTERLEAVE;
+        nodemask = numa_online_nodes_mask();
+    }
+
+    if(::syscall(SYS_mbind, address, length, policy_mode, &nodemask,
+            8 * sizeof(nodemask) + 1, MPOL_MF_MOVE) != 0)
+    {
+        error = detail::last_error();
+    }
+}
+#endif // __linux__
+
+/**
+ * Creates a memory mapping of a file region.
  *
  * This is the core memory mapping function that interfaces with the OS.
  * It handles page alignment automatically: if the requested offset is not
@@ -1496,12 +3650,24 @@ struct mmap_context
  * @param offset      User-requested byte offset (will be page-aligned internally).
  * @param length      Number of bytes to map.
  * @param mode        Read or read-write access.
+ * @param options     Mapping options (page size selection, etc.).
  * @param error       Output parameter for error reporting.
  * @return mmap_context with mapping details, or empty context on failure.
  */
 inline mmap_context memory_map(const file_handle_type file_handle, const int64_t offset,
-    const int64_t length, const access_mode mode, std::error_code& error)
+    const int64_t length, const access_mode mode, const map_options& options,
+    std::error_code& error)
 {
+#ifndef __linux__
+    // NUMA placement is only implemented on Linux; fail explicitly rather
+    // than silently leaving the pages wherever first touch puts them.
+    if(options.numa != numa_policy::none)
+    {
+        error = std::make_error_code(std::errc::function_not_supported);
+        return {};
+    }
+#endif
+
     // Round down offset to page boundary for OS mapping requirement
     // Cast offset to size_t for make_offset_page_aligned (offset is non-negative for valid mappings).
     const int64_t aligned_offset = static_cast<int64_t>(
@@ -1510,20 +3676,48 @@ inline mmap_context memory_map(const file_handle_type file_handle, const int64_t
     // Actual length to map includes bytes from aligned_offset to offset
     const int64_t length_to_map = offset - aligned_offset + length;
 
+    // Resolve the page size a huge-page request would yield; used both to
+    // validate alignment up front and to report the effective granularity.
+    const size_t huge_size =
+            options.pages != page_mode::normal ? requested_page_size(options.pages) : 0;
+    bool use_huge_pages = false;
+
 #ifdef _WIN32
     // Windows requires the maximum file size for the mapping
     const int64_t max_file_size = offset + length;
 
+    DWORD protect = mode == access_mode::read ? PAGE_READONLY
+            : mode == access_mode::copy_on_write ? PAGE_WRITECOPY
+            : PAGE_READWRITE;
+    if(huge_size != 0)
+    {
+        // Large pages require the SeLockMemoryPrivilege; if CreateFileMapping
+        // rejects the request we retry with normal pages below.
+        protect |= SEC_LARGE_PAGES;
+        use_huge_pages = true;
+    }
+
     // Step 1: Create a file mapping object
     // This is a Windows-specific intermediate object between file and view
-    const auto file_mapping_handle = ::CreateFileMapping(
+    auto file_mapping_handle = ::CreateFileMapping(
             file_handle,
             0,  // Default security
-            mode == access_mode::read ? PAGE_READONLY : PAGE_READWRITE,
+            protect,
             win::int64_high(max_file_size),  // Upper 32 bits of size
             win::int64_low(max_file_size),   // Lower 32 bits of size
             0);  // No name (anonymous mapping)
 
+    if(file_mapping_handle == invalid_handle && use_huge_pages)
+    {
+        // Large pages unavailable (missing privilege or fragmentation);
+        // fall back to the normal page size.
+        use_huge_pages = false;
+        protect &= ~static_cast<DWORD>(SEC_LARGE_PAGES);
+        file_mapping_handle = ::CreateFileMapping(
+                file_handle, 0, protect,
+                win::int64_high(max_file_size), win::int64_low(max_file_size), 0);
+    }
+
     if(file_mapping_handle == invalid_handle)
     {
         error = detail::last_error();
@@ -1534,7 +3728,9 @@ inline mmap_context memory_map(const file_handle_type file_handle, const int64_t
     // Cast length_to_map to SIZE_T (MapViewOfFile expects SIZE_T for size parameter).
     char* mapping_start = static_cast<char*>(::MapViewOfFile(
             file_mapping_handle,
-            mode == access_mode::read ? FILE_MAP_READ : FILE_MAP_WRITE,
+            mode == access_mode::read ? FILE_MAP_READ
+                    : mode == access_mode::copy_on_write ? FILE_MAP_COPY
+                    : FILE_MAP_WRITE,
             win::int64_high(aligned_offset),  // Upper 32 bits of offset
             win::int64_low(aligned_offset),   // Lower 32 bits of offset
             static_cast<SIZE_T>(length_to_map)));
@@ -1546,22 +3742,120 @@ inline mmap_context memory_map(const file_handle_type file_handle, const int64_t
         error = detail::last_error();
         return {};
     }
+
+    if(options.populate)
+    {
+# if _WIN32_WINNT >= 0x0602 // PrefetchVirtualMemory requires Windows 8+
+        // Initiate the reads in bulk, then touch the pages so map() returns
+        // with the mapping actually resident
+        WIN32_MEMORY_RANGE_ENTRY range;
+        range.VirtualAddress = mapping_start;
+        range.NumberOfBytes = static_cast<SIZE_T>(length_to_map);
+        ::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0);
+# endif
+        prefault(mapping_start, static_cast<size_t>(length_to_map));
+    }
 #else // POSIX
+    const int prot = mode == access_mode::read ? PROT_READ : PROT_READ | PROT_WRITE;
+
+    // MAP_SHARED publishes changes to the file and other processes;
+    // MAP_PRIVATE gives this process its own copy of any page it writes
+    int base_flags = mode == access_mode::copy_on_write ? MAP_PRIVATE : MAP_SHARED;
+# ifdef MAP_POPULATE
+    // Fault the mapping in up front instead of on first touch
+    if(options.populate) { base_flags |= MAP_POPULATE; }
+# endif
+    int flags = base_flags;
+# ifdef MAP_HUGETLB
+    // Explicit hugetlb mappings require the file offset to be aligned to the
+    // huge page size; otherwise we skip straight to the THP fallback below.
+    if(huge_size != 0 && static_cast<uint64_t>(aligned_offset) % huge_size == 0)
+    {
+        flags |= MAP_HUGETLB;
+#  ifdef MAP_HUGE_SHIFT
+        if(options.pages == page_mode::huge_2mb) { flags |= 21 << MAP_HUGE_SHIFT; }
+        else if(options.pages == page_mode::huge_1gb) { flags |= 30 << MAP_HUGE_SHIFT; }
+#  endif
+        use_huge_pages = true;
+    }
+# endif
+
+    bool use_sync_map = false;
+    char* mapping_start = static_cast<char*>(MAP_FAILED);
+# ifdef __linux__
+    // pmem request: MAP_SHARED_VALIDATE | MAP_SYNC asks for synchronous
+    // page faults, after which user-space cacheline flushes alone persist
+    // both the data and the file metadata needed to reach it. The kernel
+    // rejects this on non-DAX files, in which case we fall back to the
+    // regular mapping below.
+    if(options.pmem && mode == access_mode::write)
+    {
+        mapping_start = static_cast<char*>(::mmap(
+                0, static_cast<size_t>(length_to_map), prot,
+                (flags & ~MAP_SHARED) | MAP_SHARED_VALIDATE | MAP_SYNC,
+                file_handle, aligned_offset));
+        use_sync_map = mapping_start != MAP_FAILED;
+    }
+# endif
+
     // POSIX mmap is simpler - maps file directly to memory
     // Cast length_to_map to size_t (mmap expects size_t for length parameter).
-    char* mapping_start = static_cast<char*>(::mmap(
-            0,  // Let OS choose mapping address (no hint)
-            static_cast<size_t>(length_to_map),
-            mode == access_mode::read ? PROT_READ : PROT_READ | PROT_WRITE,
-            MAP_SHARED,      // Changes are shared with other processes
-            file_handle,
-            aligned_offset));
+    if(mapping_start == MAP_FAILED)
+    {
+        mapping_start = static_cast<char*>(::mmap(
+                0,  // Let OS choose mapping address (no hint)
+                static_cast<size_t>(length_to_map),
+                prot,
+                flags,
+                file_handle,
+                aligned_offset));
+    }
+
+    if(mapping_start == MAP_FAILED && use_huge_pages)
+    {
+        // hugetlbfs backing is unavailable for this file (the common case for
+        // regular filesystems); retry with normal pages.
+        use_huge_pages = false;
+        mapping_start = static_cast<char*>(::mmap(
+                0, static_cast<size_t>(length_to_map), prot, base_flags,
+                file_handle, aligned_offset));
+    }
 
     if(mapping_start == MAP_FAILED)
     {
         error = detail::last_error();
         return {};
     }
+
+# ifdef MADV_HUGEPAGE
+    // When huge pages were requested but an explicit hugetlb mapping was not
+    // possible, ask for transparent huge pages instead (best effort).
+    if(huge_size != 0 && !use_huge_pages)
+    {
+        ::madvise(mapping_start, static_cast<size_t>(length_to_map), MADV_HUGEPAGE);
+    }
+# endif
+
+# ifdef __linux__
+    if(options.numa != numa_policy::none)
+    {
+        apply_numa_policy(mapping_start, static_cast<size_t>(length_to_map),
+                options, error);
+        if(error)
+        {
+            ::munmap(mapping_start, static_cast<size_t>(length_to_map));
+            return {};
+        }
+    }
+# endif
+
+# ifndef MAP_POPULATE
+    // No kernel support for prefaulting at mmap time; touch the pages instead
+    if(options.populate)
+    {
+        prefault(mapping_start, static_cast<size_t>(length_to_map));
+    }
+# endif
 #endif
 
     // Build result with adjusted pointer
@@ -1570,6 +3864,147 @@ inline mmap_context memory_map(const file_handle_type file_handle, const int64_t
     ctx.data = mapping_start + offset - aligned_offset;  // Adjust for alignment
     ctx.length = length;
     ctx.mapped_length = length_to_map;
+    ctx.page_granularity = use_huge_pages ? huge_size : page_size();
+#ifdef _WIN32
+    ctx.file_mapping_handle = file_mapping_handle;
+#else
+    ctx.sync_map = use_sync_map;
+#endif
+    return ctx;
+}
+
+/**
+ * Creates an anonymous (file-less) memory mapping.
+ *
+ * The returned memory is zero-initialized and demand-paged, backed by
+ * anonymous memory on POSIX and by the pagefile on Windows. Huge-page
+ * requests are honored the same way as for file mappings, including the
+ * transparent-huge-page fallback.
+ *
+ * @param length  Number of bytes to map.
+ * @param mode    Access mode for the mapping.
+ * @param options Mapping options (page size selection, etc.).
+ * @param error   Output parameter for error reporting.
+ * @return mmap_context with mapping details, or empty context on failure.
+ */
+inline mmap_context memory_map_anonymous(const int64_t length, const access_mode mode,
+    const map_options& options, std::error_code& error)
+{
+#ifndef __linux__
+    if(options.numa != numa_policy::none)
+    {
+        error = std::make_error_code(std::errc::function_not_supported);
+        return {};
+    }
+#endif
+
+    const size_t huge_size =
+            options.pages != page_mode::normal ? requested_page_size(options.pages) : 0;
+    bool use_huge_pages = false;
+
+#ifdef _WIN32
+    DWORD protect = mode == access_mode::read ? PAGE_READONLY : PAGE_READWRITE;
+    if(huge_size != 0)
+    {
+        protect |= SEC_LARGE_PAGES | SEC_COMMIT;
+        use_huge_pages = true;
+    }
+
+    // Passing INVALID_HANDLE_VALUE creates a pagefile-backed section
+    auto file_mapping_handle = ::CreateFileMapping(
+            INVALID_HANDLE_VALUE, 0, protect,
+            win::int64_high(length), win::int64_low(length), 0);
+
+    if(file_mapping_handle == invalid_handle && use_huge_pages)
+    {
+        use_huge_pages = false;
+        protect = mode == access_mode::read ? PAGE_READONLY : PAGE_READWRITE;
+        file_mapping_handle = ::CreateFileMapping(
+                INVALID_HANDLE_VALUE, 0, protect,
+                win::int64_high(length), win::int64_low(length), 0);
+    }
+
+    if(file_mapping_handle == invalid_handle)
+    {
+        error = detail::last_error();
+        return {};
+    }
+
+    char* mapping_start = static_cast<char*>(::MapViewOfFile(
+            file_mapping_handle,
+            mode == access_mode::read ? FILE_MAP_READ : FILE_MAP_WRITE,
+            0, 0, static_cast<SIZE_T>(length)));
+
+    if(mapping_start == nullptr)
+    {
+        ::CloseHandle(file_mapping_handle);
+        error = detail::last_error();
+        return {};
+    }
+#else // POSIX
+    const int prot = mode == access_mode::read ? PROT_READ : PROT_READ | PROT_WRITE;
+
+    // Anonymous memory is always private to this process
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+# ifdef MAP_POPULATE
+    if(options.populate) { flags |= MAP_POPULATE; }
+# endif
+# ifdef MAP_HUGETLB
+    if(huge_size != 0)
+    {
+        flags |= MAP_HUGETLB;
+#  ifdef MAP_HUGE_SHIFT
+        if(options.pages == page_mode::huge_2mb) { flags |= 21 << MAP_HUGE_SHIFT; }
+        else if(options.pages == page_mode::huge_1gb) { flags |= 30 << MAP_HUGE_SHIFT; }
+#  endif
+        use_huge_pages = true;
+    }
+# endif
+
+    char* mapping_start = static_cast<char*>(::mmap(
+            0, static_cast<size_t>(length), prot, flags, -1, 0));
+
+    if(mapping_start == MAP_FAILED && use_huge_pages)
+    {
+        // No hugetlb pages reserved on the system; retry with normal pages
+        use_huge_pages = false;
+        mapping_start = static_cast<char*>(::mmap(
+                0, static_cast<size_t>(length), prot,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    }
+
+    if(mapping_start == MAP_FAILED)
+    {
+        error = detail::last_error();
+        return {};
+    }
+
+# ifdef MADV_HUGEPAGE
+    if(huge_size != 0 && !use_huge_pages)
+    {
+        ::madvise(mapping_start, static_cast<size_t>(length), MADV_HUGEPAGE);
+    }
+# endif
+
+# ifdef __linux__
+    if(options.numa != numa_policy::none)
+    {
+        apply_numa_policy(mapping_start, static_cast<size_t>(length), options,
+                error);
+        if(error)
+        {
+            ::munmap(mapping_start, static_cast<size_t>(length));
+            return {};
+        }
+    }
+# endif
+#endif
+
+    mmap_context ctx;
+    ctx.data = mapping_start;
+    ctx.length = length;
+    ctx.mapped_length = length;
+    ctx.page_granularity = use_huge_pages ? huge_size : page_size();
 #ifdef _WIN32
     ctx.file_mapping_handle = file_mapping_handle;
 #endif
@@ -1606,19 +4041,24 @@ basic_mmap<AccessMode, ByteT>::basic_mmap(basic_mmap&& other)
     : data_(std::move(other.data_))
     , length_(std::move(other.length_))
     , mapped_length_(std::move(other.mapped_length_))
+    , page_granularity_(std::move(other.page_granularity_))
+    , file_offset_(std::move(other.file_offset_))
     , file_handle_(std::move(other.file_handle_))
 #ifdef _WIN32
     , file_mapping_handle_(std::move(other.file_mapping_handle_))
 #endif
     , is_handle_internal_(std::move(other.is_handle_internal_))
+    , sync_map_(std::move(other.sync_map_))
 {
     // Reset source to unmapped state to prevent double-free
     other.data_ = nullptr;
-    other.length_ = other.mapped_length_ = 0;
+    other.length_ = other.mapped_length_ = other.page_granularity_ = 0;
+    other.file_offset_ = 0;
     other.file_handle_ = invalid_handle;
 #ifdef _WIN32
     other.file_mapping_handle_ = invalid_handle;
 #endif
+    other.sync_map_ = false;
 }
 
 /**
@@ -1639,20 +4079,25 @@ basic_mmap<AccessMode, ByteT>::operator=(basic_mmap&& other)
         data_ = std::move(other.data_);
         length_ = std::move(other.length_);
         mapped_length_ = std::move(other.mapped_length_);
+        page_granularity_ = std::move(other.page_granularity_);
+        file_offset_ = std::move(other.file_offset_);
         file_handle_ = std::move(other.file_handle_);
 #ifdef _WIN32
         file_mapping_handle_ = std::move(other.file_mapping_handle_);
 #endif
         is_handle_internal_ = std::move(other.is_handle_internal_);
+        sync_map_ = std::move(other.sync_map_);
 
         // Reset source to prevent double-free on destruction
         other.data_ = nullptr;
-        other.length_ = other.mapped_length_ = 0;
+        other.length_ = other.mapped_length_ = other.page_granularity_ = 0;
+        other.file_offset_ = 0;
         other.file_handle_ = invalid_handle;
 #ifdef _WIN32
         other.file_mapping_handle_ = invalid_handle;
 #endif
         other.is_handle_internal_ = false;
+        other.sync_map_ = false;
     }
     return *this;
 }
@@ -1684,25 +4129,66 @@ basic_mmap<AccessMode, ByteT>::mapping_handle() const noexcept
 template<access_mode AccessMode, typename ByteT>
 void basic_mmap<AccessMode, ByteT>::map(const std::filesystem::path& path, const size_type offset,
         const size_type length, std::error_code& error)
+{
+    map(path, offset, length, map_options{}, error);
+}
+
+/** @copydoc basic_mmap::map(const std::filesystem::path&,size_type,size_type,std::error_code&) */
+template<access_mode AccessMode, typename ByteT>
+void basic_mmap<AccessMode, ByteT>::map(const std::filesystem::path& path, const size_type offset,
+        const size_type length, const map_options& options, std::error_code& error)
+{
+    map_with_path(path, offset, length, options, error);
+}
+
+/**
+ * Shared body of the path-based map() overloads.
+ *
+ * `Path` is std::filesystem::path or a native string pointer; the
+ * open_file() overload it resolves to decides whether a path object is
+ * ever constructed. Null/empty paths are rejected by open_file().
+ */
+template<access_mode AccessMode, typename ByteT>
+template<typename Path>
+void basic_mmap<AccessMode, ByteT>::map_with_path(const Path& path, const size_type offset,
+        const size_type length, const map_options& options, std::error_code& error)
 {
     error.clear();
 
-    // Validate path
-    if(path.empty())
+    // Creating or growing a file only makes sense for write mappings
+    if(options.create && AccessMode != access_mode::write)
     {
         error = std::make_error_code(std::errc::invalid_argument);
         return;
     }
 
     // Open file (handle will be closed on unmap since is_handle_internal_=true)
-    const auto handle = detail::open_file(path, AccessMode, error);
+    const auto handle = detail::open_file(path, AccessMode, options.create,
+            options.access_pattern, error);
     if(error)
     {
         return;
     }
 
+    // Grow the file so the requested range exists. A freshly created file is
+    // empty, so without this step mapping it would fail (or, with
+    // map_entire_file, silently yield an empty mapping).
+    if(options.create && length != map_entire_file)
+    {
+        const auto file_size = detail::query_file_size(handle, error);
+        if(!error && offset + length > file_size)
+        {
+            detail::resize_file(handle, offset + length, error);
+        }
+        if(error)
+        {
+            detail::close_file(handle);
+            return;
+        }
+    }
+
     // Create the mapping using the handle overload
-    map(handle, offset, length, error);
+    map(handle, offset, length, options, error);
 
     // Mark handle as internally owned (so we close it on unmap)
     // This MUST be after the call to map(), which sets is_handle_internal_=false
@@ -1710,6 +4196,11 @@ void basic_mmap<AccessMode, ByteT>::map(const std::filesystem::path& path, const
     {
         is_handle_internal_ = true;
     }
+    else
+    {
+        // The mapping failed, so nothing will ever close the handle we opened
+        detail::close_file(handle);
+    }
 }
 
 /**
@@ -1726,6 +4217,15 @@ void basic_mmap<AccessMode, ByteT>::map(const std::filesystem::path& path, const
 template<access_mode AccessMode, typename ByteT>
 void basic_mmap<AccessMode, ByteT>::map(const handle_type handle,
         const size_type offset, const size_type length, std::error_code& error)
+{
+    map(handle, offset, length, map_options{}, error);
+}
+
+/** @copydoc basic_mmap::map(handle_type,size_type,size_type,std::error_code&) */
+template<access_mode AccessMode, typename ByteT>
+void basic_mmap<AccessMode, ByteT>::map(const handle_type handle,
+        const size_type offset, const size_type length,
+        const map_options& options, std::error_code& error)
 {
     error.clear();
 
@@ -1756,7 +4256,9 @@ void basic_mmap<AccessMode, ByteT>::map(const handle_type handle,
     const auto ctx = detail::memory_map(handle,
             static_cast<int64_t>(offset),
             static_cast<int64_t>(length == map_entire_file ? (file_size - offset) : length),
-            AccessMode, error);
+            AccessMode, options, error);
+    detail::stats_on_map(error ? 0 : static_cast<uint64_t>(ctx.length),
+            static_cast<bool>(error));
 
     if(!error)
     {
@@ -1772,6 +4274,9 @@ void basic_mmap<AccessMode, ByteT>::map(const handle_type handle,
         // Cast int64_t to size_type (safe: values are from successful mapping, always non-negative).
         length_ = static_cast<size_type>(ctx.length);
         mapped_length_ = static_cast<size_type>(ctx.mapped_length);
+        page_granularity_ = ctx.page_granularity;
+        file_offset_ = offset;
+        sync_map_ = ctx.sync_map;
 #ifdef _WIN32
         file_mapping_handle_ = ctx.file_mapping_handle;
 #endif
@@ -1779,209 +4284,3381 @@ void basic_mmap<AccessMode, ByteT>::map(const handle_type handle,
 }
 
 /**
- * Synchronizes the mapped memory to disk.
+ * Establishes an anonymous memory mapping.
  *
- * Flushes any modified pages in the mapping to the underlying file.
- * This is a blocking operation that returns when the write completes.
+ * There is no file handle; is_open() is true while the memory is mapped,
+ * and unmap() releases the memory without closing anything else.
  *
- * Only available for write-mode mappings (enforced by static_assert).
+ * Provides the same strong guarantee as the file-backed map() overloads:
+ * the existing mapping (if any) is only released after the new one has
+ * been created.
  */
 template<access_mode AccessMode, typename ByteT>
-void basic_mmap<AccessMode, ByteT>::sync(std::error_code& error)
+void basic_mmap<AccessMode, ByteT>::map_anonymous(const size_type length,
+        const map_options& options, std::error_code& error)
 {
-    static_assert(AccessMode == access_mode::write, "sync() requires write access");
-
     error.clear();
 
-    if(!is_open())
+    if(length == 0)
     {
-        error = std::make_error_code(std::errc::bad_file_descriptor);
+        error = std::make_error_code(std::errc::invalid_argument);
         return;
     }
 
-    if(data())
+    const auto ctx = detail::memory_map_anonymous(
+            static_cast<int64_t>(length), AccessMode, options, error);
+    detail::stats_on_map(error ? 0 : static_cast<uint64_t>(ctx.length),
+            static_cast<bool>(error));
+
+    if(!error)
+    {
+        // Unmap previous mapping only after the new mapping succeeded
+        unmap();
+
+        file_handle_ = invalid_handle;
+        is_handle_internal_ = false;
+        data_ = reinterpret_cast<pointer>(ctx.data);
+        length_ = static_cast<size_type>(ctx.length);
+        mapped_length_ = static_cast<size_type>(ctx.mapped_length);
+        page_granularity_ = ctx.page_granularity;
+        file_offset_ = 0;
+        sync_map_ = ctx.sync_map;
+#ifdef _WIN32
+        file_mapping_handle_ = ctx.file_mapping_handle;
+#endif
+    }
+}
+
+/**
+ * Synchronizes the mapped memory to disk.
+ *
+ * Flushes any modified pages in the mapping to the underlying file.
+ * This is a blocking operation that returns when the write completes.
+ *
+ * Only available for write-mode mappings (enforced by static_assert).
+ */
+template<access_mode AccessMode, typename ByteT>
+void basic_mmap<AccessMode, ByteT>::sync(std::error_code& error)
+{
+    sync(0, map_entire_file, sync_mode::sync, error);
+}
+
+/**
+ * Flushes a subrange of the mapping with the requested durability tier.
+ *
+ * The user-supplied range is relative to data() and is aligned down to a
+ * page boundary before being handed to msync()/FlushViewOfFile, which both
+ * require page-aligned addresses.
+ */
+template<access_mode AccessMode, typename ByteT>
+void basic_mmap<AccessMode, ByteT>::sync(const size_type offset, const size_type length,
+        const sync_mode mode, std::error_code& error)
+{
+    static_assert(AccessMode == access_mode::write, "sync() requires write access");
+
+    error.clear();
+
+    if(!is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return;
+    }
+
+    // Anonymous mappings have no backing file to flush to
+    if(file_handle_ == invalid_handle) { return; }
+
+    // Validate that the range lies within the mapping
+    if(offset > length_ || (length != map_entire_file && offset + length > length_))
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
+
+    if(data())
+    {
+        // If length==map_entire_file (0), flush from offset to end of mapping
+        const size_type sync_length =
+                length == map_entire_file ? length_ - offset : length;
+        if(sync_length == 0) { return; }
+
+        // Times the flush and records it (with the final error state) on
+        // scope exit; a no-op unless MIO_ENABLE_STATS is defined.
+        [[maybe_unused]] const detail::stats_sync_timer sync_timer(error);
+
+        // Round the start of the range down to a page boundary, measured from
+        // the actual mapping start, and clamp the end to the mapping.
+        const size_type aligned_offset =
+                make_offset_page_aligned(mapping_offset() + offset);
+        const size_type aligned_length = std::min(
+                mapping_offset() + offset + sync_length - aligned_offset,
+                mapped_length_ - aligned_offset);
+        char* const address =
+                reinterpret_cast<char*>(get_mapping_start()) + aligned_offset;
+
+#ifdef _WIN32
+        // Windows: FlushViewOfFile writes the range to the system cache;
+        // FlushFileBuffers makes it (and file metadata) durable on disk.
+        if(::FlushViewOfFile(address, static_cast<SIZE_T>(aligned_length)) == 0)
+        {
+            error = detail::last_error();
+            return;
+        }
+        if(mode != sync_mode::async && ::FlushFileBuffers(file_handle_) == 0)
+        {
+            error = detail::last_error();
+            return;
+        }
+#else // POSIX
+# ifdef MIO_CACHELINE_FLUSH
+        // MAP_SYNC mapping: stores already sit in (or on their way to) the
+        // persistence domain, so durability is a matter of flushing the
+        // dirty cachelines and fencing - no syscall, no page writeback.
+        // MAP_SYNC guarantees the file metadata for the mapped extents is
+        // durable, so even sync_mode::full needs no fsync here.
+        if(sync_map_)
+        {
+            detail::flush_cachelines(address,
+                    static_cast<size_t>(aligned_length));
+            return;
+        }
+# endif
+        // POSIX: MS_ASYNC schedules the writeback, MS_SYNC waits for it
+        if(::msync(address, aligned_length,
+                mode == sync_mode::async ? MS_ASYNC : MS_SYNC) != 0)
+        {
+            error = detail::last_error();
+            return;
+        }
+        // Full durability additionally flushes file metadata
+        if(mode == sync_mode::full && ::fsync(file_handle_) != 0)
+        {
+            error = detail::last_error();
+            return;
+        }
+#endif
+    }
+}
+
+/**
+ * Grows or shrinks the mapping in place.
+ *
+ * On Linux this uses mremap(), which preserves resident pages (the mapping
+ * may move, in which case data() changes). Elsewhere a new view is created
+ * before the old one is released so a failed resize leaves the mapping
+ * untouched.
+ */
+template<access_mode AccessMode, typename ByteT>
+void basic_mmap<AccessMode, ByteT>::resize(const size_type new_length, std::error_code& error)
+{
+    static_assert(AccessMode == access_mode::write, "resize() requires write access");
+
+    error.clear();
+
+    if(!is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return;
+    }
+    if(new_length == 0)
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
+    if(new_length == length_) { return; }
+
+    // Anonymous mappings have no file to extend; mremap alone suffices on
+    // Linux, and there is no portable in-place resize elsewhere.
+    const bool anonymous = file_handle_ == invalid_handle;
+
+    // When growing, extend the file first so the added range exists.
+    // The file is never shrunk; a shrinking resize only narrows the view.
+    if(new_length > length_ && !anonymous)
+    {
+        const auto file_size = detail::query_file_size(file_handle_, error);
+        if(error) { return; }
+        if(file_offset_ + new_length > file_size)
+        {
+            detail::resize_file(file_handle_, file_offset_ + new_length, error);
+            if(error) { return; }
+        }
+    }
+
+    const size_type new_mapped_length = mapping_offset() + new_length;
+
+#ifdef __linux__
+    // mremap extends (or shrinks) the mapping, moving it if the adjacent
+    // address space is occupied. Resident pages survive the move.
+    void* const new_start = ::mremap(get_mapping_start(), mapped_length_,
+            new_mapped_length, MREMAP_MAYMOVE);
+    if(new_start == MAP_FAILED)
+    {
+        error = detail::last_error();
+        return;
+    }
+    data_ = reinterpret_cast<pointer>(
+            static_cast<char*>(new_start) + mapping_offset());
+    length_ = new_length;
+    mapped_length_ = new_mapped_length;
+#else
+    if(anonymous)
+    {
+        error = std::make_error_code(std::errc::function_not_supported);
+        return;
+    }
+
+    // No in-place remap primitive; map the new view first so that on
+    // failure the existing mapping remains valid (strong guarantee).
+    const auto ctx = detail::memory_map(file_handle_,
+            static_cast<int64_t>(file_offset_),
+            static_cast<int64_t>(new_length),
+            AccessMode, map_options{}, error);
+    if(error) { return; }
+
+# ifdef _WIN32
+    ::UnmapViewOfFile(get_mapping_start());
+    ::CloseHandle(file_mapping_handle_);
+    file_mapping_handle_ = ctx.file_mapping_handle;
+# else // POSIX
+    ::munmap(get_mapping_start(), mapped_length_);
+# endif
+    data_ = reinterpret_cast<pointer>(ctx.data);
+    length_ = static_cast<size_type>(ctx.length);
+    mapped_length_ = static_cast<size_type>(ctx.mapped_length);
+    page_granularity_ = ctx.page_granularity;
+    sync_map_ = ctx.sync_map;
+#endif
+}
+
+/**
+ * Punches a hole over a retired range of the mapping.
+ *
+ * The byte range is zeroed through the filesystem (which handles partial
+ * blocks), deallocating its on-disk blocks, and the pages fully covered by
+ * the range are dropped from memory. Partial pages at the edges are never
+ * dropped - their remainder is live data - only zeroed.
+ */
+template<access_mode AccessMode, typename ByteT>
+void basic_mmap<AccessMode, ByteT>::discard(const size_type offset,
+        const size_type length, std::error_code& error)
+{
+    static_assert(AccessMode == access_mode::write, "discard() requires write access");
+
+    error.clear();
+
+    if(!is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return;
+    }
+
+    // Validate that the range lies within the mapping
+    if(offset > length_ || (length != map_entire_file && offset + length > length_))
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
+
+    const size_type discard_length =
+            length == map_entire_file ? length_ - offset : length;
+    if(discard_length == 0) { return; }
+
+#if defined(__linux__)
+    // Memory-side geometry, in bytes from the actual mapping start. Round
+    // the range inward to the granularity backing the mapping (huge pages
+    // must be dropped whole): [aligned_begin, aligned_end) are the pages
+    // owned entirely by the discard.
+    const size_type begin = mapping_offset() + offset;
+    const size_type end = begin + discard_length;
+    const size_type mask = page_granularity_ - 1;
+    const size_type aligned_begin = (begin + mask) & ~mask;
+    const size_type aligned_end = end & ~mask;
+    char* const mapping_start = reinterpret_cast<char*>(get_mapping_start());
+
+    if(file_handle_ != invalid_handle)
+    {
+        // Punch the exact byte range in the file. The filesystem zeroes
+        // partial blocks, and since the mapping reads through the page
+        // cache, the hole is immediately visible in memory too.
+        if(::fallocate(file_handle_,
+                FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                static_cast<off_t>(file_offset_ + offset),
+                static_cast<off_t>(discard_length)) != 0)
+        {
+            error = detail::last_error();
+            return;
+        }
+    }
+    else
+    {
+        // Anonymous memory has no file to punch; zero the partial edge
+        // pages by hand so the whole range reads back as zero. The fully
+        // covered pages are handled by madvise below (zero-fill on next
+        // touch for private anonymous memory).
+        if(aligned_begin >= aligned_end)
+        {
+            std::memset(mapping_start + begin, 0, discard_length);
+        }
+        else
+        {
+            if(begin < aligned_begin)
+            {
+                std::memset(mapping_start + begin, 0, aligned_begin - begin);
+            }
+            if(aligned_end < end)
+            {
+                std::memset(mapping_start + aligned_end, 0, end - aligned_end);
+            }
+        }
+    }
+
+    // Drop the fully covered pages so the resident set shrinks now rather
+    // than under memory pressure.
+    if(aligned_end > aligned_begin
+       && ::madvise(mapping_start + aligned_begin,
+                static_cast<size_t>(aligned_end - aligned_begin),
+                MADV_DONTNEED) != 0)
+    {
+        error = detail::last_error();
+    }
+#elif defined(_WIN32)
+    if(file_handle_ == invalid_handle)
+    {
+        // Anonymous pagefile-backed memory: zero the range; the memory
+        // manager reclaims zeroed pages under pressure.
+        std::memset(reinterpret_cast<char*>(data_) + offset, 0,
+                static_cast<size_t>(discard_length));
+        return;
+    }
+
+    DWORD bytes_returned = 0;
+    // Zeroed ranges only release blocks on sparse files; marking an
+    // already-sparse file sparse again is a no-op.
+    ::DeviceIoControl(file_handle_, FSCTL_SET_SPARSE, nullptr, 0,
+            nullptr, 0, &bytes_returned, nullptr);
+
+    FILE_ZERO_DATA_INFORMATION zero_range;
+    zero_range.FileOffset.QuadPart =
+            static_cast<LONGLONG>(file_offset_ + offset);
+    zero_range.BeyondFinalZero.QuadPart =
+            static_cast<LONGLONG>(file_offset_ + offset + discard_length);
+    if(::DeviceIoControl(file_handle_, FSCTL_SET_ZERO_DATA, &zero_range,
+            sizeof zero_range, nullptr, 0, &bytes_returned, nullptr) == 0)
+    {
+        error = detail::last_error();
+    }
+#else
+    // No portable hole-punching primitive on the remaining platforms.
+    error = std::make_error_code(std::errc::function_not_supported);
+#endif
+}
+
+/**
+ * Pins a subrange of the mapping into physical memory.
+ *
+ * The user-supplied range is relative to data() and is aligned down to a
+ * page boundary before being handed to mlock()/VirtualLock(), which operate
+ * on whole pages.
+ */
+template<access_mode AccessMode, typename ByteT>
+void basic_mmap<AccessMode, ByteT>::lock(const size_type offset, const size_type length,
+        std::error_code& error)
+{
+    error.clear();
+
+    if(!is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return;
+    }
+
+    // Validate that the range lies within the mapping
+    if(offset > length_ || (length != map_entire_file && offset + length > length_))
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
+
+    const size_type lock_length =
+            length == map_entire_file ? length_ - offset : length;
+    if(lock_length == 0) { return; }
+
+    // Round the start of the range down to a page boundary, measured from
+    // the actual mapping start, and clamp the end to the mapping.
+    const size_type aligned_offset =
+            make_offset_page_aligned(mapping_offset() + offset);
+    const size_type aligned_length = std::min(
+            mapping_offset() + offset + lock_length - aligned_offset,
+            mapped_length_ - aligned_offset);
+    char* const address =
+            reinterpret_cast<char*>(get_mapping_start()) + aligned_offset;
+
+#ifdef _WIN32
+    if(::VirtualLock(address, static_cast<SIZE_T>(aligned_length)) == 0)
+#else // POSIX
+    if(::mlock(address, aligned_length) != 0)
+#endif
+    {
+        error = detail::last_error();
+    }
+}
+
+/**
+ * Releases a previously pinned subrange of the mapping.
+ */
+template<access_mode AccessMode, typename ByteT>
+void basic_mmap<AccessMode, ByteT>::unlock(const size_type offset, const size_type length,
+        std::error_code& error)
+{
+    error.clear();
+
+    if(!is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return;
+    }
+
+    // Validate that the range lies within the mapping
+    if(offset > length_ || (length != map_entire_file && offset + length > length_))
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
+
+    const size_type unlock_length =
+            length == map_entire_file ? length_ - offset : length;
+    if(unlock_length == 0) { return; }
+
+    const size_type aligned_offset =
+            make_offset_page_aligned(mapping_offset() + offset);
+    const size_type aligned_length = std::min(
+            mapping_offset() + offset + unlock_length - aligned_offset,
+            mapped_length_ - aligned_offset);
+    char* const address =
+            reinterpret_cast<char*>(get_mapping_start()) + aligned_offset;
+
+#ifdef _WIN32
+    // VirtualUnlock on a range with no locked pages fails with
+    // ERROR_NOT_LOCKED; treat that as the no-op it effectively is.
+    if(::VirtualUnlock(address, static_cast<SIZE_T>(aligned_length)) == 0
+       && ::GetLastError() != ERROR_NOT_LOCKED)
+#else // POSIX
+    if(::munlock(address, aligned_length) != 0)
+#endif
+    {
+        error = detail::last_error();
+    }
+}
+
+/**
+ * Applies a memory-access hint to a subrange of the mapping.
+ *
+ * The user-supplied range is relative to data(). It is translated to an
+ * absolute, page-aligned range within the actual mapping before being
+ * handed to the kernel, since madvise()/PrefetchVirtualMemory require
+ * page-aligned addresses.
+ */
+template<access_mode AccessMode, typename ByteT>
+void basic_mmap<AccessMode, ByteT>::advise(const advice adv, const size_type offset,
+        const size_type length, std::error_code& error)
+{
+    error.clear();
+
+    if(!is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return;
+    }
+
+    // Validate that the range lies within the mapping
+    if(offset > length_ || (length != map_entire_file && offset + length > length_))
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
+
+    // If length==map_entire_file (0), advise from offset to end of mapping
+    const size_type advise_length =
+            length == map_entire_file ? length_ - offset : length;
+    if(advise_length == 0) { return; }
+
+    // Round the start of the range down to a page boundary. Offsets are
+    // measured from the actual mapping start (data() sits mapping_offset()
+    // bytes into the mapping), and the aligned length is clamped so the
+    // range never extends past the mapping.
+    const size_type aligned_offset =
+            make_offset_page_aligned(mapping_offset() + offset);
+    const size_type aligned_length = std::min(
+            mapping_offset() + offset + advise_length - aligned_offset,
+            mapped_length_ - aligned_offset);
+    char* const address =
+            reinterpret_cast<char*>(get_mapping_start()) + aligned_offset;
+
+#ifdef _WIN32
+    switch(adv)
+    {
+    case advice::will_need:
+    {
+# if _WIN32_WINNT >= 0x0602 // PrefetchVirtualMemory requires Windows 8+
+        WIN32_MEMORY_RANGE_ENTRY range;
+        range.VirtualAddress = address;
+        range.NumberOfBytes = static_cast<SIZE_T>(aligned_length);
+        if(::PrefetchVirtualMemory(::GetCurrentProcess(), 1, &range, 0) == 0)
+        {
+            error = detail::last_error();
+        }
+# endif
+        break;
+    }
+    case advice::dont_need:
+    case advice::free:
+# if _WIN32_WINNT >= 0x0A00 // DiscardVirtualMemory requires Windows 10+
+        if(::DiscardVirtualMemory(address, static_cast<SIZE_T>(aligned_length))
+                != ERROR_SUCCESS)
+        {
+            error = detail::last_error();
+        }
+# endif
+        break;
+    default:
+        // normal/sequential/random have no Windows equivalent; the cache
+        // manager's behavior cannot be changed after the view is mapped.
+        break;
+    }
+#else // POSIX
+    int sys_advice = MADV_NORMAL;
+    switch(adv)
+    {
+    case advice::normal:     sys_advice = MADV_NORMAL; break;
+    case advice::sequential: sys_advice = MADV_SEQUENTIAL; break;
+    case advice::random:     sys_advice = MADV_RANDOM; break;
+    case advice::will_need:  sys_advice = MADV_WILLNEED; break;
+    case advice::dont_need:  sys_advice = MADV_DONTNEED; break;
+# ifdef MADV_FREE
+    case advice::free:       sys_advice = MADV_FREE; break;
+# else
+    // MADV_FREE is Linux 4.5+/BSD only; DONTNEED is the closest substitute.
+    case advice::free:       sys_advice = MADV_DONTNEED; break;
+# endif
+    }
+    if(::madvise(address, aligned_length, sys_advice) != 0)
+    {
+        error = detail::last_error();
+    }
+#endif
+}
+
+/**
+ * Queries page residency for a subrange of the mapping.
+ *
+ * The user-supplied range is relative to data() and page-aligned internally
+ * like the other range operations. One bitmap entry is produced per page of
+ * the aligned range; the summary statistics are computed in the same pass.
+ */
+template<access_mode AccessMode, typename ByteT>
+page_residency basic_mmap<AccessMode, ByteT>::residency(const size_type offset,
+        const size_type length, std::error_code& error) const
+{
+    error.clear();
+    page_residency result;
+
+    if(!is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return result;
+    }
+
+    // Validate that the range lies within the mapping
+    if(offset > length_ || (length != map_entire_file && offset + length > length_))
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return result;
+    }
+
+    const size_type query_length =
+            length == map_entire_file ? length_ - offset : length;
+    if(query_length == 0) { return result; }
+
+    const size_type aligned_offset =
+            make_offset_page_aligned(mapping_offset() + offset);
+    const size_type aligned_length = std::min(
+            mapping_offset() + offset + query_length - aligned_offset,
+            mapped_length_ - aligned_offset);
+    char* const address =
+            const_cast<char*>(reinterpret_cast<const char*>(
+                    get_mapping_start())) + aligned_offset;
+
+    const size_t page_size_ = page_size();
+    const size_t num_pages = (aligned_length + page_size_ - 1) / page_size_;
+
+#ifdef _WIN32
+    std::vector<PSAPI_WORKING_SET_EX_INFORMATION> info(num_pages);
+    for(size_t i = 0; i < num_pages; ++i)
+    {
+        info[i].VirtualAddress = address + i * page_size_;
+    }
+    if(::QueryWorkingSetEx(::GetCurrentProcess(), info.data(),
+            static_cast<DWORD>(info.size() * sizeof(info[0]))) == 0)
+    {
+        error = detail::last_error();
+        return result;
+    }
+#else // POSIX
+    // mincore's vector parameter is unsigned char* on Linux but char* on
+    // BSD-derived systems (including macOS).
+    std::vector<unsigned char> info(num_pages);
+# ifdef __linux__
+    if(::mincore(address, aligned_length, info.data()) != 0)
+# else
+    if(::mincore(address, aligned_length,
+            reinterpret_cast<char*>(info.data())) != 0)
+# endif
+    {
+        error = detail::last_error();
+        return result;
+    }
+#endif
+
+    result.page_size = page_size_;
+    result.pages.resize(num_pages);
+    bool previous_resident = false;
+    for(size_t i = 0; i < num_pages; ++i)
+    {
+#ifdef _WIN32
+        const bool resident = info[i].VirtualAttributes.Valid != 0;
+#else
+        // Only the low bit of each mincore entry is defined.
+        const bool resident = (info[i] & 1) != 0;
+#endif
+        result.pages[i] = resident;
+        if(resident)
+        {
+            ++result.resident_pages;
+            if(!previous_resident) { ++result.resident_runs; }
+        }
+        previous_resident = resident;
+    }
+    return result;
+}
+
+/**
+ * Queries NUMA placement for a subrange of the mapping.
+ *
+ * Uses move_pages() in query mode (no target nodes), which reports the
+ * node currently holding each page, or a negative errno value (commonly
+ * -ENOENT) for pages that are not resident.
+ */
+template<access_mode AccessMode, typename ByteT>
+std::vector<int> basic_mmap<AccessMode, ByteT>::numa_nodes(const size_type offset,
+        const size_type length, std::error_code& error) const
+{
+    error.clear();
+    std::vector<int> nodes;
+
+    if(!is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return nodes;
+    }
+
+    // Validate that the range lies within the mapping
+    if(offset > length_ || (length != map_entire_file && offset + length > length_))
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return nodes;
+    }
+
+#ifdef __linux__
+    const size_type query_length =
+            length == map_entire_file ? length_ - offset : length;
+    if(query_length == 0) { return nodes; }
+
+    const size_type aligned_offset =
+            make_offset_page_aligned(mapping_offset() + offset);
+    const size_type aligned_length = std::min(
+            mapping_offset() + offset + query_length - aligned_offset,
+            mapped_length_ - aligned_offset);
+    char* const address =
+            const_cast<char*>(reinterpret_cast<const char*>(
+                    get_mapping_start())) + aligned_offset;
+
+    const size_t page_size_ = page_size();
+    const size_t num_pages = (aligned_length + page_size_ - 1) / page_size_;
+
+    std::vector<void*> pages(num_pages);
+    for(size_t i = 0; i < num_pages; ++i)
+    {
+        pages[i] = address + i * page_size_;
+    }
+    nodes.resize(num_pages);
+    if(::syscall(SYS_move_pages, 0, num_pages, pages.data(), nullptr,
+            nodes.data(), 0) != 0)
+    {
+        error = detail::last_error();
+        nodes.clear();
+    }
+#else
+    error = std::make_error_code(std::errc::function_not_supported);
+#endif
+    return nodes;
+}
+
+/**
+ * Unmaps the file and releases resources.
+ *
+ * Performs cleanup in the following order:
+ * 1. Unmap the memory region
+ * 2. Close file mapping handle (Windows only)
+ * 3. Close file handle (only if opened internally via path)
+ * 4. Reset all member variables to default state
+ *
+ * Calling unmap() on an already-unmapped object is safe (no-op).
+ */
+template<access_mode AccessMode, typename ByteT>
+void basic_mmap<AccessMode, ByteT>::unmap()
+{
+    if(!is_open()) { return; }
+
+    detail::stats_on_unmap(static_cast<uint64_t>(length_));
+
+    // Step 1: Unmap the memory region
+#ifdef _WIN32
+    if(is_mapped())
+    {
+        ::UnmapViewOfFile(get_mapping_start());
+        ::CloseHandle(file_mapping_handle_);
+    }
+#else // POSIX
+    if(data_) { ::munmap(const_cast<pointer>(get_mapping_start()), mapped_length_); }
+#endif
+
+    // Step 2: Close file handle if we opened it (internal handle)
+    // External handles (provided by user) are NOT closed
+    if(is_handle_internal_)
+    {
+#ifdef _WIN32
+        ::CloseHandle(file_handle_);
+#else // POSIX
+        ::close(file_handle_);
+#endif
+    }
+
+    // Step 3: Reset to default (unmapped) state
+    data_ = nullptr;
+    length_ = mapped_length_ = page_granularity_ = file_offset_ = 0;
+    sync_map_ = false;
+    file_handle_ = invalid_handle;
+#ifdef _WIN32
+    file_mapping_handle_ = invalid_handle;
+#endif
+}
+
+/**
+ * Checks if the memory mapping exists.
+ *
+ * On Windows, checks the file mapping handle (distinct from file handle).
+ * On POSIX, equivalent to is_open().
+ */
+template<access_mode AccessMode, typename ByteT>
+bool basic_mmap<AccessMode, ByteT>::is_mapped() const noexcept
+{
+#ifdef _WIN32
+    return file_mapping_handle_ != invalid_handle;
+#else // POSIX
+    return data_ != nullptr;
+#endif
+}
+
+/**
+ * Swaps contents with another mmap.
+ *
+ * Efficiently exchanges all state without any system calls.
+ */
+template<access_mode AccessMode, typename ByteT>
+void basic_mmap<AccessMode, ByteT>::swap(basic_mmap& other) noexcept
+{
+    if(this != &other)
+    {
+        using std::swap;
+        swap(data_, other.data_);
+        swap(file_handle_, other.file_handle_);
+#ifdef _WIN32
+        swap(file_mapping_handle_, other.file_mapping_handle_);
+#endif
+        swap(length_, other.length_);
+        swap(mapped_length_, other.mapped_length_);
+        swap(page_granularity_, other.page_granularity_);
+        swap(sync_map_, other.sync_map_);
+        swap(file_offset_, other.file_offset_);
+        swap(is_handle_internal_, other.is_handle_internal_);
+    }
+}
+
+/**
+ * Conditionally syncs based on access mode.
+ *
+ * Called from destructor. Uses `if constexpr` for compile-time dispatch:
+ * - Write mode: Calls sync() (ignoring errors in destructor context)
+ * - Read mode: No-op
+ */
+template<access_mode AccessMode, typename ByteT>
+void basic_mmap<AccessMode, ByteT>::conditional_sync()
+{
+    if constexpr (AccessMode == access_mode::write) {
+        // Destructor can't handle errors, so we just try our best
+        std::error_code ec;
+        sync(ec);
+        // Error intentionally ignored - destructor shouldn't throw
+    }
+    // For read mode: nothing to do
+}
+
+// -----------------------------------------------------------------------------
+// Comparison operators
+// -----------------------------------------------------------------------------
+
+/**
+ * Equality: Same data pointer and size.
+ */
+template<access_mode AccessMode, typename ByteT>
+bool operator==(const basic_mmap<AccessMode, ByteT>& a,
+        const basic_mmap<AccessMode, ByteT>& b)
+{
+    return a.data() == b.data()
+        && a.size() == b.size();
+}
+
+template<access_mode AccessMode, typename ByteT>
+bool operator!=(const basic_mmap<AccessMode, ByteT>& a,
+        const basic_mmap<AccessMode, ByteT>& b)
+{
+    return !(a == b);
+}
+
+/**
+ * Ordering: Compare by data pointer first, then by size.
+ */
+template<access_mode AccessMode, typename ByteT>
+bool operator<(const basic_mmap<AccessMode, ByteT>& a,
+        const basic_mmap<AccessMode, ByteT>& b)
+{
+    if(a.data() == b.data()) { return a.size() < b.size(); }
+    return a.data() < b.data();
+}
+
+template<access_mode AccessMode, typename ByteT>
+bool operator<=(const basic_mmap<AccessMode, ByteT>& a,
+        const basic_mmap<AccessMode, ByteT>& b)
+{
+    return !(a > b);
+}
+
+template<access_mode AccessMode, typename ByteT>
+bool operator>(const basic_mmap<AccessMode, ByteT>& a,
+        const basic_mmap<AccessMode, ByteT>& b)
+{
+    if(a.data() == b.data()) { return a.size() > b.size(); }
+    return a.data() > b.data();
+}
+
+template<access_mode AccessMode, typename ByteT>
+bool operator>=(const basic_mmap<AccessMode, ByteT>& a,
+        const basic_mmap<AccessMode, ByteT>& b)
+{
+    return !(a < b);
+}
+
+// -----------------------------------------------------------------------------
+// Zero-copy range cloning
+// -----------------------------------------------------------------------------
+
+template<access_mode SrcAccessMode, access_mode DstAccessMode, typename ByteT>
+void clone_range(const basic_mmap<SrcAccessMode, ByteT>& source,
+        basic_mmap<DstAccessMode, ByteT>& dest, const size_t src_offset,
+        const size_t dst_offset, const size_t length, std::error_code& error)
+{
+    static_assert(DstAccessMode != access_mode::read,
+            "clone_range requires a writable destination");
+    error.clear();
+
+    if(!source.is_open() || !dest.is_open())
+    {
+        error = std::make_error_code(std::errc::bad_file_descriptor);
+        return;
+    }
+
+    // Validate that both ranges lie within their mappings
+    if(src_offset > source.size()
+       || (length != map_entire_file
+           && length > source.size() - src_offset))
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
+    const size_t clone_length = length == map_entire_file
+            ? source.size() - src_offset : length;
+    if(dst_offset > dest.size() || clone_length > dest.size() - dst_offset)
+    {
+        error = std::make_error_code(std::errc::invalid_argument);
+        return;
+    }
+    if(clone_length == 0) { return; }
+
+#ifdef __linux__
+    // Kernel-offloaded path. Both ranges must be file-backed, the
+    // destination must be a shared (write) mapping - a copy-on-write
+    // destination is private, so writing its file would not be observed
+    // through the mapping - and the source must not be copy-on-write
+    // either: a COW source's dirty pages are private and never reach the
+    // file, so the kernel would copy stale file bytes instead of the
+    // live view. Dirty pages of shared mappings live in the page cache,
+    // which is exactly what copy_file_range() reads from and writes to,
+    // so no sync is needed on either side and on reflink filesystems
+    // (Btrfs, XFS) the extents are shared instead of copied.
+    if(DstAccessMode == access_mode::write
+       && SrcAccessMode != access_mode::copy_on_write
+       && source.file_handle() != invalid_handle
+       && dest.file_handle() != invalid_handle)
+    {
+        loff_t off_in = static_cast<loff_t>(
+                source.file_offset() + src_offset);
+        loff_t off_out = static_cast<loff_t>(
+                dest.file_offset() + dst_offset);
+        size_t remaining = clone_length;
+        while(remaining > 0)
+        {
+            const ssize_t copied = ::copy_file_range(source.file_handle(),
+                    &off_in, dest.file_handle(), &off_out, remaining, 0);
+            if(copied > 0)
+            {
+                remaining -= static_cast<size_t>(copied);
+                continue;
+            }
+            if(copied < 0 && errno == EINTR) { continue; }
+            // EXDEV (cross-filesystem on older kernels), EINVAL, ENOSYS,
+            // EOPNOTSUPP, or a short file: fall back below. Any partial
+            // progress went through the shared page cache, so redoing the
+            // whole range is safe.
+            break;
+        }
+        if(remaining == 0) { return; }
+    }
+#endif // __linux__
+
+    // Fallback: copy through the mappings, streaming around the CPU cache
+    // for large ranges.
+    detail::nontemporal_copy(dest.data() + dst_offset,
+            source.data() + src_offset, clone_length);
+}
+
+} // namespace mio
+
+#endif // MIO_BASIC_MMAP_IMPL
+
+
+#endif // MIO_MMAP_HEADER
+
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if __cplusplus >= 202002L && defined(__cpp_impl_coroutine)
+# include <coroutine>
+# define MIO_HAS_COROUTINES 1
+#endif
+
+namespace mio {
+
+/**
+ * Result of an asynchronous operation that produces a value.
+ *
+ * The usual out-parameter error convention does not work across a
+ * completion boundary, so async operations deliver the value and its
+ * error code together. Check `error` before using `value`.
+ */
+template<typename T>
+struct async_result
+{
+    T value;                ///< The produced value; empty/default on error.
+    std::error_code error;  ///< The operation's error code.
+};
+
+// -----------------------------------------------------------------------------
+// async_engine - Worker pool for blocking mapping operations
+// -----------------------------------------------------------------------------
+
+/**
+ * Executes mapping, prefetch, and sync operations on a pool of worker
+ * threads, completing them through futures or C++20 awaitables.
+ *
+ * The engine is intentionally simple: a FIFO of type-erased operations
+ * drained by N workers. Each operation is one blocking mio call; the
+ * caller's thread never blocks on file or memory I/O, only on the
+ * future/awaitable when it chooses to.
+ *
+ * Mapped objects are produced and consumed across threads, which is safe:
+ * the engine touches a mapping only inside the submitted operation, and
+ * completion (future or coroutine resumption) synchronizes-with it.
+ *
+ * Ownership semantics: neither copyable nor movable; workers hold a
+ * reference to the engine. Destruction drains already-submitted work,
+ * then joins the workers.
+ */
+class async_engine
+{
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> queue_;
+    std::mutex mutex_;
+    std::condition_variable wakeup_;
+    bool stopping_ = false;
+
+    void worker_loop()
+    {
+        for(;;)
+        {
+            std::function<void()> op;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wakeup_.wait(lock, [this]
+                        { return stopping_ || !queue_.empty(); });
+                if(queue_.empty()) { return; } // stopping and drained
+                op = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            op();
+        }
+    }
+
+public:
+    /**
+     * Starts the engine with `num_threads` workers.
+     *
+     * @param num_threads Worker count; 0 selects hardware_concurrency().
+     */
+    explicit async_engine(size_t num_threads = 0)
+    {
+        if(num_threads == 0)
+        {
+            num_threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        workers_.reserve(num_threads);
+        for(size_t i = 0; i < num_threads; ++i)
+        {
+            workers_.emplace_back([this] { worker_loop(); });
+        }
+    }
+
+    /** Drains already-submitted operations, then joins the workers. */
+    ~async_engine()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wakeup_.notify_all();
+        for(auto& worker : workers_) { worker.join(); }
+    }
+
+    async_engine(const async_engine&) = delete;
+    async_engine& operator=(const async_engine&) = delete;
+
+    /** Returns the number of worker threads. */
+    [[nodiscard]] size_t thread_count() const noexcept
+    {
+        return workers_.size();
+    }
+
+    /**
+     * Submits an arbitrary operation for execution on a worker thread.
+     *
+     * Building block for the typed operations below; exposed for callers
+     * that need to run their own blocking mapping sequence off-thread.
+     *
+     * @param op The operation to run.
+     */
+    void submit(std::function<void()> op)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(std::move(op));
+        }
+        wakeup_.notify_one();
+    }
+
+    // -------------------------------------------------------------------------
+    // Future-based operations
+    // -------------------------------------------------------------------------
+
+    /**
+     * Asynchronously maps a whole file.
+     *
+     * @tparam MMap The mapping type to produce (e.g. mmap_source).
+     *
+     * @param path    Path of the file to map.
+     * @param options Mapping options.
+     * @return Future resolving to the mapping and its error code.
+     */
+    template<typename MMap = mmap_source>
+    [[nodiscard]] std::future<async_result<MMap>> map(
+            std::filesystem::path path, map_options options = {})
+    {
+        auto task = std::make_shared<std::promise<async_result<MMap>>>();
+        auto pending = task->get_future();
+        submit([task = std::move(task), path = std::move(path), options]
+        {
+            async_result<MMap> result;
+            result.value.map(path, 0, map_entire_file, options, result.error);
+            task->set_value(std::move(result));
+        });
+        return pending;
+    }
+
+    /**
+     * Asynchronously faults a range of a mapping into residency.
+     *
+     * Issues advice::will_need for bulk readahead, then touches the pages
+     * so that completion means the range is actually resident - all on a
+     * worker, so the consumer never takes the major faults itself.
+     *
+     * The mapping must stay alive until the operation completes.
+     *
+     * @param map    The mapping to prefetch into.
+     * @param offset Byte offset into the mapping.
+     * @param length Number of bytes, or `map_entire_file` for the rest.
+     * @return Future resolving to the operation's error code.
+     */
+    template<access_mode AccessMode, typename ByteT>
+    [[nodiscard]] std::future<std::error_code> prefetch(
+            basic_mmap<AccessMode, ByteT>& map,
+            const size_t offset, const size_t length)
+    {
+        auto task = std::make_shared<std::promise<std::error_code>>();
+        auto pending = task->get_future();
+        submit([task = std::move(task), &map, offset, length]
+        {
+            std::error_code error;
+            map.advise(advice::will_need, offset, length, error);
+            if(!error)
+            {
+                const size_t len = length == map_entire_file
+                        ? map.size() - offset : length;
+                detail::prefault(reinterpret_cast<const char*>(
+                        std::as_const(map).data()) + offset, len);
+            }
+            task->set_value(error);
+        });
+        return pending;
+    }
+
+    /**
+     * Asynchronously flushes a range of a writable mapping.
+     *
+     * The mapping must stay alive until the operation completes, and must
+     * not be concurrently written in the range being flushed if the caller
+     * needs a consistent on-disk image.
+     *
+     * @param map    The mapping to flush.
+     * @param offset Byte offset into the mapping.
+     * @param length Number of bytes, or `map_entire_file` for the rest.
+     * @param mode   Durability tier for the flush.
+     * @return Future resolving to the operation's error code.
+     */
+    template<typename ByteT>
+    [[nodiscard]] std::future<std::error_code> sync(
+            basic_mmap<access_mode::write, ByteT>& map,
+            const size_t offset, const size_t length,
+            const sync_mode mode = sync_mode::sync)
+    {
+        auto task = std::make_shared<std::promise<std::error_code>>();
+        auto pending = task->get_future();
+        submit([task = std::move(task), &map, offset, length, mode]
+        {
+            std::error_code error;
+            map.sync(offset, length, mode, error);
+            task->set_value(error);
+        });
+        return pending;
+    }
+
+#ifdef MIO_HAS_COROUTINES
+    // -------------------------------------------------------------------------
+    // C++20 awaitables
+    // -------------------------------------------------------------------------
+
+    /**
+     * Awaitable running an operation on the engine and resuming the
+     * coroutine, on a worker thread, with the operation's result.
+     */
+    template<typename T>
+    class [[nodiscard]] awaitable
+    {
+        friend class async_engine;
+
+        async_engine& engine_;
+        std::function<T()> op_;
+        T result_{};
+
+        awaitable(async_engine& engine, std::function<T()> op)
+            : engine_(engine), op_(std::move(op))
+        {}
+
+    public:
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> coroutine)
+        {
+            engine_.submit([this, coroutine]
+            {
+                result_ = op_();
+                coroutine.resume();
+            });
+        }
+
+        T await_resume() { return std::move(result_); }
+    };
+
+    /**
+     * co_await-able counterpart of map().
+     *
+     * @tparam MMap The mapping type to produce.
+     *
+     * @param path    Path of the file to map.
+     * @param options Mapping options.
+     * @return Awaitable yielding the mapping and its error code.
+     */
+    template<typename MMap = mmap_source>
+    [[nodiscard]] awaitable<async_result<MMap>> async_map(
+            std::filesystem::path path, map_options options = {})
+    {
+        return awaitable<async_result<MMap>>(*this,
+                [path = std::move(path), options]
+        {
+            async_result<MMap> result;
+            result.value.map(path, 0, map_entire_file, options, result.error);
+            return result;
+        });
+    }
+
+    /**
+     * co_await-able counterpart of prefetch().
+     *
+     * @param map    The mapping to prefetch into.
+     * @param offset Byte offset into the mapping.
+     * @param length Number of bytes, or `map_entire_file` for the rest.
+     * @return Awaitable yielding the operation's error code.
+     */
+    template<access_mode AccessMode, typename ByteT>
+    [[nodiscard]] awaitable<std::error_code> async_prefetch(
+            basic_mmap<AccessMode, ByteT>& map,
+            const size_t offset, const size_t length)
+    {
+        return awaitable<std::error_code>(*this, [&map, offset, length]
+        {
+            std::error_code error;
+            map.advise(advice::will_need, offset, length, error);
+            if(!error)
+            {
+                const size_t len = length == map_entire_file
+                        ? map.size() - offset : length;
+                detail::prefault(reinterpret_cast<const char*>(
+                        std::as_const(map).data()) + offset, len);
+            }
+            return error;
+        });
+    }
+
+    /**
+     * co_await-able counterpart of sync().
+     *
+     * @param map    The mapping to flush.
+     * @param offset Byte offset into the mapping.
+     * @param length Number of bytes, or `map_entire_file` for the rest.
+     * @param mode   Durability tier for the flush.
+     * @return Awaitable yielding the operation's error code.
+     */
+    template<typename ByteT>
+    [[nodiscard]] awaitable<std::error_code> async_sync(
+            basic_mmap<access_mode::write, ByteT>& map,
+            const size_t offset, const size_t length,
+            const sync_mode mode = sync_mode::sync)
+    {
+        return awaitable<std::error_code>(*this, [&map, offset, length, mode]
+        {
+            std::error_code error;
+            map.sync(offset, length, mode, error);
+            return error;
+        });
+    }
+#endif // MIO_HAS_COROUTINES
+};
+
+} // namespace mio
+
+#endif // MIO_ASYNC_HEADER
+/* Copyright 2017 https://github.com/mandreyel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MIO_FILE_SOURCE_HEADER
+#define MIO_FILE_SOURCE_HEADER
+
+// -----------------------------------------------------------------------------
+// file_source.hpp - Hybrid read/mmap file source selected by file size
+// -----------------------------------------------------------------------------
+//
+// This header provides basic_file_source, a read-only file view with the
+// same data()/begin()/end() interface as basic_mmap_source that picks the
+// cheaper I/O path per file: files at or under a size threshold are read
+// into an internal buffer with one pread()/ReadFile, larger files are
+// memory-mapped.
+//
+// Small files are mmap's worst case - the map + fault + munmap cycle
+// (plus the TLB shootdown at unmap) costs several times a single read
+// into a warm buffer, while for large files mapping avoids the copy
+// entirely. The hybrid gives callers one type and the right syscall path
+// for both size classes.
+//
+// Usage:
+//   std::error_code ec;
+//   mio::file_source meta;
+//   meta.open("shard-0007.meta", ec);   // ~4KB file: buffered read
+//   if (ec) { handle_error(ec); }
+//   parse(meta.data(), meta.size());
+//
+// The buffer is retained across open() calls on the same object, so a
+// loop reading many small files through one file_source reuses a single
+// allocation.
+//
+// -----------------------------------------------------------------------------
+
+// #include "mio/mmap.hpp"
+
+
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace mio {
+
+// -----------------------------------------------------------------------------
+// basic_file_source - Size-aware read path selection
+// -----------------------------------------------------------------------------
+
+/**
+ * A read-only view of a file that is buffered or memory-mapped depending
+ * on the file's size.
+ *
+ * Files at or under the threshold are read whole into an internal buffer
+ * and the file is closed before open() returns - no mapping, no page
+ * faults, no unmap shootdown. Larger files are memory-mapped as with
+ * basic_mmap_source. Which path was taken is observable through
+ * is_mapped(), but the read interface is identical either way.
+ *
+ * Unlike a mapping, a buffered view is a snapshot: later changes to the
+ * file are not reflected. Treat the view as valid-at-open in both modes.
+ *
+ * @tparam ByteT The byte type for the data. Must be 1 byte in size.
+ *
+ * Ownership semantics: move-only RAII, like basic_mmap.
+ */
+template<typename ByteT>
+class basic_file_source
+{
+public:
+    using mmap_type = basic_mmap_source<ByteT>;
+    using value_type = typename mmap_type::value_type;
+    using size_type = typename mmap_type::size_type;
+    using const_pointer = typename mmap_type::const_pointer;
+    using const_reference = typename mmap_type::const_reference;
+    using const_iterator = const_pointer;
+
+    static_assert(sizeof(ByteT) == 1, "ByteT must be 1 byte in size");
+
+    /// Default size threshold (64KB) at or under which files are buffered.
+    static constexpr size_type default_threshold = size_type(1) << 16;
+
+private:
+    mmap_type map_;
+    std::vector<value_type> buffer_;
+    // Handle backing the mapped path; basic_mmap treats handles it was
+    // given as caller-owned, so this class closes it.
+    file_handle_type owned_handle_ = invalid_handle;
+    size_type threshold_ = default_threshold;
+    bool buffered_ = false;
+
+public:
+    /**
+     * Constructs a closed source.
+     *
+     * @param threshold Files of this many bytes or fewer are buffered;
+     *                  larger ones are mapped. 0 maps everything.
+     */
+    explicit basic_file_source(
+            const size_type threshold = default_threshold) noexcept
+        : threshold_(threshold)
+    {}
+
+    basic_file_source(basic_file_source&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    // Manual moves: owned_handle_ is a plain scalar, so a defaulted move
+    // would leave it set in the moved-from object, whose close() would
+    // then close the fd the destination's mapping still depends on.
+    basic_file_source& operator=(basic_file_source&& other) noexcept
+    {
+        if(this != &other)
+        {
+            close();
+            map_ = std::move(other.map_);
+            buffer_ = std::move(other.buffer_);
+            owned_handle_ = std::exchange(other.owned_handle_,
+                    invalid_handle);
+            threshold_ = std::exchange(other.threshold_, default_threshold);
+            buffered_ = std::exchange(other.buffered_, false);
+        }
+        return *this;
+    }
+
+    basic_file_source(const basic_file_source&) = delete;
+    basic_file_source& operator=(const basic_file_source&) = delete;
+
+    /**
+     * Opens the file at `path`, buffering or mapping it by size.
+     *
+     * @param path  Path of the file to open.
+     * @param error Output parameter for error reporting.
+     */
+    void open(const std::filesystem::path& path, std::error_code& error)
+    {
+        error.clear();
+
+        const auto handle =
+                detail::open_file(path, access_mode::read, error);
+        if(error) { return; }
+
+        const auto file_size = detail::query_file_size(handle, error);
+        if(error)
+        {
+            detail::close_file(handle);
+            return;
+        }
+
+        if(static_cast<size_type>(file_size) > threshold_)
+        {
+            mmap_type map;
+            map.map(handle, 0, map_entire_file, error);
+            if(error)
+            {
+                detail::close_file(handle);
+                return;
+            }
+            close();
+            map_ = std::move(map);
+            // The mapping treats the handle as caller-owned; adopt it so
+            // unmapping through close() also closes the file.
+            owned_handle_ = handle;
+            return;
+        }
+
+        // Small file: one read into the (reused) buffer, then the file is
+        // closed - nothing to fault and nothing to tear down later.
+        std::vector<value_type> buffer;
+        buffer.swap(buffer_); // reuse the previous allocation
+        buffer.resize(static_cast<size_t>(file_size));
+        size_type total = 0;
+        while(total < static_cast<size_type>(file_size))
+        {
+#ifdef _WIN32
+            DWORD read = 0;
+            OVERLAPPED overlapped = {};
+            overlapped.Offset = detail::win::int64_low(
+                    static_cast<int64_t>(total));
+            overlapped.OffsetHigh = detail::win::int64_high(
+                    static_cast<int64_t>(total));
+            if(::ReadFile(handle, buffer.data() + total,
+                    static_cast<DWORD>(file_size - total),
+                    &read, &overlapped) == 0)
+            {
+                error = detail::last_error();
+                detail::close_file(handle);
+                return;
+            }
+#else
+            const ssize_t read = ::pread(handle, buffer.data() + total,
+                    static_cast<size_t>(file_size - total),
+                    static_cast<off_t>(total));
+            if(read < 0)
+            {
+                if(errno == EINTR) { continue; }
+                error = detail::last_error();
+                detail::close_file(handle);
+                return;
+            }
+#endif
+            if(read == 0) { break; } // file shrank underneath us
+            total += static_cast<size_type>(read);
+        }
+        detail::close_file(handle);
+
+        close();
+        buffer.resize(static_cast<size_t>(total));
+        buffer_ = std::move(buffer);
+        buffered_ = true;
+    }
+
+    /** Releases the buffer or mapping. Safe to call when closed. */
+    void close()
+    {
+        map_.unmap();
+        if(owned_handle_ != invalid_handle)
+        {
+            detail::close_file(owned_handle_);
+            owned_handle_ = invalid_handle;
+        }
+        buffer_.clear();
+        buffered_ = false;
+    }
+
+    ~basic_file_source() { close(); }
+
+    /** Returns whether a file is open. */
+    [[nodiscard]] bool is_open() const noexcept
+    {
+        return buffered_ || map_.is_open();
+    }
+
+    /** Returns whether the file was memory-mapped (vs buffered). */
+    [[nodiscard]] bool is_mapped() const noexcept { return map_.is_open(); }
+
+    /** Returns the buffering threshold in bytes. */
+    [[nodiscard]] size_type threshold() const noexcept { return threshold_; }
+
+    /** Returns the file size in bytes (0 when closed). */
+    [[nodiscard]] size_type size() const noexcept
+    {
+        return buffered_ ? static_cast<size_type>(buffer_.size())
+                : map_.size();
+    }
+
+    /** Returns whether the source is empty (closed or zero-length file). */
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+    /** Returns a pointer to the first byte of the data. */
+    [[nodiscard]] const_pointer data() const noexcept
+    {
+        return buffered_ ? buffer_.data() : map_.data();
+    }
+
+    /** Returns an iterator to the first byte. */
+    [[nodiscard]] const_iterator begin() const noexcept { return data(); }
+
+    /** Returns an iterator one past the last byte. */
+    [[nodiscard]] const_iterator end() const noexcept
+    {
+        return data() + size();
+    }
+
+    /** Returns the byte at index `i` (no bounds checking). */
+    [[nodiscard]] const_reference operator[](const size_type i) const noexcept
+    {
+        return data()[i];
+    }
+
+#if __cplusplus >= 202002L
+    /** Returns the data as a read-only std::span. */
+    [[nodiscard]] std::span<const value_type> as_span() const noexcept
+    {
+        return {data(), size()};
+    }
+#endif
+};
+
+// -----------------------------------------------------------------------------
+// Convenience type aliases
+// -----------------------------------------------------------------------------
+
+using file_source = basic_file_source<char>;           ///< Hybrid source, char
+using ufile_source = basic_file_source<unsigned char>; ///< Hybrid source, unsigned char
+using bfile_source = basic_file_source<std::byte>;     ///< Hybrid source, std::byte
+
+} // namespace mio
+
+#endif // MIO_FILE_SOURCE_HEADER
+/* Copyright 2017 https://github.com/mandreyel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MIO_MAPPING_POOL_HEADER
+#define MIO_MAPPING_POOL_HEADER
+
+// -----------------------------------------------------------------------------
+// mapping_pool.hpp - Reusable address-space reservation for high-churn mapping
+// -----------------------------------------------------------------------------
+//
+// This header provides mapping_pool, which reserves one large contiguous
+// PROT_NONE address range up front and serves read-only file mappings out
+// of fixed-size slots within it. Releasing a slot replaces its pages with
+// a fresh reservation instead of unmapping, so the slot can be reused by
+// the next file.
+//
+// Mapping and unmapping millions of small files through plain mmap()
+// pays, per cycle: a VMA allocation, an address-space search for a free
+// range, and - the expensive part on many-core hosts - an unmap-time TLB
+// shootdown broadcast to every thread in the process. With a pool, the
+// VMA count stays constant, the address-space search happens once, and
+// shootdowns are confined to one slot's worth of pages.
+//
+// Usage:
+//   std::error_code ec;
+//   mio::mapping_pool pool;
+//   pool.open(1 << 20, 256, ec);              // 256 slots of 1MiB
+//   auto view = pool.map_into_pool(path, ec); // mapped into a free slot
+//   scan(view.data(), view.size());
+//   // view's destructor recycles the slot
+//
+// The pool is thread-safe: slots may be acquired and released from any
+// thread. Views must not outlive the pool.
+//
+// On Windows, carving file views out of a reservation requires the
+// placeholder APIs (VirtualAlloc2/MapViewOfFile3, Windows 10 1803+),
+// which mio's minimum API level does not assume; there the pool falls
+// back to regular per-file mappings and only enforces the slot budget.
+//
+// -----------------------------------------------------------------------------
+
+// #include "mio/mmap.hpp"
+
+
+#include <mutex>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace mio {
+
+/**
+ * A pool of fixed-size address-space slots that read-only file mappings
+ * are recycled through.
+ *
+ * open() reserves slot_size * slot_count bytes of address space once
+ * (PROT_NONE, so it consumes no memory); map_into_pool() maps a file
+ * over a free slot with MAP_FIXED, and releasing the returned view
+ * re-reserves the slot for the next file. Files larger than a slot are
+ * rejected with std::errc::file_too_large - size slots for the largest
+ * file the workload produces.
+ *
+ * Ownership semantics: neither copyable nor movable; outstanding views
+ * hold a pointer to the pool.
+ */
+class mapping_pool
+{
+public:
+    /**
+     * A read-only view of a file mapped into a pool slot.
+     *
+     * Move-only RAII: the destructor (or release()) returns the slot to
+     * the pool. The view must be released before the pool is closed or
+     * destroyed.
+     */
+    class mapping
+    {
+        friend class mapping_pool;
+
+        mapping_pool* pool_ = nullptr;
+        size_t slot_ = 0;
+        const char* data_ = nullptr;
+        size_t size_ = 0;
+#ifdef _WIN32
+        basic_mmap_source<char> map_; // fallback mapping, no slot reuse
+#endif
+
+        mapping(mapping_pool* pool, const size_t slot, const char* data,
+                const size_t size) noexcept
+            : pool_(pool), slot_(slot), data_(data), size_(size)
+        {}
+
+    public:
+        mapping() = default;
+
+        mapping(mapping&& other) noexcept { *this = std::move(other); }
+
+        mapping& operator=(mapping&& other) noexcept
+        {
+            if(this != &other)
+            {
+                release();
+                pool_ = std::exchange(other.pool_, nullptr);
+                slot_ = std::exchange(other.slot_, 0);
+                data_ = std::exchange(other.data_, nullptr);
+                size_ = std::exchange(other.size_, 0);
+#ifdef _WIN32
+                map_ = std::move(other.map_);
+#endif
+            }
+            return *this;
+        }
+
+        mapping(const mapping&) = delete;
+        mapping& operator=(const mapping&) = delete;
+
+        ~mapping() { release(); }
+
+        /** Returns the slot to the pool. Safe to call when empty. */
+        void release()
+        {
+            if(pool_)
+            {
+#ifdef _WIN32
+                map_.unmap();
+#endif
+                pool_->release_slot(slot_);
+                pool_ = nullptr;
+                data_ = nullptr;
+                size_ = 0;
+            }
+        }
+
+        /** Returns whether the view holds a mapped file. */
+        [[nodiscard]] bool is_open() const noexcept { return pool_ != nullptr; }
+
+        /** Returns the file size in bytes. */
+        [[nodiscard]] size_t size() const noexcept { return size_; }
+
+        /** Returns whether the view is empty. */
+        [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+        /** Returns a pointer to the first byte of the file's data. */
+        [[nodiscard]] const char* data() const noexcept { return data_; }
+
+        /** Returns an iterator to the first byte. */
+        [[nodiscard]] const char* begin() const noexcept { return data_; }
+
+        /** Returns an iterator one past the last byte. */
+        [[nodiscard]] const char* end() const noexcept
+        {
+            return data_ + size_;
+        }
+
+        /** Returns the byte at index `i` (no bounds checking). */
+        [[nodiscard]] char operator[](const size_t i) const noexcept
+        {
+            return data_[i];
+        }
+
+#if __cplusplus >= 202002L
+        /** Returns the data as a read-only std::span. */
+        [[nodiscard]] std::span<const char> as_span() const noexcept
+        {
+            return {data_, size_};
+        }
+#endif
+    };
+
+private:
+    char* base_ = nullptr;
+    size_t slot_size_ = 0;
+    size_t slot_count_ = 0;
+    std::vector<size_t> free_slots_;
+    std::mutex mutex_;
+
+public:
+    mapping_pool() = default;
+
+    mapping_pool(const mapping_pool&) = delete;
+    mapping_pool& operator=(const mapping_pool&) = delete;
+
+    ~mapping_pool() { close(); }
+
+    /**
+     * Reserves the pool's address range.
+     *
+     * @param slot_size  Bytes per slot; rounded up to a page multiple.
+     *                   Files up to this size can be mapped into a slot.
+     * @param slot_count Number of slots, i.e. the maximum number of
+     *                   concurrently mapped files.
+     * @param error      Output parameter for error reporting.
+     */
+    void open(const size_t slot_size, const size_t slot_count,
+            std::error_code& error)
+    {
+        error.clear();
+
+        if(is_open() || slot_size == 0 || slot_count == 0)
+        {
+            error = std::make_error_code(std::errc::invalid_argument);
+            return;
+        }
+
+        const size_t page_mask = page_size() - 1;
+        const size_t aligned_slot = (slot_size + page_mask) & ~page_mask;
+
+#ifndef _WIN32
+        // One PROT_NONE reservation covers every slot. MAP_NORESERVE
+        // (where it exists) makes explicit that no swap is committed;
+        // PROT_NONE memory is never touched anyway.
+        const int flags = MAP_PRIVATE | MAP_ANONYMOUS
+#ifdef MAP_NORESERVE
+                | MAP_NORESERVE
+#endif
+                ;
+        void* const reservation = ::mmap(nullptr, aligned_slot * slot_count,
+                PROT_NONE, flags, -1, 0);
+        if(reservation == MAP_FAILED)
+        {
+            error = detail::last_error();
+            return;
+        }
+        base_ = static_cast<char*>(reservation);
+#endif // !_WIN32
+
+        slot_size_ = aligned_slot;
+        slot_count_ = slot_count;
+        free_slots_.clear();
+        free_slots_.reserve(slot_count);
+        // Hand out low slots first so a lightly loaded pool stays compact.
+        for(size_t slot = slot_count; slot > 0; --slot)
+        {
+            free_slots_.push_back(slot - 1);
+        }
+    }
+
+    /** Returns whether the pool has been opened. */
+    [[nodiscard]] bool is_open() const noexcept { return slot_count_ != 0; }
+
+    /** Returns the (page-aligned) slot size in bytes. */
+    [[nodiscard]] size_t slot_size() const noexcept { return slot_size_; }
+
+    /** Returns the total number of slots. */
+    [[nodiscard]] size_t slot_count() const noexcept { return slot_count_; }
+
+    /** Returns the number of currently unused slots. */
+    [[nodiscard]] size_t free_slots()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return free_slots_.size();
+    }
+
+    /**
+     * Maps the file at `path` read-only into a free slot.
+     *
+     * The file is opened, mapped over the slot's reserved pages, and
+     * closed again before returning; the returned view keeps the mapping
+     * alive. Errors: std::errc::file_too_large if the file exceeds the
+     * slot size, std::errc::no_buffer_space if every slot is in use,
+     * plus the usual open/mmap failures.
+     *
+     * @param path  Path of the file to map.
+     * @param error Output parameter for error reporting.
+     * @return The mapped view; empty on error.
+     */
+    template<typename Path>
+    mapping map_into_pool(const Path& path, std::error_code& error)
+    {
+        error.clear();
+
+        if(!is_open())
+        {
+            error = std::make_error_code(std::errc::bad_file_descriptor);
+            return {};
+        }
+
+#ifndef _WIN32
+        // The full-arity overload resolves to the allocation-free native
+        // open_file() when `path` is a const char*.
+        const auto handle = detail::open_file(path, access_mode::read,
+                false, advice::normal, error);
+        if(error) { return {}; }
+
+        const auto file_size = detail::query_file_size(handle, error);
+        if(error)
+        {
+            detail::close_file(handle);
+            return {};
+        }
+        if(file_size > slot_size_)
+        {
+            detail::close_file(handle);
+            error = std::make_error_code(std::errc::file_too_large);
+            return {};
+        }
+
+        size_t slot = 0;
+        if(!acquire_slot(slot))
+        {
+            detail::close_file(handle);
+            error = std::make_error_code(std::errc::no_buffer_space);
+            return {};
+        }
+
+        char* const address = base_ + slot * slot_size_;
+        if(file_size > 0)
+        {
+            // MAP_FIXED replaces the slot's reservation pages in place:
+            // no address-space search and no new VMA beyond the split.
+            if(::mmap(address, file_size, PROT_READ, MAP_SHARED | MAP_FIXED,
+                    handle, 0) == MAP_FAILED)
+            {
+                error = detail::last_error();
+                detail::close_file(handle);
+                release_slot(slot);
+                return {};
+            }
+        }
+        // The mapping keeps the file referenced; the descriptor is not
+        // needed anymore.
+        detail::close_file(handle);
+
+        return mapping(this, slot, address, file_size);
+#else // _WIN32
+        // Fallback: a regular mapping at a system-chosen address. The
+        // slot budget still applies so callers see uniform behavior.
+        size_t slot = 0;
+        if(!acquire_slot(slot))
+        {
+            error = std::make_error_code(std::errc::no_buffer_space);
+            return {};
+        }
+
+        basic_mmap_source<char> map;
+        map.map(path, error);
+        if(error)
+        {
+            release_slot(slot);
+            return {};
+        }
+        if(map.size() > slot_size_)
+        {
+            release_slot(slot);
+            error = std::make_error_code(std::errc::file_too_large);
+            return {};
+        }
+
+        mapping view(this, slot, map.data(), map.size());
+        view.map_ = std::move(map);
+        view.data_ = view.map_.data();
+        return view;
+#endif // _WIN32
+    }
+
+    /**
+     * Releases the pool's address range.
+     *
+     * All views must have been released first; closing with slots still
+     * in use fails with std::errc::device_or_resource_busy.
+     *
+     * @param error Output parameter for error reporting.
+     */
+    void close(std::error_code& error)
+    {
+        error.clear();
+        if(!is_open()) { return; }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if(free_slots_.size() != slot_count_)
+            {
+                error = std::make_error_code(
+                        std::errc::device_or_resource_busy);
+                return;
+            }
+        }
+#ifndef _WIN32
+        ::munmap(base_, slot_size_ * slot_count_);
+#endif
+        base_ = nullptr;
+        slot_size_ = 0;
+        slot_count_ = 0;
+        free_slots_.clear();
+    }
+
+    /** Destructor variant of close(): outstanding views become dangling. */
+    void close()
+    {
+#ifndef _WIN32
+        if(base_) { ::munmap(base_, slot_size_ * slot_count_); }
+#endif
+        base_ = nullptr;
+        slot_size_ = 0;
+        slot_count_ = 0;
+        free_slots_.clear();
+    }
+
+private:
+    bool acquire_slot(size_t& slot)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if(free_slots_.empty()) { return false; }
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+        return true;
+    }
+
+    void release_slot(const size_t slot)
+    {
+#ifndef _WIN32
+        // Replace the file pages with a fresh PROT_NONE reservation in
+        // one call. This shoots down only this slot's TLB entries and
+        // keeps the address range reserved for the next file.
+        if(base_)
+        {
+            const int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED
+#ifdef MAP_NORESERVE
+                    | MAP_NORESERVE
+#endif
+                    ;
+            ::mmap(base_ + slot * slot_size_, slot_size_, PROT_NONE, flags,
+                    -1, 0);
+        }
+#endif // !_WIN32
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_slots_.push_back(slot);
+    }
+};
+
+} // namespace mio
+
+#endif // MIO_MAPPING_POOL_HEADER
+/* Copyright 2017 https://github.com/mandreyel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MIO_MEMORY_RESOURCE_HEADER
+#define MIO_MEMORY_RESOURCE_HEADER
+
+// -----------------------------------------------------------------------------
+// memory_resource.hpp - std::pmr allocation out of a memory mapping
+// -----------------------------------------------------------------------------
+//
+// This header provides mapped_memory_resource, a std::pmr::memory_resource
+// that carves allocations out of a single mapping - file-backed or
+// anonymous - with bump-pointer allocation and whole-arena release.
+//
+// Building a large intermediate structure (hash table, sorted run) in heap
+// containers and copying it into a mapping at the end of a stage pays for
+// the data twice; pmr containers allocating directly inside the mapping
+// pay once, can be persisted with sync(), and the whole arena is reclaimed
+// in O(1) by release() - one madvise instead of running destructors over
+// millions of nodes.
+//
+// Usage:
+//   std::error_code ec;
+//   mio::mapped_memory_resource arena;
+//   arena.open("run-0.bin", 1 << 30, ec);           // or open_anonymous()
+//   if (ec) { handle_error(ec); }
+//   std::pmr::vector<entry> entries(&arena);
+//   ... build ...
+//   arena.sync(ec);                                  // persist the stage
+//   arena.release();                                 // O(1) reclaim, reuse
+//
+// Deallocation is a no-op (monotonic); the arena's memory is reused only
+// after release(). Trivially-destructible element types skip destructor
+// runs entirely; types with owning destructors still need them run before
+// release(), as with std::pmr::monotonic_buffer_resource.
+//
+// -----------------------------------------------------------------------------
+
+// #include "mio/mmap.hpp"
+
+
+#include <filesystem>
+#include <memory_resource>
+#include <new>
+#include <system_error>
+
+namespace mio {
+
+// -----------------------------------------------------------------------------
+// mapped_memory_resource - Bump allocator over a single mapping
+// -----------------------------------------------------------------------------
+
+/**
+ * A std::pmr::memory_resource allocating from a memory-mapped arena.
+ *
+ * Allocation bumps an offset through the mapping; deallocate() is a no-op
+ * and release() rewinds the whole arena at once. When the arena is
+ * exhausted, allocation throws std::bad_alloc (the pmr contract) - there
+ * is no upstream resource, since falling back to the heap would silently
+ * defeat the point of placing the data in the mapping.
+ *
+ * Ownership semantics: neither copyable nor movable - containers hold a
+ * raw pointer to their memory_resource, so the object must stay put for
+ * the lifetime of everything allocated from it.
+ *
+ * Thread safety: none, like monotonic_buffer_resource; use one arena per
+ * thread or synchronize externally.
+ */
+class mapped_memory_resource final : public std::pmr::memory_resource
+{
+    basic_mmap_sink<char> map_;
+    size_t offset_ = 0;
+
+public:
+    /** Constructs a closed arena; open one of the backings before use. */
+    mapped_memory_resource() = default;
+
+    mapped_memory_resource(const mapped_memory_resource&) = delete;
+    mapped_memory_resource& operator=(const mapped_memory_resource&) = delete;
+
+    /**
+     * Opens a file-backed arena of `capacity` bytes at `path`.
+     *
+     * The file is created if missing and grown to the capacity (it is
+     * never truncated), so a fresh path yields a zeroed arena and the
+     * arena's contents can be persisted with sync() and re-mapped later.
+     *
+     * @param path     Path of the backing file.
+     * @param capacity Size of the arena in bytes.
+     * @param error    Output parameter for error reporting.
+     */
+    void open(const std::filesystem::path& path, const size_t capacity,
+            std::error_code& error)
+    {
+        map_options options;
+        options.create = true;
+        open(path, capacity, options, error);
+    }
+
+    /**
+     * Opens a file-backed arena with explicit mapping options.
+     *
+     * options.create is forced on; the other options (huge pages, NUMA
+     * placement, prefaulting) apply as for any write mapping.
+     *
+     * @param path     Path of the backing file.
+     * @param capacity Size of the arena in bytes.
+     * @param options  Mapping options for the arena.
+     * @param error    Output parameter for error reporting.
+     */
+    void open(const std::filesystem::path& path, const size_t capacity,
+            map_options options, std::error_code& error)
+    {
+        options.create = true;
+        map_.map(path, 0, capacity, options, error);
+        if(!error) { offset_ = 0; }
+    }
+
+    /**
+     * Opens an anonymous arena of `capacity` bytes.
+     *
+     * Backed by demand-zero memory: nothing to persist, but release()
+     * still reclaims the pages in O(1).
+     *
+     * @param capacity Size of the arena in bytes.
+     * @param error    Output parameter for error reporting.
+     */
+    void open_anonymous(const size_t capacity, std::error_code& error)
+    {
+        map_.map_anonymous(capacity, error);
+        if(!error) { offset_ = 0; }
+    }
+
+    /** Returns whether an arena is open. */
+    [[nodiscard]] bool is_open() const noexcept { return map_.is_open(); }
+
+    /** Returns the arena size in bytes (0 when closed). */
+    [[nodiscard]] size_t capacity() const noexcept { return map_.size(); }
+
+    /** Returns the number of bytes allocated (including alignment waste). */
+    [[nodiscard]] size_t used() const noexcept { return offset_; }
+
+    /** Returns the number of bytes still allocatable. */
+    [[nodiscard]] size_t remaining() const noexcept
+    {
+        return map_.size() - offset_;
+    }
+
+    /** Returns the underlying mapping, e.g. for advise() or residency(). */
+    [[nodiscard]] const basic_mmap_sink<char>& mapping() const noexcept
+    {
+        return map_;
+    }
+
+    /**
+     * Rewinds the arena: every allocation is invalidated and the full
+     * capacity becomes available again.
+     *
+     * The backing pages are released with advice::dont_need so physical
+     * memory is reclaimed immediately instead of lingering until memory
+     * pressure; the hint is best-effort and its failure is ignored.
+     */
+    void release() noexcept
+    {
+        offset_ = 0;
+        if(map_.is_open())
+        {
+            std::error_code ignored;
+            map_.advise(advice::dont_need, ignored);
+        }
+    }
+
+    /**
+     * Flushes the allocated prefix of a file-backed arena to disk.
+     *
+     * A no-op for anonymous arenas. Only the used part of the arena is
+     * written back; the untouched tail has no dirty pages anyway.
+     *
+     * @param error Output parameter for error reporting.
+     */
+    void sync(std::error_code& error)
+    {
+        error.clear();
+        if(offset_ == 0) { return; }
+        map_.sync(0, offset_, sync_mode::sync, error);
+    }
+
+    /** Unmaps the arena. Allocations are invalidated. */
+    void close()
+    {
+        map_.unmap();
+        offset_ = 0;
+    }
+
+protected:
+    void* do_allocate(const size_t bytes, const size_t alignment) override
+    {
+        // Bump the offset to the requested alignment; alignment is a power
+        // of two per the memory_resource contract, and the mapping itself
+        // is page-aligned, so aligning the offset aligns the pointer.
+        const size_t aligned = (offset_ + alignment - 1) & ~(alignment - 1);
+        if(!map_.is_open() || aligned < offset_
+           || aligned > map_.size() || bytes > map_.size() - aligned)
+        {
+            throw std::bad_alloc();
+        }
+        offset_ = aligned + bytes;
+        return map_.data() + aligned;
+    }
+
+    void do_deallocate(void*, size_t, size_t) override
+    {
+        // Monotonic: individual deallocation is a no-op; release() or
+        // close() reclaims everything at once.
+    }
+
+    [[nodiscard]] bool do_is_equal(
+            const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+};
+
+} // namespace mio
+
+#endif // MIO_MEMORY_RESOURCE_HEADER
+/* Copyright 2017 https://github.com/mandreyel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MIO_MMAP_BATCH_HEADER
+#define MIO_MMAP_BATCH_HEADER
+
+// -----------------------------------------------------------------------------
+// mmap_batch.hpp - Batch mapping of many files in parallel
+// -----------------------------------------------------------------------------
+//
+// This header provides map_files(), which maps a list of files and returns
+// one mapping per path. The open/fstat/mmap sequence behind each mapping is
+// cheap individually, but serialized syscall latency dominates when mapping
+// hundreds of thousands of small files at startup; map_files() spreads the
+// work across a temporary pool of threads, turning minutes of serial opens
+// into seconds.
+//
+// Errors are reported per file: one missing or unreadable file leaves an
+// empty mapping and an error code in its slot without aborting the batch.
+//
+// Usage:
+//   std::vector<std::filesystem::path> paths = list_segment_files();
+//   std::vector<std::error_code> errors;
+//   auto segments = mio::map_files(paths, errors);
+//   for (size_t i = 0; i < segments.size(); ++i) {
+//       if (errors[i]) { log_skip(paths[i], errors[i]); continue; }
+//       index.add(segments[i]);
+//   }
+//
+// -----------------------------------------------------------------------------
+
+// #include "mio/mmap.hpp"
+
+
+#include <algorithm>
+#include <atomic>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace mio {
+
+// -----------------------------------------------------------------------------
+// map_files - Parallel batch mapping
+// -----------------------------------------------------------------------------
+
+/**
+ * Maps every file in `paths`, parallelizing the per-file open + mmap
+ * sequence across up to hardware_concurrency() threads.
+ *
+ * Results and errors are positional: result[i] is the mapping of paths[i],
+ * and errors[i] is its error code. A failed file yields an empty mapping
+ * (is_open() == false) and a set error code; the rest of the batch is
+ * unaffected.
+ *
+ * The mappings are whole-file, like the single-path factories without an
+ * explicit range.
+ *
+ * @tparam MMap The mapping type to produce (e.g. mmap_source, mmap_sink,
+ *              or any basic_mmap instantiation).
+ *
+ * @param paths   The files to map.
+ * @param options Mapping options applied to every file.
+ * @param errors  Per-file error codes, resized to match `paths`.
+ * @return One mapping per path, in the same order.
+ */
+template<typename MMap = mmap_source>
+std::vector<MMap> map_files(const std::vector<std::filesystem::path>& paths,
+        const map_options& options, std::vector<std::error_code>& errors)
+{
+    std::vector<MMap> results(paths.size());
+    errors.assign(paths.size(), std::error_code());
+    if(paths.empty()) { return results; }
+
+    const size_t num_threads = std::min<size_t>(
+            std::max(1u, std::thread::hardware_concurrency()), paths.size());
+
+    // Workers claim file indices from a shared counter, so fast files do
+    // not idle a thread while a slow one (cold metadata, network fs)
+    // finishes elsewhere.
+    std::atomic<size_t> next_index{0};
+    const auto worker = [&]
+    {
+        for(size_t i = next_index.fetch_add(1, std::memory_order_relaxed);
+                i < paths.size();
+                i = next_index.fetch_add(1, std::memory_order_relaxed))
+        {
+            results[i].map(paths[i], 0, map_entire_file, options, errors[i]);
+        }
+    };
+
+    if(num_threads == 1)
+    {
+        worker();
+        return results;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for(size_t t = 0; t < num_threads; ++t) { threads.emplace_back(worker); }
+    for(auto& thread : threads) { thread.join(); }
+    return results;
+}
+
+/**
+ * Maps every file in `paths` with default options.
+ *
+ * Convenience overload of map_files(paths, options, errors).
+ *
+ * @tparam MMap The mapping type to produce.
+ *
+ * @param paths  The files to map.
+ * @param errors Per-file error codes, resized to match `paths`.
+ * @return One mapping per path, in the same order.
+ */
+template<typename MMap = mmap_source>
+std::vector<MMap> map_files(const std::vector<std::filesystem::path>& paths,
+        std::vector<std::error_code>& errors)
+{
+    return map_files<MMap>(paths, map_options(), errors);
+}
+
+} // namespace mio
+
+#endif // MIO_MMAP_BATCH_HEADER
+/* Copyright 2017 https://github.com/mandreyel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MIO_MMAP_STREAM_HEADER
+#define MIO_MMAP_STREAM_HEADER
+
+// -----------------------------------------------------------------------------
+// mmap_stream.hpp - Pipelined sequential reading of memory-mapped files
+// -----------------------------------------------------------------------------
+//
+// This header provides basic_mmap_stream, a read-once sequential reader over
+// a memory-mapped file. Iterating a plain mmap_source sequentially has two
+// costs the kernel's readahead only partially hides: the consumer stalls on
+// every readahead miss, and pages that have been consumed stay resident,
+// polluting the page cache for the rest of the job.
+//
+// The stream divides the mapping into fixed-size windows and drives an
+// advice pipeline from the iterator: while the consumer iterates window k,
+// windows k+1..k+depth are prefetched with advice::will_need (asynchronous
+// readahead at device bandwidth), and windows the consumer has fully passed
+// are released with advice::dont_need. The consumer thus runs against warm
+// pages with near-zero resident overhead, through the same iterator
+// interface as mmap.hpp.
+//
+// Usage:
+//   std::error_code ec;
+//   mio::mmap_stream log;
+//   log.open("service.log", ec);
+//   if (ec) { handle_error(ec); }
+//   for (const char c : log) { consume(c); }
+//
+// The pipeline is advisory: iterators remain valid regardless of window
+// state, and released pages are transparently re-read on access. Iterating
+// a stream twice works but re-reads the file from disk.
+//
+// -----------------------------------------------------------------------------
+
+// #include "mio/mmap.hpp"
+
+
+#include <algorithm>
+#include <iterator>
+#include <system_error>
+
+namespace mio {
+
+// -----------------------------------------------------------------------------
+// basic_mmap_stream - Read-once sequential reader with window prefetch
+// -----------------------------------------------------------------------------
+
+/**
+ * A sequential, read-once view of a memory-mapped file with pipelined
+ * prefetch and eager release of consumed pages.
+ *
+ * The file is mapped whole (so the data is addressable and iterators are
+ * plain pointers underneath), but residency is managed in windows: the
+ * iterator prefetches ahead of the read position and drops what it has
+ * passed. Random access through data() still works - the stream only adds
+ * hints, never restrictions.
+ *
+ * @tparam ByteT The byte type for the mapped data. Must be 1 byte in size.
+ *
+ * Ownership semantics: move-only RAII, like basic_mmap.
+ *
+ * Thread safety: none; one consumer per stream. Separate streams over the
+ * same file are independent.
+ */
+template<typename ByteT>
+class basic_mmap_stream
+{
+public:
+    using mmap_type = basic_mmap_source<ByteT>;
+    using value_type = typename mmap_type::value_type;
+    using size_type = typename mmap_type::size_type;
+    using const_pointer = typename mmap_type::const_pointer;
+    using const_reference = typename mmap_type::const_reference;
+
+    /// Default prefetch window size (4MB); rounded up to a page multiple.
+    static constexpr size_type default_window_size = size_type(1) << 22;
+
+    /// Default number of windows kept in flight ahead of the read position.
+    static constexpr size_type default_prefetch_depth = 2;
+
+private:
+    mmap_type map_;
+    size_type window_size_ = default_window_size;
+    size_type prefetch_depth_ = default_prefetch_depth;
+    size_type prefetched_end_ = 0;  ///< Bytes already submitted for readahead.
+    size_type released_end_ = 0;    ///< Bytes already released behind the reader.
+
+    /**
+     * Advances the advice pipeline when the reader crosses into the window
+     * containing `offset`: releases the windows it has fully passed and
+     * tops the readahead back up to the configured depth. Failures are
+     * ignored - the pipeline is purely advisory.
+     */
+    void advance_pipeline(const size_type offset)
+    {
+        std::error_code ignored;
+        const size_type window_start = offset / window_size_ * window_size_;
+
+        if(window_start > released_end_)
+        {
+            map_.advise(advice::dont_need, released_end_,
+                    window_start - released_end_, ignored);
+            released_end_ = window_start;
+        }
+
+        const size_type target = std::min(
+                window_start + (prefetch_depth_ + 1) * window_size_,
+                map_.size());
+        if(target > prefetched_end_)
+        {
+            map_.advise(advice::will_need, prefetched_end_,
+                    target - prefetched_end_, ignored);
+            prefetched_end_ = target;
+        }
+    }
+
+public:
+    /**
+     * Read-only forward iterator that drives the prefetch pipeline.
+     *
+     * Dereference and comparison are pointer operations; the only overhead
+     * over a raw pointer is one comparison per increment against the next
+     * window boundary. Crossing a boundary advances the pipeline.
+     */
+    class iterator
+    {
+        friend class basic_mmap_stream;
+
+        const_pointer ptr_ = nullptr;
+        const_pointer boundary_ = nullptr;  ///< Next window crossing (or end).
+        basic_mmap_stream* stream_ = nullptr;
+
+        iterator(const_pointer ptr, basic_mmap_stream* stream) noexcept
+            : ptr_(ptr), stream_(stream)
+        {
+            if(stream_ != nullptr) { update_boundary(); }
+        }
+
+        void update_boundary() noexcept
+        {
+            const size_type offset = static_cast<size_type>(
+                    ptr_ - stream_->data());
+            const size_type next = std::min(
+                    (offset / stream_->window_size() + 1)
+                            * stream_->window_size(),
+                    stream_->size());
+            boundary_ = stream_->data() + next;
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = typename mmap_type::value_type;
+        using difference_type = typename mmap_type::difference_type;
+        using pointer = typename mmap_type::const_pointer;
+        using reference = typename mmap_type::const_reference;
+
+        iterator() = default;
+
+        [[nodiscard]] reference operator*() const noexcept { return *ptr_; }
+        [[nodiscard]] pointer operator->() const noexcept { return ptr_; }
+
+        iterator& operator++()
+        {
+            ++ptr_;
+            if(ptr_ == boundary_ && ptr_ != stream_->data() + stream_->size())
+            {
+                stream_->advance_pipeline(static_cast<size_type>(
+                        ptr_ - stream_->data()));
+                update_boundary();
+            }
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            iterator tmp = *this;
+            ++(*this);
+            return tmp;
+        }
+
+        [[nodiscard]] friend bool operator==(const iterator& a,
+                const iterator& b) noexcept { return a.ptr_ == b.ptr_; }
+        [[nodiscard]] friend bool operator!=(const iterator& a,
+                const iterator& b) noexcept { return a.ptr_ != b.ptr_; }
+    };
+
+    using const_iterator = iterator;
+
+    /**
+     * Constructs a closed stream.
+     *
+     * @param window_size    Size of each pipeline window in bytes; rounded
+     *                       up to a multiple of the page size on open().
+     * @param prefetch_depth Number of windows kept in flight ahead of the
+     *                       read position.
+     */
+    explicit basic_mmap_stream(
+            const size_type window_size = default_window_size,
+            const size_type prefetch_depth = default_prefetch_depth)
+        : window_size_(window_size), prefetch_depth_(prefetch_depth)
+    {}
+
+    basic_mmap_stream(basic_mmap_stream&&) = default;
+    basic_mmap_stream& operator=(basic_mmap_stream&&) = default;
+    basic_mmap_stream(const basic_mmap_stream&) = delete;
+    basic_mmap_stream& operator=(const basic_mmap_stream&) = delete;
+
+    /**
+     * Opens and maps the file at `path` and primes the readahead pipeline.
+     *
+     * @param path  Path of the file to stream.
+     * @param error Output parameter for error reporting.
+     */
+    void open(const std::filesystem::path& path, std::error_code& error)
+    {
+        error.clear();
+
+        if(window_size_ == 0)
+        {
+            error = std::make_error_code(std::errc::invalid_argument);
+            return;
+        }
+
+        mmap_type map;
+        map.map(path, error);
+        if(error) { return; }
+
+        map_ = std::move(map);
+        const size_type page_size_ = page_size();
+        window_size_ = (window_size_ + page_size_ - 1) / page_size_ * page_size_;
+        prefetched_end_ = released_end_ = 0;
+
+        // Tell the kernel the access pattern up front and kick off the
+        // first windows; failures are harmless.
+        std::error_code ignored;
+        map_.advise(advice::sequential, ignored);
+        advance_pipeline(0);
+    }
+
+    /** Unmaps the file. Safe to call on a closed stream (no-op). */
+    void close() { map_.unmap(); }
+
+    /** Returns whether a file is open. */
+    [[nodiscard]] bool is_open() const noexcept { return map_.is_open(); }
+
+    /** Returns the file size in bytes (0 when closed). */
+    [[nodiscard]] size_type size() const noexcept { return map_.size(); }
+
+    /** Returns whether the stream is empty (closed or zero-length file). */
+    [[nodiscard]] bool empty() const noexcept { return map_.empty(); }
+
+    /** Returns the (page-rounded) pipeline window size in bytes. */
+    [[nodiscard]] size_type window_size() const noexcept { return window_size_; }
+
+    /** Returns the configured prefetch depth in windows. */
+    [[nodiscard]] size_type prefetch_depth() const noexcept
+    {
+        return prefetch_depth_;
+    }
+
+    /** Returns a pointer to the start of the mapped data. */
+    [[nodiscard]] const_pointer data() const noexcept { return map_.data(); }
+
+    /** Returns an iterator to the first byte. */
+    [[nodiscard]] iterator begin() noexcept { return iterator(data(), this); }
+
+    /** Returns an iterator one past the last byte. */
+    [[nodiscard]] iterator end() noexcept
+    {
+        return iterator(data() + size(), this);
+    }
+};
+
+// -----------------------------------------------------------------------------
+// Convenience type aliases
+// -----------------------------------------------------------------------------
+
+using mmap_stream = basic_mmap_stream<char>;           ///< Streaming reader, char
+using ummap_stream = basic_mmap_stream<unsigned char>; ///< Streaming reader, unsigned char
+using bmmap_stream = basic_mmap_stream<std::byte>;     ///< Streaming reader, std::byte
+
+} // namespace mio
+
+#endif // MIO_MMAP_STREAM_HEADER
+/* Copyright 2017 https://github.com/mandreyel
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef MIO_MMAP_WINDOW_HEADER
+#define MIO_MMAP_WINDOW_HEADER
+
+// -----------------------------------------------------------------------------
+// mmap_window.hpp - Windowed access to files too large to map whole
+// -----------------------------------------------------------------------------
+//
+// This header provides basic_mmap_window, which exposes a file of arbitrary
+// size through a bounded set of page-aligned mapped windows with LRU
+// replacement, instead of one mapping spanning the whole file.
+//
+// Mapping a multi-terabyte file in one piece works, but is expensive in ways
+// that scale with mapping size rather than with the bytes actually touched:
+// the kernel's bookkeeping for the region, page-table teardown on unmap, and
+// the address space consumed all grow with the mapping. A windowed mapper
+// bounds all three while keeping mmap's zero-copy access model: view() hands
+// out direct pointers into the page cache, remapping windows only on miss.
+//
+// Usage:
+//   std::error_code ec;
+//   mio::mmap_window_source archive;
+//   archive.open("huge-archive.bin", ec);
+//   if (ec) { handle_error(ec); }
+//
+//   // Pointer valid until max_windows() later view() calls (LRU eviction)
+//   const char* record = archive.view(record_offset, record_size, ec);
+//
+// Pointer validity:
+// A pointer returned by view() stays valid until its window is evicted, which
+// can happen on any later view() miss. Callers that hold views across many
+// lookups should size max_windows accordingly or copy the data out.
+//
+// -----------------------------------------------------------------------------
+
+// #include "mio/mmap.hpp"
+
+
+#include <algorithm>
+#include <cstdint>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace mio {
+
+// -----------------------------------------------------------------------------
+// basic_mmap_window - Bounded-footprint view over a large file
+// -----------------------------------------------------------------------------
+
+/**
+ * Exposes a file of arbitrary size through a fixed budget of mapped windows.
+ *
+ * Windows are aligned to a grid of window_size bytes, so repeated views into
+ * the same region reuse one mapping. A view that straddles a grid boundary
+ * gets a window extended to cover it, so view() never fails for ranges up to
+ * the file size. When the window budget is exhausted, the least recently
+ * used window is unmapped.
+ *
+ * Template parameters mirror basic_mmap:
+ * @tparam AccessMode `access_mode::read` or `access_mode::write`.
+ * @tparam ByteT      The byte type for the mapped data. Must be 1 byte in size.
+ *
+ * Ownership semantics:
+ * - Move-only, like basic_mmap: the object owns the file handle and windows.
+ * - RAII: destruction unmaps all windows and closes the file.
+ *
+ * Thread safety: none. The window set is mutated by view(); callers sharing
+ * one instance across threads must synchronize externally (or give each
+ * thread its own instance, which the kernel page cache deduplicates anyway).
+ */
+template<
+    access_mode AccessMode,
+    typename ByteT
+> class basic_mmap_window
+{
+public:
+    using mmap_type = basic_mmap<AccessMode, ByteT>;
+    using value_type = typename mmap_type::value_type;
+    using size_type = typename mmap_type::size_type;
+    using pointer = typename mmap_type::pointer;
+    using const_pointer = typename mmap_type::const_pointer;
+    using handle_type = typename mmap_type::handle_type;
+
+    /**
+     * Pointer type returned by view(): const for read-only mappers, mutable
+     * for sinks, mirroring basic_mmap's data() overloads.
+     */
+    using view_pointer = std::conditional_t<
+            AccessMode == access_mode::read, const_pointer, pointer>;
+
+    /// Default window size (64MB); always rounded up to a page multiple.
+    static constexpr size_type default_window_size = size_type(1) << 26;
+
+    /// Default number of simultaneously mapped windows.
+    static constexpr size_type default_max_windows = 16;
+
+private:
+    /// One mapped window and the bookkeeping for LRU replacement.
+    struct window
+    {
+        size_type start;    ///< File offset of the window's first byte.
+        mmap_type map;      ///< The mapping covering [start, start + map.size()).
+        uint64_t last_use;  ///< Stamp of the most recent view() hit.
+    };
+
+    std::vector<window> windows_;
+    handle_type file_handle_ = invalid_handle;
+    size_type file_size_ = 0;
+    size_type window_size_ = default_window_size;
+    size_type max_windows_ = default_max_windows;
+    uint64_t use_counter_ = 0;
+
+    /// Start-of-data pointer with the right constness for the access mode.
+    static view_pointer window_data(mmap_type& map) noexcept
+    {
+        if constexpr(AccessMode == access_mode::read)
+        {
+            return std::as_const(map).data();
+        }
+        else
+        {
+            return map.data();
+        }
+    }
+
+public:
+    /**
+     * Constructs a closed windowed mapper.
+     *
+     * @param window_size Size of each window in bytes; rounded up to a
+     *                    multiple of the page size on open().
+     * @param max_windows Maximum number of simultaneously mapped windows
+     *                    (must be at least 1).
+     */
+    explicit basic_mmap_window(
+            const size_type window_size = default_window_size,
+            const size_type max_windows = default_max_windows)
+        : window_size_(window_size), max_windows_(max_windows)
+    {}
+
+    ~basic_mmap_window() { close(); }
+
+    /** Moving transfers the file handle and all windows. */
+    basic_mmap_window(basic_mmap_window&& other) noexcept
+        : windows_(std::move(other.windows_))
+        , file_handle_(other.file_handle_)
+        , file_size_(other.file_size_)
+        , window_size_(other.window_size_)
+        , max_windows_(other.max_windows_)
+        , use_counter_(other.use_counter_)
+    {
+        other.windows_.clear();
+        other.file_handle_ = invalid_handle;
+        other.file_size_ = 0;
+    }
+
+    /** @copydoc basic_mmap_window(basic_mmap_window&&) */
+    basic_mmap_window& operator=(basic_mmap_window&& other) noexcept
+    {
+        if(this != &other)
+        {
+            close();
+            windows_ = std::move(other.windows_);
+            file_handle_ = other.file_handle_;
+            file_size_ = other.file_size_;
+            window_size_ = other.window_size_;
+            max_windows_ = other.max_windows_;
+            use_counter_ = other.use_counter_;
+            other.windows_.clear();
+            other.file_handle_ = invalid_handle;
+            other.file_size_ = 0;
+        }
+        return *this;
+    }
+
+    // Windows own kernel resources; copying is not meaningful.
+    basic_mmap_window(const basic_mmap_window&) = delete;
+    basic_mmap_window& operator=(const basic_mmap_window&) = delete;
+
+    /** Returns whether a file is open. */
+    [[nodiscard]] bool is_open() const noexcept
+    {
+        return file_handle_ != invalid_handle;
+    }
+
+    /** Returns the size of the open file in bytes (0 when closed). */
+    [[nodiscard]] size_type file_size() const noexcept { return file_size_; }
+
+    /** Returns the (page-rounded) window size in bytes. */
+    [[nodiscard]] size_type window_size() const noexcept { return window_size_; }
+
+    /** Returns the window budget. */
+    [[nodiscard]] size_type max_windows() const noexcept { return max_windows_; }
+
+    /** Returns the number of currently mapped windows. */
+    [[nodiscard]] size_type mapped_windows() const noexcept
+    {
+        return windows_.size();
+    }
+
+    /**
+     * Opens the file at `path` for windowed access.
+     *
+     * No mapping is established yet; windows are created lazily by view().
+     * A zero window budget or a zero window size is rejected, as is a file
+     * that cannot be opened for the access mode.
+     *
+     * @param path  Path of the file to open.
+     * @param error Output parameter for error reporting.
+     */
+    void open(const std::filesystem::path& path, std::error_code& error)
+    {
+        error.clear();
+
+        if(max_windows_ == 0 || window_size_ == 0)
+        {
+            error = std::make_error_code(std::errc::invalid_argument);
+            return;
+        }
+
+        const auto handle = detail::open_file(path, AccessMode, error);
+        if(error) { return; }
+        const auto file_size = detail::query_file_size(handle, error);
+        if(error)
+        {
+            detail::close_file(handle);
+            return;
+        }
+
+        close();
+        file_handle_ = handle;
+        file_size_ = file_size;
+        // Round the window size up to a page multiple so grid-aligned
+        // window starts are valid mapping offsets.
+        const size_type page_size_ = page_size();
+        window_size_ = (window_size_ + page_size_ - 1) / page_size_ * page_size_;
+        windows_.reserve(max_windows_);
+    }
+
+    /**
+     * Returns a pointer to `length` contiguous mapped bytes at `offset`.
+     *
+     * On a hit the call is a lookup over the (small) window set; on a miss
+     * one window is mapped, evicting the least recently used window if the
+     * budget is exhausted. The returned pointer stays valid until the
+     * backing window is evicted by a later view() miss.
+     *
+     * @param offset File offset of the first byte of the view.
+     * @param length Number of bytes the view must cover; the range must lie
+     *               within the file.
+     * @param error  Output parameter for error reporting.
+     * @return Pointer to the first byte of the view, or nullptr on error.
+     */
+    [[nodiscard]] view_pointer view(const size_type offset, const size_type length,
+            std::error_code& error)
+    {
+        error.clear();
+
+        if(!is_open())
+        {
+            error = std::make_error_code(std::errc::bad_file_descriptor);
+            return nullptr;
+        }
+        if(offset > file_size_ || length > file_size_ - offset)
+        {
+            error = std::make_error_code(std::errc::invalid_argument);
+            return nullptr;
+        }
+
+        // Fast path: a mapped window already covers the range.
+        for(auto& w : windows_)
+        {
+            if(offset >= w.start && offset + length <= w.start + w.map.size())
+            {
+                w.last_use = ++use_counter_;
+                return window_data(w.map) + (offset - w.start);
+            }
+        }
+
+        // Miss: map the grid window containing offset, extended to cover a
+        // range that straddles a grid boundary and clamped to the file.
+        const size_type start = offset / window_size_ * window_size_;
+        const size_type end = std::min(
+                std::max(start + window_size_, offset + length), file_size_);
+
+        mmap_type map;
+        map.map(file_handle_, start, end - start, error);
+        if(error) { return nullptr; }
+
+        if(windows_.size() >= max_windows_)
+        {
+            auto lru = windows_.begin();
+            for(auto it = std::next(lru); it != windows_.end(); ++it)
+            {
+                if(it->last_use < lru->last_use) { lru = it; }
+            }
+            // Reuse the evicted slot instead of erase+push_back.
+            lru->start = start;
+            lru->map = std::move(map);
+            lru->last_use = ++use_counter_;
+            return window_data(lru->map) + (offset - start);
+        }
+
+        windows_.push_back(window{start, std::move(map), ++use_counter_});
+        return window_data(windows_.back().map) + (offset - start);
+    }
+
+    /**
+     * Unmaps all windows and closes the file.
+     *
+     * Outstanding view() pointers are invalidated. Safe to call on a closed
+     * object (no-op).
+     */
+    void close()
     {
-#ifdef _WIN32
-        // Windows: Flush the view, then flush the file buffers
-        // FlushViewOfFile writes to system cache; FlushFileBuffers writes to disk
-        if(::FlushViewOfFile(get_mapping_start(), mapped_length_) == 0
-           || ::FlushFileBuffers(file_handle_) == 0)
-#else // POSIX
-        // POSIX: msync with MS_SYNC for synchronous write
-        if(::msync(get_mapping_start(), mapped_length_, MS_SYNC) != 0)
-#endif
+        windows_.clear();
+        if(file_handle_ != invalid_handle)
         {
-            error = detail::last_error();
-            return;
+            detail::close_file(file_handle_);
+            file_handle_ = invalid_handle;
         }
+        file_size_ = 0;
+        use_counter_ = 0;
     }
-}
+};
 
-/**
- * Unmaps the file and releases resources.
+// -----------------------------------------------------------------------------
+// Convenience type aliases
+// -----------------------------------------------------------------------------
+
+/// Read-only windowed mapper template over the byte type.
+template<typename ByteT>
+using basic_mmap_window_source = basic_mmap_window<access_mode::read, ByteT>;
+
+/// Read-write windowed mapper template over the byte type.
+template<typename ByteT>
+using basic_mmap_window_sink = basic_mmap_window<access_mode::write, ByteT>;
+
+using mmap_window_source = basic_mmap_window_source<char>;           ///< Read-only, char
+using ummap_window_source = basic_mmap_window_source<unsigned char>; ///< Read-only, unsigned char
+using bmmap_window_source = basic_mmap_window_source<std::byte>;     ///< Read-only, std::byte
+
+using mmap_window_sink = basic_mmap_window_sink<char>;           ///< Read-write, char
+using ummap_window_sink = basic_mmap_window_sink<unsigned char>; ///< Read-write, unsigned char
+using bmmap_window_sink = basic_mmap_window_sink<std::byte>;     ///< Read-write, std::byte
+
+} // namespace mio
+
+#endif // MIO_MMAP_WINDOW_HEADER
+/* Copyright 2017 https://github.com/mandreyel
  *
- * Performs cleanup in the following order:
- * 1. Unmap the memory region
- * 2. Close file mapping handle (Windows only)
- * 3. Close file handle (only if opened internally via path)
- * 4. Reset all member variables to default state
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
  *
- * Calling unmap() on an already-unmapped object is safe (no-op).
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE
+ * OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
-template<access_mode AccessMode, typename ByteT>
-void basic_mmap<AccessMode, ByteT>::unmap()
-{
-    if(!is_open()) { return; }
 
-    // Step 1: Unmap the memory region
-#ifdef _WIN32
-    if(is_mapped())
-    {
-        ::UnmapViewOfFile(get_mapping_start());
-        ::CloseHandle(file_mapping_handle_);
-    }
-#else // POSIX
-    if(data_) { ::munmap(const_cast<pointer>(get_mapping_start()), mapped_length_); }
-#endif
+#ifndef MIO_PARALLEL_HEADER
+#define MIO_PARALLEL_HEADER
 
-    // Step 2: Close file handle if we opened it (internal handle)
-    // External handles (provided by user) are NOT closed
-    if(is_handle_internal_)
-    {
-#ifdef _WIN32
-        ::CloseHandle(file_handle_);
-#else // POSIX
-        ::close(file_handle_);
-#endif
-    }
+// -----------------------------------------------------------------------------
+// parallel.hpp - Parallel chunked algorithms over mapped regions
+// -----------------------------------------------------------------------------
+//
+// This header provides parallel drivers for scanning a mapping with
+// multiple threads: parallel_for_each_chunk() applies a functor to
+// page-aligned chunks of the mapping, and parallel_reduce_chunk()
+// additionally combines per-chunk results into one value.
+//
+// Scanning a cold mapping with std::for_each is both single-threaded and
+// fault-bound: every major fault stalls the one thread at device latency.
+// The drivers here run chunks on a thread pool with dynamic chunk claiming
+// (so skewed per-chunk costs rebalance automatically) and advise each
+// claimed chunk plus a lookahead chunk with `will_need`, which starts
+// kernel readahead for upcoming data while the current chunk computes.
+//
+// Usage:
+//   mio::mmap_source map("big.bin", ec);
+//   const uint64_t sum = mio::parallel_reduce_chunk(map,
+//           1 << 22, uint64_t{0},
+//           [](const char* data, size_t size, size_t) {
+//               return checksum(data, size);
+//           },
+//           std::plus<uint64_t>{});
+//
+// The functor is called concurrently from pool threads and must be safe
+// to run in parallel on disjoint chunks. Exceptions it throws are
+// captured and the first one is rethrown on the calling thread after all
+// workers have stopped.
+//
+// -----------------------------------------------------------------------------
 
-    // Step 3: Reset to default (unmapped) state
-    data_ = nullptr;
-    length_ = mapped_length_ = 0;
-    file_handle_ = invalid_handle;
-#ifdef _WIN32
-    file_mapping_handle_ = invalid_handle;
-#endif
-}
+// #include "mio/mmap.hpp"
 
-/**
- * Checks if the memory mapping exists.
- *
- * On Windows, checks the file mapping handle (distinct from file handle).
- * On POSIX, equivalent to is_open().
- */
-template<access_mode AccessMode, typename ByteT>
-bool basic_mmap<AccessMode, ByteT>::is_mapped() const noexcept
-{
-#ifdef _WIN32
-    return file_mapping_handle_ != invalid_handle;
-#else // POSIX
-    return is_open();
-#endif
-}
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace mio {
+
+namespace detail {
 
 /**
- * Swaps contents with another mmap.
- *
- * Efficiently exchanges all state without any system calls.
+ * Shared driver: partitions `map` into page-aligned chunks and invokes
+ * `chunk_op(chunk_index, data, size, offset)` across `thread_count`
+ * threads. Chunks are claimed from a shared atomic counter - the same
+ * dynamic load balancing work stealing provides, without per-thread
+ * deques - and each claim advises its own chunk plus the chunk
+ * `thread_count` claims ahead with `will_need`, overlapping readahead
+ * with compute.
  */
-template<access_mode AccessMode, typename ByteT>
-void basic_mmap<AccessMode, ByteT>::swap(basic_mmap& other) noexcept
+template<typename MMap, typename ChunkOp>
+void parallel_chunk_driver(MMap& map, const size_t chunk_size,
+        const size_t thread_count, ChunkOp chunk_op)
 {
-    if(this != &other)
+    if(!map.is_open() || map.empty()) { return; }
+
+    // Chunk boundaries must be page-aligned so each worker's advise()
+    // calls and faults touch disjoint pages. Page sizes are powers of
+    // two, so rounding up is a mask.
+    const size_t page_mask = page_size() - 1;
+    const size_t chunk_bytes = std::max(
+            (chunk_size + page_mask) & ~page_mask, page_size());
+    const size_t chunk_count = (map.size() + chunk_bytes - 1) / chunk_bytes;
+    const size_t workers = std::max<size_t>(1,
+            std::min(thread_count, chunk_count));
+
+    std::atomic<size_t> next_chunk(0);
+    std::mutex error_mutex;
+    std::exception_ptr first_error;
+
+    const auto worker = [&](){
+        for(;;)
+        {
+            const size_t chunk = next_chunk.fetch_add(1,
+                    std::memory_order_relaxed);
+            if(chunk >= chunk_count) { return; }
+
+            const size_t offset = chunk * chunk_bytes;
+            const size_t size = std::min(chunk_bytes, map.size() - offset);
+
+            // Kick off readahead for this chunk and for the chunk this
+            // worker is likely to claim next; the kernel faults it in
+            // while the current chunk computes. Purely advisory.
+            std::error_code ignored;
+            map.advise(advice::will_need, offset, size, ignored);
+            const size_t lookahead = chunk + workers;
+            if(lookahead < chunk_count)
+            {
+                const size_t lookahead_offset = lookahead * chunk_bytes;
+                map.advise(advice::will_need, lookahead_offset,
+                        std::min(chunk_bytes, map.size() - lookahead_offset),
+                        ignored);
+            }
+
+            try
+            {
+                // The mapping is taken by non-const reference for
+                // advise(); read through the const accessor so read-only
+                // mappings work.
+                chunk_op(chunk, std::as_const(map).data() + offset, size,
+                        offset);
+            }
+            catch(...)
+            {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if(!first_error)
+                {
+                    first_error = std::current_exception();
+                }
+                return;
+            }
+        }
+    };
+
+    if(workers == 1)
     {
-        using std::swap;
-        swap(data_, other.data_);
-        swap(file_handle_, other.file_handle_);
-#ifdef _WIN32
-        swap(file_mapping_handle_, other.file_mapping_handle_);
-#endif
-        swap(length_, other.length_);
-        swap(mapped_length_, other.mapped_length_);
-        swap(is_handle_internal_, other.is_handle_internal_);
+        worker();
     }
-}
-
-/**
- * Conditionally syncs based on access mode.
- *
- * Called from destructor. Uses `if constexpr` for compile-time dispatch:
- * - Write mode: Calls sync() (ignoring errors in destructor context)
- * - Read mode: No-op
- */
-template<access_mode AccessMode, typename ByteT>
-void basic_mmap<AccessMode, ByteT>::conditional_sync()
-{
-    if constexpr (AccessMode == access_mode::write) {
-        // Destructor can't handle errors, so we just try our best
-        std::error_code ec;
-        sync(ec);
-        // Error intentionally ignored - destructor shouldn't throw
+    else
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(workers);
+        for(size_t i = 0; i < workers; ++i)
+        {
+            threads.emplace_back(worker);
+        }
+        for(auto& thread : threads) { thread.join(); }
     }
-    // For read mode: nothing to do
+
+    if(first_error) { std::rethrow_exception(first_error); }
 }
 
-// -----------------------------------------------------------------------------
-// Comparison operators
-// -----------------------------------------------------------------------------
+} // namespace detail
 
 /**
- * Equality: Same data pointer and size.
+ * Applies `fn` to page-aligned chunks of the mapping in parallel.
+ *
+ * The mapping is split into chunks of `chunk_size` bytes rounded up to a
+ * page multiple (the final chunk holds the remainder); `fn(data, size,
+ * offset)` is invoked once per chunk from a pool of `thread_count`
+ * threads, where `offset` is the chunk's byte offset into the mapping.
+ * Chunks are claimed dynamically, so uneven per-chunk costs keep all
+ * threads busy, and each claim prefetches ahead with `will_need` so
+ * faulting overlaps compute.
+ *
+ * A closed or empty mapping is a no-op. The first exception thrown by
+ * `fn` is rethrown on the calling thread once all workers have stopped;
+ * remaining chunks may be skipped.
+ *
+ * @param map          The mapping to scan (any access mode; non-const
+ *                     because advise() mutates kernel state).
+ * @param chunk_size   Requested chunk size in bytes; rounded up to a page
+ *                     multiple, minimum one page.
+ * @param fn           Functor invoked as fn(const ByteT* data, size_t
+ *                     size, size_t offset); must be safe to call
+ *                     concurrently on disjoint chunks.
+ * @param thread_count Number of worker threads; defaults to the hardware
+ *                     concurrency.
  */
-template<access_mode AccessMode, typename ByteT>
-bool operator==(const basic_mmap<AccessMode, ByteT>& a,
-        const basic_mmap<AccessMode, ByteT>& b)
-{
-    return a.data() == b.data()
-        && a.size() == b.size();
-}
-
-template<access_mode AccessMode, typename ByteT>
-bool operator!=(const basic_mmap<AccessMode, ByteT>& a,
-        const basic_mmap<AccessMode, ByteT>& b)
+template<typename MMap, typename Fn>
+void parallel_for_each_chunk(MMap& map, const size_t chunk_size, Fn fn,
+        const size_t thread_count = std::thread::hardware_concurrency())
 {
-    return !(a == b);
+    detail::parallel_chunk_driver(map, chunk_size, thread_count,
+            [&fn](const size_t, const auto* data, const size_t size,
+                    const size_t offset)
+            {
+                fn(data, size, offset);
+            });
 }
 
 /**
- * Ordering: Compare by data pointer first, then by size.
+ * Reduces the mapping to a single value over page-aligned chunks in
+ * parallel.
+ *
+ * `chunk_fn(data, size, offset)` maps each chunk to a value of type `T`
+ * and `combine(T, T)` merges values. `combine` must be associative;
+ * chunks are combined in an unspecified order, so it should also be
+ * commutative unless all runs use one thread. Scheduling, prefetching,
+ * and exception behavior match parallel_for_each_chunk().
+ *
+ * @param map          The mapping to scan.
+ * @param chunk_size   Requested chunk size in bytes; rounded up to a page
+ *                     multiple, minimum one page.
+ * @param init         Identity value the reduction starts from.
+ * @param chunk_fn     Functor invoked as chunk_fn(const ByteT* data,
+ *                     size_t size, size_t offset) -> T.
+ * @param combine      Binary functor merging two T values.
+ * @param thread_count Number of worker threads; defaults to the hardware
+ *                     concurrency.
+ * @return The combined value, or `init` for a closed or empty mapping.
  */
-template<access_mode AccessMode, typename ByteT>
-bool operator<(const basic_mmap<AccessMode, ByteT>& a,
-        const basic_mmap<AccessMode, ByteT>& b)
-{
-    if(a.data() == b.data()) { return a.size() < b.size(); }
-    return a.data() < b.data();
-}
-
-template<access_mode AccessMode, typename ByteT>
-bool operator<=(const basic_mmap<AccessMode, ByteT>& a,
-        const basic_mmap<AccessMode, ByteT>& b)
-{
-    return !(a > b);
-}
-
-template<access_mode AccessMode, typename ByteT>
-bool operator>(const basic_mmap<AccessMode, ByteT>& a,
-        const basic_mmap<AccessMode, ByteT>& b)
-{
-    if(a.data() == b.data()) { return a.size() > b.size(); }
-    return a.data() > b.data();
-}
-
-template<access_mode AccessMode, typename ByteT>
-bool operator>=(const basic_mmap<AccessMode, ByteT>& a,
-        const basic_mmap<AccessMode, ByteT>& b)
+template<typename MMap, typename T, typename ChunkFn, typename Combine>
+T parallel_reduce_chunk(MMap& map, const size_t chunk_size, T init,
+        ChunkFn chunk_fn, Combine combine,
+        const size_t thread_count = std::thread::hardware_concurrency())
 {
-    return !(a < b);
+    std::mutex result_mutex;
+    T result = std::move(init);
+    detail::parallel_chunk_driver(map, chunk_size, thread_count,
+            [&](const size_t, const auto* data, const size_t size,
+                    const size_t offset)
+            {
+                T partial = chunk_fn(data, size, offset);
+                std::lock_guard<std::mutex> lock(result_mutex);
+                result = combine(std::move(result), std::move(partial));
+            });
+    return result;
 }
 
 } // namespace mio
 
-#endif // MIO_BASIC_MMAP_IMPL
-
-
-#endif // MIO_MMAP_HEADER
+#endif // MIO_PARALLEL_HEADER
 /* Copyright 2017 https://github.com/mandreyel
  *
  * Permission is hereby granted, free of charge, to any person obtaining a copy of this
@@ -2050,6 +7727,10 @@ bool operator>=(const basic_mmap<AccessMode, ByteT>& a,
 #include <cassert>
 #include <system_error>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <utility>
 
 namespace mio {
 
@@ -2353,7 +8034,7 @@ public:
      *
      * @return Const pointer to mapped data, or nullptr if not mapped.
      */
-    [[nodiscard]] const_pointer data() const noexcept { return pimpl_ ? pimpl_->data() : nullptr; }
+    [[nodiscard]] const_pointer data() const noexcept { return pimpl_ ? std::as_const(*pimpl_).data() : nullptr; }
 
     // -------------------------------------------------------------------------
     // Iterator access
@@ -2376,7 +8057,7 @@ public:
     /** @copydoc begin() */
     [[nodiscard]] const_iterator begin() const noexcept {
         assert(pimpl_ && "begin() called on empty shared_mmap");
-        return pimpl_->begin();
+        return std::as_const(*pimpl_).begin();
     }
 
     /** @copydoc begin() */
@@ -2402,7 +8083,7 @@ public:
     /** @copydoc end() */
     [[nodiscard]] const_iterator end() const noexcept {
         assert(pimpl_ && "end() called on empty shared_mmap");
-        return pimpl_->end();
+        return std::as_const(*pimpl_).end();
     }
 
     /** @copydoc end() */
@@ -2427,7 +8108,7 @@ public:
     /** @copydoc rbegin() */
     [[nodiscard]] const_reverse_iterator rbegin() const noexcept {
         assert(pimpl_ && "rbegin() called on empty shared_mmap");
-        return pimpl_->rbegin();
+        return std::as_const(*pimpl_).rbegin();
     }
 
     /** @copydoc rbegin() */
@@ -2452,7 +8133,7 @@ public:
     /** @copydoc rend() */
     [[nodiscard]] const_reverse_iterator rend() const noexcept {
         assert(pimpl_ && "rend() called on empty shared_mmap");
-        return pimpl_->rend();
+        return std::as_const(*pimpl_).rend();
     }
 
     /** @copydoc rend() */
@@ -2482,7 +8163,7 @@ public:
     /** @copydoc operator[]() */
     [[nodiscard]] const_reference operator[](const size_type i) const noexcept {
         assert(pimpl_ && "operator[] called on empty shared_mmap");
-        return (*pimpl_)[i];
+        return std::as_const(*pimpl_)[i];
     }
 
     // -------------------------------------------------------------------------
@@ -2832,6 +8513,148 @@ shared_mmap_sink make_shared_mmap_sink(const MappingToken& token, std::error_cod
     return make_shared_mmap_sink(token, 0, map_entire_file, error);
 }
 
+// -----------------------------------------------------------------------------
+// mmap_registry - Process-wide deduplication of read-only mappings
+// -----------------------------------------------------------------------------
+
+/**
+ * Process-wide registry resolving concurrent opens of the same file to one
+ * underlying mapping.
+ *
+ * Two independent `make_shared_mmap_source("same/file")` calls create two
+ * kernel mappings and two file handles even though the page cache backs
+ * both with the same physical pages. For workloads that open the same hot
+ * files from many threads, the registry collapses those into a single
+ * mapping: opens of an already-mapped file are a stat + hash lookup instead
+ * of an open + mmap syscall pair, and the process's file handle and VMA
+ * counts stay proportional to the number of distinct files.
+ *
+ * Files are keyed by on-disk identity (device + inode / volume + file
+ * index), so different paths to the same file - symlinks, hard links,
+ * relative paths - share one mapping. Entries are weak references: the
+ * mapping lives for as long as any returned shared_mmap_source does, and
+ * expired entries are reclaimed lazily (or eagerly via purge()).
+ *
+ * Only whole-file read-only mappings are deduplicated; write mappings have
+ * caller-visible lifetime semantics (sync on destruction) that sharing
+ * would silently change.
+ *
+ * Thread safety: all members are safe to call concurrently. Lookups take a
+ * shared lock, so the hot path scales across reader threads; only a miss
+ * (first open of a file) takes the exclusive lock.
+ *
+ * Opt-in: use mio::make_cached_mmap_source() or instance() directly;
+ * mappings made through the regular factories never enter the registry.
+ */
+class mmap_registry
+{
+public:
+    /** Returns the process-wide registry instance. */
+    static mmap_registry& instance()
+    {
+        static mmap_registry registry;
+        return registry;
+    }
+
+    /**
+     * Opens a whole-file read-only mapping, reusing a live mapping of the
+     * same file if one exists.
+     *
+     * @param path  Path of the file to map.
+     * @param error Output parameter for error reporting.
+     * @return A shared_mmap_source sharing the deduplicated mapping; empty
+     *         on error.
+     */
+    shared_mmap_source open(const std::filesystem::path& path,
+            std::error_code& error)
+    {
+        error.clear();
+
+        const detail::file_id id = detail::query_file_id(path, error);
+        if(error) { return {}; }
+
+        // Fast path: the file is already mapped.
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex_);
+            const auto it = cache_.find(id);
+            if(it != cache_.end())
+            {
+                if(auto existing = it->second.lock())
+                {
+                    return shared_mmap_source(std::move(existing));
+                }
+            }
+        }
+
+        // Miss: map the file under the exclusive lock. Re-check the cache
+        // first - another thread may have mapped it while we waited.
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        const auto it = cache_.find(id);
+        if(it != cache_.end())
+        {
+            if(auto existing = it->second.lock())
+            {
+                return shared_mmap_source(std::move(existing));
+            }
+        }
+
+        mmap_source map;
+        map.map(path, error);
+        if(error) { return {}; }
+
+        auto shared = std::make_shared<mmap_source>(std::move(map));
+        cache_[id] = shared;
+        return shared_mmap_source(std::move(shared));
+    }
+
+    /** Returns the number of live (non-expired) mappings in the registry. */
+    [[nodiscard]] size_t size() const
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        size_t count = 0;
+        for(const auto& entry : cache_)
+        {
+            if(!entry.second.expired()) { ++count; }
+        }
+        return count;
+    }
+
+    /** Drops expired entries (mappings whose last owner has gone away). */
+    void purge()
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        for(auto it = cache_.begin(); it != cache_.end();)
+        {
+            if(it->second.expired()) { it = cache_.erase(it); }
+            else { ++it; }
+        }
+    }
+
+private:
+    mmap_registry() = default;
+
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<detail::file_id, std::weak_ptr<mmap_source>,
+            detail::file_id_hash> cache_;
+};
+
+/**
+ * Creates a whole-file read-only mapping through the process-wide registry.
+ *
+ * Equivalent to mmap_registry::instance().open(path, error): concurrent
+ * opens of the same file (by any path reaching it) share one underlying
+ * mapping and file handle.
+ *
+ * @param path  Path of the file to map.
+ * @param error Output parameter for error reporting.
+ * @return A shared_mmap_source sharing the deduplicated mapping.
+ */
+inline shared_mmap_source make_cached_mmap_source(
+        const std::filesystem::path& path, std::error_code& error)
+{
+    return mmap_registry::instance().open(path, error);
+}
+
 } // namespace mio
 
 #endif // MIO_SHARED_MMAP_HEADER
@@ -1,5 +1,14 @@
+#include <mio/async.hpp>
+#include <mio/file_source.hpp>
+#include <mio/mapping_pool.hpp>
+#include <mio/memory_resource.hpp>
 #include <mio/mmap.hpp>
+#include <mio/mmap_batch.hpp>
+#include <mio/mmap_stream.hpp>
+#include <mio/mmap_window.hpp>
+#include <mio/parallel.hpp>
 #include <mio/shared_mmap.hpp>
+#include <mio/stats.hpp>
 
 #include <string>
 #include <fstream>
@@ -8,7 +17,9 @@
 #include <cassert>
 #include <system_error>
 #include <numeric>
+#include <algorithm>
 #include <filesystem>
+#include <vector>
 
 #ifndef _WIN32
 #include <sys/types.h>
@@ -94,6 +105,9 @@ int main()
         CHECK_INVALID_MMAP(m);
         m = mio::make_mmap_source(std::string(), 0, 0, error);
         CHECK_INVALID_MMAP(m);
+        // The native const char* fast path rejects empty strings too.
+        m = mio::make_mmap_source("", 0, 0, error);
+        CHECK_INVALID_MMAP(m);
 
         // Invalid handle?
         m = mio::make_mmap_source(mio::invalid_handle, 0, 0, error);
@@ -104,6 +118,1194 @@ int main()
         CHECK_INVALID_MMAP(m);
     }
 
+    // Test memory-access advice.
+    {
+        mio::mmap_source m = mio::make_mmap_source(path, 0, mio::map_entire_file, error);
+        assert(!error);
+        m.advise(mio::advice::random, error);
+        assert(!error);
+        m.advise(mio::advice::sequential, 0, m.size(), error);
+        assert(!error);
+        // Subrange with an unaligned offset must be aligned internally.
+        m.advise(mio::advice::will_need, page_size - 3, 100, error);
+        assert(!error);
+        m.advise(mio::advice::dont_need, error);
+        assert(!error);
+        // Out-of-range advice is rejected.
+        m.advise(mio::advice::normal, m.size() + 1, 1, error);
+        assert(error);
+        error.clear();
+        // Advice on an unmapped object is rejected.
+        mio::mmap_source closed;
+        closed.advise(mio::advice::normal, error);
+        assert(error);
+        error.clear();
+    }
+
+    // Test page granularity reporting and huge-page fallback.
+    {
+        mio::mmap_source m = mio::make_mmap_source(path, 0, mio::map_entire_file, error);
+        assert(!error);
+        assert(m.page_granularity() == page_size);
+
+        // A huge-page request on a regular file falls back to normal pages
+        // (with THP advice on Linux) rather than failing.
+        mio::mmap_source huge;
+        mio::map_options options;
+        options.pages = mio::page_mode::huge;
+        huge.map(path, 0, mio::map_entire_file, options, error);
+        assert(!error);
+        assert(huge.is_open());
+        assert(huge.page_granularity() != 0);
+        [[maybe_unused]] const auto& huge_view = huge;
+        [[maybe_unused]] const auto& m_view = m;
+        assert(huge_view[0] == m_view[0]);
+
+        mio::mmap_source unmapped;
+        assert(unmapped.page_granularity() == 0);
+    }
+
+    // Test range-based sync with durability tiers.
+    {
+        mio::mmap_sink sink = mio::make_mmap_sink(path, 0, mio::map_entire_file, error);
+        assert(!error);
+        const char original = sink[page_size + 3];
+        sink[page_size + 3] = '!';
+
+        // Flush just the dirty range at each tier.
+        sink.sync(page_size + 3, 1, error);
+        assert(!error);
+        sink.sync(page_size + 3, 1, mio::sync_mode::async, error);
+        assert(!error);
+        sink.sync(page_size + 3, 1, mio::sync_mode::full, error);
+        assert(!error);
+        // Whole-mapping flush from an offset.
+        sink.sync(0, mio::map_entire_file, error);
+        assert(!error);
+
+        // Out-of-range flush is rejected.
+        sink.sync(sink.size() + 1, 1, error);
+        assert(error);
+        error.clear();
+
+        // Verify the flushed byte reached the file, then restore it.
+        {
+            mio::mmap_source check = mio::make_mmap_source(path, 0, mio::map_entire_file, error);
+            assert(!error);
+            [[maybe_unused]] const auto& check_view = check;
+            assert(check_view[page_size + 3] == '!');
+        }
+        sink[page_size + 3] = original;
+        sink.sync(error);
+        assert(!error);
+    }
+
+    // Test create-and-grow mapping of a nonexistent file.
+    {
+        const char* create_path = "test-file-created";
+        std::filesystem::remove(create_path);
+
+        mio::map_options options;
+        options.create = true;
+        const size_t create_size = 2 * page_size + 1;
+        mio::mmap_sink sink = mio::make_mmap_sink(create_path, 0, create_size, options, error);
+        assert(!error);
+        assert(sink.is_open());
+        assert(sink.size() == create_size);
+        assert(std::filesystem::file_size(create_path) == create_size);
+        // Newly created bytes read as zero and are writable.
+        assert(sink[0] == 0);
+        sink[create_size - 1] = 'x';
+        sink.sync(error);
+        assert(!error);
+
+        // Remapping an existing, large-enough file with create set must not
+        // shrink it.
+        sink.map(create_path, 0, page_size, options, error);
+        assert(!error);
+        assert(std::filesystem::file_size(create_path) == create_size);
+
+        // create is rejected for read-only mappings.
+        mio::mmap_source src;
+        src.map(create_path, 0, page_size, options, error);
+        assert(error);
+        error.clear();
+
+        sink.unmap();
+        std::filesystem::remove(create_path);
+    }
+
+    // Test in-place resize of a growing mapping.
+    {
+        const char* resize_path = "test-file-resized";
+        std::filesystem::remove(resize_path);
+
+        mio::map_options options;
+        options.create = true;
+        mio::mmap_sink sink = mio::make_mmap_sink(resize_path, 0, page_size, options, error);
+        assert(!error);
+        sink[0] = 'a';
+        sink[page_size - 1] = 'z';
+
+        // Grow: previously written bytes survive, new bytes are zero.
+        sink.resize(3 * page_size, error);
+        assert(!error);
+        assert(sink.size() == 3 * page_size);
+        assert(std::filesystem::file_size(resize_path) == 3 * page_size);
+        assert(sink[0] == 'a');
+        assert(sink[page_size - 1] == 'z');
+        assert(sink[3 * page_size - 1] == 0);
+        sink[3 * page_size - 1] = 'q';
+
+        // Shrink: narrows the view without truncating the file.
+        sink.resize(page_size, error);
+        assert(!error);
+        assert(sink.size() == page_size);
+        assert(std::filesystem::file_size(resize_path) == 3 * page_size);
+        assert(sink[0] == 'a');
+
+        // Zero-length resize is rejected.
+        sink.resize(0, error);
+        assert(error);
+        error.clear();
+
+        sink.unmap();
+        std::filesystem::remove(resize_path);
+    }
+
+    // Test copy-on-write mapping.
+    {
+        mio::mmap_cow cow = mio::make_mmap_cow(path, 0, mio::map_entire_file, error);
+        assert(!error);
+        assert(cow.is_open());
+        assert(cow.size() == buffer.size());
+        const auto& cow_view = cow;
+        assert(cow_view[0] == buffer[0]);
+
+        // Writes are visible through this mapping but never reach the file.
+        cow[0] = '\xff';
+        cow[page_size + 7] = '\xfe';
+        assert(cow_view[0] == '\xff');
+        assert(cow_view[page_size + 7] == '\xfe');
+        {
+            mio::mmap_source check = mio::make_mmap_source(path, 0, mio::map_entire_file, error);
+            assert(!error);
+            [[maybe_unused]] const auto& check_view = check;
+            assert(check_view[0] == buffer[0]);
+            assert(check_view[page_size + 7] == buffer[page_size + 7]);
+        }
+    }
+
+    // Test anonymous mapping.
+    {
+        mio::mmap_sink scratch;
+        scratch.map_anonymous(2 * page_size, error);
+        assert(!error);
+        assert(scratch.is_open());
+        assert(scratch.size() == 2 * page_size);
+        assert(scratch.file_handle() == mio::invalid_handle);
+        // Memory is zero-initialized and writable.
+        assert(scratch[0] == 0);
+        assert(scratch[2 * page_size - 1] == 0);
+        scratch[0] = 'a';
+        scratch[2 * page_size - 1] = 'z';
+        // sync() is a no-op success (nothing to flush).
+        scratch.sync(error);
+        assert(!error);
+        // Released pages read back as zero.
+        scratch.advise(mio::advice::dont_need, error);
+        assert(!error);
+
+        // Zero-length anonymous mappings are rejected.
+        mio::mmap_sink empty_scratch;
+        empty_scratch.map_anonymous(0, error);
+        assert(error);
+        assert(!empty_scratch.is_open());
+        error.clear();
+
+        // Move semantics transfer the anonymous mapping.
+        mio::mmap_sink moved(std::move(scratch));
+        assert(moved.is_open());
+        assert(!scratch.is_open());
+        moved.unmap();
+        assert(!moved.is_open());
+    }
+
+    // Test page-residency pinning.
+    {
+        mio::mmap_source m = mio::make_mmap_source(path, 0, mio::map_entire_file, error);
+        assert(!error);
+        // Pin and release a small subrange spanning a page boundary.
+        m.lock(page_size - 5, 10, error);
+        assert(!error);
+        m.unlock(page_size - 5, 10, error);
+        assert(!error);
+        // Unlocking a range that was never locked is harmless.
+        m.unlock(0, page_size, error);
+        assert(!error);
+        // Out-of-range lock is rejected.
+        m.lock(m.size() + 1, 1, error);
+        assert(error);
+        error.clear();
+        // Lock on an unmapped object is rejected.
+        mio::mmap_source closed;
+        closed.lock(error);
+        assert(error);
+        error.clear();
+    }
+
+    // Test page-residency inspection.
+    {
+        mio::mmap_source m = mio::make_mmap_source(path, 0, mio::map_entire_file, error);
+        assert(!error);
+        // Pin the mapping so every page is guaranteed resident.
+        m.lock(error);
+        assert(!error);
+        const mio::page_residency residency = m.residency(error);
+        assert(!error);
+        assert(residency.page_size == page_size);
+        assert(residency.pages.size() == (m.size() + page_size - 1) / page_size);
+        assert(residency.resident_pages == residency.pages.size());
+        assert(residency.resident_runs == 1);
+        assert(residency.resident_bytes() == residency.resident_pages * page_size);
+        m.unlock(error);
+        assert(!error);
+
+        // A single-page query spanning a page boundary covers two pages.
+        const mio::page_residency pair = m.residency(page_size - 1, 2, error);
+        assert(!error);
+        assert(pair.pages.size() == 2);
+
+        // Out-of-range query is rejected.
+        (void)m.residency(m.size() + 1, 1, error);
+        assert(error);
+        error.clear();
+
+        // Query on an unmapped object is rejected.
+        mio::mmap_source closed;
+        (void)closed.residency(error);
+        assert(error);
+        error.clear();
+    }
+
+    // Test windowed mapping.
+    {
+        // One-page windows with a budget of two force LRU eviction on our
+        // four-page test file.
+        mio::mmap_window_source windowed(page_size, 2);
+        assert(!windowed.is_open());
+        windowed.open(path, error);
+        assert(!error);
+        assert(windowed.is_open());
+        assert(windowed.file_size() == buffer.size());
+        assert(windowed.window_size() == page_size);
+        assert(windowed.mapped_windows() == 0);
+
+        // First view maps a window; a second view into the same window hits.
+        const char* first = windowed.view(0, 16, error);
+        assert(!error);
+        assert(std::equal(first, first + 16, buffer.data()));
+        assert(windowed.mapped_windows() == 1);
+        const char* again = windowed.view(8, 8, error);
+        assert(!error);
+        assert(again == first + 8);
+        assert(windowed.mapped_windows() == 1);
+
+        // A view straddling the window grid gets an extended window.
+        const char* straddle = windowed.view(page_size - 4, 8, error);
+        assert(!error);
+        assert(std::equal(straddle, straddle + 8, buffer.data() + page_size - 4));
+        assert(windowed.mapped_windows() == 2);
+
+        // A third distinct window evicts the least recently used one.
+        const char* third = windowed.view(3 * page_size, 16, error);
+        assert(!error);
+        assert(std::equal(third, third + 16, buffer.data() + 3 * page_size));
+        assert(windowed.mapped_windows() == 2);
+
+        // Out-of-range views are rejected.
+        assert(windowed.view(windowed.file_size(), 1, error) == nullptr);
+        assert(error);
+        error.clear();
+
+        // Views on a closed mapper are rejected.
+        windowed.close();
+        assert(!windowed.is_open());
+        assert(windowed.view(0, 1, error) == nullptr);
+        assert(error);
+        error.clear();
+
+        // Writes through a sink window reach the file.
+        mio::mmap_window_sink sink_window(page_size, 2);
+        sink_window.open(path, error);
+        assert(!error);
+        char* writable = sink_window.view(page_size + 1, 1, error);
+        assert(!error);
+        const char original = *writable;
+        *writable = '!';
+        sink_window.close();
+        {
+            mio::mmap_source check = mio::make_mmap_source(path, 0, mio::map_entire_file, error);
+            assert(!error);
+            const auto& check_view = check;
+            assert(check_view[page_size + 1] == '!');
+        }
+        // Restore the byte for later tests.
+        sink_window.open(path, error);
+        assert(!error);
+        *sink_window.view(page_size + 1, 1, error) = original;
+        assert(!error);
+    }
+
+    // Test the process-wide mapping registry.
+    {
+        mio::shared_mmap_source first = mio::make_cached_mmap_source(path, error);
+        assert(!error);
+        assert(first.is_open());
+        assert(first.size() == buffer.size());
+
+        // A second open of the same file resolves to the same mapping.
+        mio::shared_mmap_source second = mio::make_cached_mmap_source(path, error);
+        assert(!error);
+        assert(second.get_shared_ptr() == first.get_shared_ptr());
+        assert(mio::mmap_registry::instance().size() == 1);
+
+        // A relative path reaching the same file also deduplicates.
+        const auto dotted = std::filesystem::path(".") / path;
+        mio::shared_mmap_source third = mio::make_cached_mmap_source(dotted, error);
+        assert(!error);
+        assert(third.get_shared_ptr() == first.get_shared_ptr());
+
+        // Regular factories bypass the registry.
+        mio::shared_mmap_source uncached =
+                mio::make_shared_mmap_source(path, 0, mio::map_entire_file, error);
+        assert(!error);
+        assert(uncached.get_shared_ptr() != first.get_shared_ptr());
+
+        // Opening a nonexistent file reports the error.
+        (void)mio::make_cached_mmap_source("garbage-that-hopefully-doesnt-exist", error);
+        assert(error);
+        error.clear();
+
+        // Once the last owner is gone, the entry expires and purge() drops it.
+        first = mio::shared_mmap_source();
+        second = mio::shared_mmap_source();
+        third = mio::shared_mmap_source();
+        assert(mio::mmap_registry::instance().size() == 0);
+        mio::mmap_registry::instance().purge();
+        // A later open maps the file afresh.
+        mio::shared_mmap_source fresh = mio::make_cached_mmap_source(path, error);
+        assert(!error);
+        assert(fresh.is_open());
+    }
+
+    // Test the streaming sequential reader.
+    {
+        // Page-sized windows so the pipeline advances several times over
+        // our four-page test file.
+        mio::mmap_stream stream(page_size, 1);
+        assert(!stream.is_open());
+        stream.open(path, error);
+        assert(!error);
+        assert(stream.is_open());
+        assert(stream.size() == buffer.size());
+        assert(stream.window_size() == page_size);
+        assert(stream.prefetch_depth() == 1);
+
+        // A full pass delivers every byte in order.
+        std::string consumed;
+        consumed.reserve(stream.size());
+        for(const char c : stream) { consumed.push_back(c); }
+        assert(consumed == buffer);
+
+        // The pipeline is advisory: a second pass re-reads the same data.
+        size_t count = 0;
+        for(auto it = stream.begin(); it != stream.end(); it++) { ++count; }
+        assert(count == buffer.size());
+
+        stream.close();
+        assert(!stream.is_open());
+        assert(stream.empty());
+
+        // Opening a nonexistent file reports the error.
+        mio::mmap_stream missing;
+        missing.open("garbage-that-hopefully-doesnt-exist", error);
+        assert(error);
+        assert(!missing.is_open());
+        error.clear();
+    }
+
+    // Test NUMA placement controls.
+    {
+        mio::map_options options;
+        options.numa = mio::numa_policy::interleave;
+        mio::mmap_source m;
+        m.map(path, 0, mio::map_entire_file, options, error);
+#ifdef __linux__
+        // Interleave across the online nodes works wherever mbind() is
+        // permitted; sandboxes may filter the syscall, in which case the
+        // map fails cleanly instead of mapping with the wrong placement.
+        if(!error)
+        {
+            assert(m.is_open());
+            const auto& m_view = m;
+            assert(m_view[0] == buffer[0]);
+
+            // Touch a page, then ask where it landed.
+            const std::vector<int> nodes = m.numa_nodes(0, page_size, error);
+            if(!error)
+            {
+                assert(nodes.size() == 1);
+                assert(nodes[0] >= 0);
+            }
+            error.clear();
+        }
+        error.clear();
+
+        // Binding to an invalid node is rejected up front.
+        mio::mmap_source bad;
+        mio::map_options bad_options;
+        bad_options.numa = mio::numa_policy::bind;
+        bad_options.numa_node = -1;
+        bad.map(path, 0, mio::map_entire_file, bad_options, error);
+        assert(error);
+        assert(!bad.is_open());
+        error.clear();
+#else
+        // Placement policies are Linux-only and fail explicitly elsewhere.
+        assert(error == std::errc::function_not_supported);
+        assert(!m.is_open());
+        error.clear();
+#endif
+
+        // Placement query on an unmapped object is rejected everywhere.
+        mio::mmap_source closed;
+        (void)closed.numa_nodes(error);
+        assert(error);
+        error.clear();
+    }
+
+    // Test batch multi-file mapping.
+    {
+        // A good file, a missing file, and the good file again: errors are
+        // positional and one failure must not abort the batch.
+        const std::vector<std::filesystem::path> paths = {
+            path,
+            "garbage-that-hopefully-doesnt-exist",
+            path,
+        };
+        std::vector<std::error_code> errors;
+        std::vector<mio::mmap_source> mappings = mio::map_files(paths, errors);
+        assert(mappings.size() == paths.size());
+        assert(errors.size() == paths.size());
+
+        assert(!errors[0]);
+        assert(mappings[0].is_open());
+        assert(mappings[0].size() == buffer.size());
+        const auto& first_view = mappings[0];
+        assert(first_view[0] == buffer[0]);
+
+        assert(errors[1]);
+        assert(!mappings[1].is_open());
+
+        assert(!errors[2]);
+        assert(mappings[2].is_open());
+
+        // Batch options apply to every file.
+        mio::map_options options;
+        options.populate = true;
+        std::vector<mio::mmap_source> populated =
+                mio::map_files<mio::mmap_source>(paths, options, errors);
+        assert(!errors[0] && errors[1] && !errors[2]);
+        assert(populated[0].is_open());
+
+        // An empty batch is a no-op.
+        std::vector<mio::mmap_source> none =
+                mio::map_files({}, errors);
+        assert(none.empty());
+        assert(errors.empty());
+    }
+
+    // Test sparse-range discard (hole punching).
+    {
+        const char* ring_path = "test-file-ring";
+        std::filesystem::remove(ring_path);
+
+        mio::map_options options;
+        options.create = true;
+        const size_t ring_size = 4 * page_size;
+        mio::mmap_sink ring =
+                mio::make_mmap_sink(ring_path, 0, ring_size, options, error);
+        assert(!error);
+        std::fill(ring.begin(), ring.end(), 'r');
+        ring.sync(error);
+        assert(!error);
+
+        // Retire an unaligned range spanning partial and full pages.
+        ring.discard(page_size - 3, page_size + 6, error);
+        if(!error)
+        {
+            const auto& ring_view = ring;
+            assert(ring_view[page_size - 4] == 'r');
+            for(size_t i = page_size - 3; i < 2 * page_size + 3; ++i)
+            {
+                assert(ring_view[i] == 0);
+            }
+            assert(ring_view[2 * page_size + 3] == 'r');
+            // The hole is transparent: the logical size is unchanged.
+            assert(std::filesystem::file_size(ring_path) == ring_size);
+        }
+        else
+        {
+            // Hole punching depends on filesystem support; the only
+            // acceptable failure is the operation being unsupported.
+            assert(error == std::errc::operation_not_supported
+                    || error == std::errc::function_not_supported);
+            error.clear();
+        }
+
+        // Out-of-range and closed mappings are rejected.
+        ring.discard(ring_size + 1, 1, error);
+        assert(error == std::errc::invalid_argument);
+        mio::mmap_sink closed_ring;
+        closed_ring.discard(0, 1, error);
+        assert(error == std::errc::bad_file_descriptor);
+        error.clear();
+
+        ring.unmap();
+        std::filesystem::remove(ring_path);
+
+        // Anonymous mappings discard to zero without a backing file;
+        // map_entire_file retires the rest of the mapping.
+#ifdef __linux__
+        mio::mmap_sink anon;
+        anon.map_anonymous(2 * page_size, error);
+        assert(!error);
+        std::fill(anon.begin(), anon.end(), 'a');
+        anon.discard(3, mio::map_entire_file, error);
+        assert(!error);
+        assert(anon[0] == 'a' && anon[2] == 'a');
+        for(size_t i = 3; i < 2 * page_size; ++i) { assert(anon[i] == 0); }
+#endif
+    }
+
+    // Test the mapped std::pmr memory resource.
+    {
+        const char* arena_path = "test-file-arena";
+        std::filesystem::remove(arena_path);
+
+        mio::mapped_memory_resource arena;
+        arena.open(arena_path, 4 * page_size, error);
+        assert(!error);
+        assert(arena.is_open());
+        assert(arena.capacity() == 4 * page_size);
+        assert(arena.used() == 0);
+
+        // Containers allocate directly inside the mapping.
+        std::pmr::vector<char> entries(&arena);
+        entries.reserve(64);
+        for(char c : {'m', 'i', 'o'}) { entries.push_back(c); }
+        assert(entries[0] == 'm' && entries[2] == 'o');
+        assert(reinterpret_cast<const char*>(entries.data())
+                >= arena.mapping().data());
+        assert(arena.used() >= entries.capacity());
+
+        // Over-aligned allocations are honored.
+        void* aligned = arena.allocate(100, 64);
+        assert(reinterpret_cast<uintptr_t>(aligned) % 64 == 0);
+        arena.deallocate(aligned, 100, 64); // no-op
+
+        // The arena persists through sync(): the vector's bytes land in
+        // the backing file.
+        arena.sync(error);
+        assert(!error);
+        {
+            mio::mmap_source persisted(arena_path, 0, mio::map_entire_file);
+            const auto& view = persisted;
+            bool found = false;
+            for(size_t i = 0; i + 2 < view.size() && !found; ++i)
+            {
+                found = view[i] == 'm' && view[i + 1] == 'i'
+                        && view[i + 2] == 'o';
+            }
+            assert(found);
+        }
+
+        // Exhaustion throws bad_alloc instead of spilling to the heap.
+        bool threw = false;
+        try { (void)arena.allocate(arena.capacity(), 1); }
+        catch(const std::bad_alloc&) { threw = true; }
+        assert(threw);
+
+        // release() rewinds the whole arena in O(1).
+        arena.release();
+        assert(arena.used() == 0);
+        assert(arena.remaining() == arena.capacity());
+        void* again = arena.allocate(16, 8);
+        assert(again == arena.mapping().data());
+
+        arena.close();
+        assert(!arena.is_open());
+        std::filesystem::remove(arena_path);
+
+        // Anonymous arenas work the same, minus persistence.
+        mio::mapped_memory_resource scratch;
+        scratch.open_anonymous(page_size, error);
+        assert(!error);
+        std::pmr::vector<int> numbers(&scratch);
+        for(int i = 0; i < 100; ++i) { numbers.push_back(i); }
+        assert(numbers[99] == 99);
+    }
+
+    // Test open-time access-pattern hints.
+    {
+        // The hints are advisory (posix_fadvise / CreateFile cache flags),
+        // so the observable contract is just that mapping still works.
+        mio::map_options options;
+        options.access_pattern = mio::advice::sequential;
+        mio::mmap_source m;
+        m.map(path, 0, mio::map_entire_file, options, error);
+        assert(!error);
+        const auto& m_view = m;
+        assert(m_view[0] == buffer[0]);
+        m.unmap();
+
+        options.access_pattern = mio::advice::random;
+        m.map(path, 0, mio::map_entire_file, options, error);
+        assert(!error);
+        assert(m.size() == buffer.size());
+    }
+
+    // Test persistent-memory (MAP_SYNC) mapping requests.
+    {
+        mio::map_options options;
+        options.pmem = true;
+
+        // On a non-DAX filesystem the kernel rejects MAP_SYNC, and the
+        // request must fall back cleanly to a regular mapping with the
+        // msync()-based sync path.
+        mio::mmap_sink m;
+        m.map(path, 0, mio::map_entire_file, options, error);
+        assert(!error);
+        assert(m.is_open());
+        m[0] = buffer[0]; // dirty a page without changing content
+        m.sync(error);
+        assert(!error);
+        m.unmap();
+        assert(!m.is_pmem());
+
+        // pmem is only meaningful for write mappings; a read mapping
+        // ignores it.
+        mio::mmap_source src;
+        src.map(path, 0, mio::map_entire_file, options, error);
+        assert(!error);
+        assert(!src.is_pmem());
+    }
+
+    // Test the instrumentation counters.
+    {
+        auto& stats = mio::stats::instance();
+        stats.reset();
+
+        size_t events = 0;
+        stats.set_callback([&events](const mio::stats_event&) { ++events; });
+
+        {
+            mio::mmap_sink m;
+            m.map(path, error);
+            assert(!error);
+            m.sync(error);
+            assert(!error);
+            // Unmap explicitly so the destructor's best-effort sync of the
+            // (now closed) mapping records nothing.
+            m.unmap();
+        }
+
+        const mio::stats_snapshot snap = stats.snapshot();
+#ifdef MIO_ENABLE_STATS
+        assert(snap.map_count == 1);
+        assert(snap.unmap_count == 1);
+        assert(snap.sync_count == 1);
+        assert(snap.failed_operations == 0);
+        assert(snap.bytes_mapped == buffer.size());
+        assert(snap.sync_duration_ns >= snap.max_sync_duration_ns);
+        assert(events == 3);
+        stats.reset();
+#else
+        // Compiled out: the API stays callable but records nothing.
+        assert(snap.map_count == 0);
+        assert(snap.bytes_mapped == 0);
+        assert(events == 0);
+#endif
+        stats.set_callback(nullptr);
+        error.clear();
+    }
+
+    // Test compile-time page traits.
+    {
+        using traits = mio::page_traits_4k;
+        static_assert(traits::page_size() == 4096);
+        static_assert(traits::make_offset_page_aligned(0) == 0);
+        static_assert(traits::make_offset_page_aligned(100) == 0);
+        static_assert(traits::make_offset_page_aligned(4096) == 4096);
+        static_assert(traits::make_offset_page_aligned(5000) == 4096);
+        static_assert(traits::make_length_page_aligned(1) == 4096);
+        static_assert(traits::make_length_page_aligned(8192) == 8192);
+        static_assert(mio::page_traits_64k::page_size() == 65536);
+
+        // assume_page_size() reports whether the assumed granularity
+        // matches the system's actual one.
+        assert(mio::assume_page_size<4096>() == (mio::page_size() == 4096));
+
+        // The mask-based runtime alignment agrees with the traits where
+        // the granularities agree.
+        if(mio::page_size() == 4096)
+        {
+            assert(mio::make_offset_page_aligned(5000)
+                    == traits::make_offset_page_aligned(5000));
+        }
+        assert(mio::make_offset_page_aligned(3 * mio::page_size() + 1)
+                == 3 * mio::page_size());
+    }
+
+    // Test non-temporal bulk transfer.
+    {
+        // Half a MiB crosses the streaming threshold, so the cache-bypass
+        // path is exercised on x86 builds.
+        const size_t scratch_size = size_t(1) << 19;
+        mio::mmap_sink scratch;
+        scratch.map_anonymous(scratch_size, error);
+        assert(!error);
+
+        std::vector<char> pattern(scratch_size - 7);
+        for(size_t i = 0; i < pattern.size(); ++i)
+        {
+            pattern[i] = static_cast<char>(i * 31 + 1);
+        }
+
+        // A misaligned destination offset exercises the scalar head/tail.
+        mio::copy_to(scratch, 7, pattern.data(), pattern.size(), error);
+        assert(!error);
+        for(size_t i = 0; i < pattern.size(); ++i)
+        {
+            assert(scratch[7 + i] == pattern[i]);
+        }
+
+        mio::fill(scratch, 0, 7, 'x', error);
+        assert(!error);
+        assert(scratch[0] == 'x' && scratch[6] == 'x');
+        assert(scratch[7] == pattern[0]);
+
+        // map_entire_file fills the rest of the mapping.
+        mio::fill(scratch, 1, mio::map_entire_file, 'y', error);
+        assert(!error);
+        assert(scratch[0] == 'x');
+        assert(scratch[1] == 'y');
+        assert(scratch[scratch_size - 1] == 'y');
+
+        std::vector<char> drained(scratch_size - 1);
+        mio::copy_from(scratch, 1, drained.data(), drained.size(), error);
+        assert(!error);
+        assert(drained.front() == 'y' && drained.back() == 'y');
+
+        // Ranges outside the mapping are rejected.
+        mio::copy_to(scratch, scratch_size, pattern.data(), 1, error);
+        assert(error == std::errc::invalid_argument);
+        mio::copy_from(scratch, 0, drained.data(), scratch_size + 1, error);
+        assert(error == std::errc::invalid_argument);
+        mio::fill(scratch, 0, scratch_size + 1, 'z', error);
+        assert(error == std::errc::invalid_argument);
+
+        // Closed mappings are rejected.
+        mio::mmap_sink closed_sink;
+        mio::fill(closed_sink, 0, 1, 'z', error);
+        assert(error == std::errc::bad_file_descriptor);
+        error.clear();
+    }
+
+    // Test zero-copy range cloning.
+    {
+        const char* clone_path = "test-file-clone";
+        {
+            std::ofstream file(clone_path,
+                    std::ios::trunc | std::ios::binary);
+            file << std::string(buffer.size(), '\0');
+        }
+
+        mio::mmap_source src;
+        src.map(path, error);
+        assert(!error);
+        mio::mmap_sink dst;
+        dst.map(clone_path, error);
+        assert(!error);
+        const auto& src_view = src;
+
+        // Whole-source clone via the length sentinel. On Linux this goes
+        // through copy_file_range(); elsewhere (and on filesystems that
+        // reject it) through the mapped-copy fallback.
+        mio::clone_range(src, dst, 0, 0, mio::map_entire_file, error);
+        assert(!error);
+        for(size_t i = 0; i < buffer.size(); ++i)
+        {
+            assert(dst[i] == src_view[i]);
+        }
+
+        // Sub-range clone at misaligned offsets leaves neighbors intact.
+        mio::fill(dst, 0, mio::map_entire_file, '\0', error);
+        assert(!error);
+        mio::clone_range(src, dst, 3, 11, 100, error);
+        assert(!error);
+        for(size_t i = 0; i < 100; ++i)
+        {
+            assert(dst[11 + i] == src_view[3 + i]);
+        }
+        assert(dst[10] == '\0');
+        assert(dst[111] == '\0');
+
+        // An anonymous destination has no file to copy into, so it takes
+        // the mapped-copy fallback.
+        mio::mmap_sink scratch;
+        scratch.map_anonymous(buffer.size(), error);
+        assert(!error);
+        mio::clone_range(src, scratch, 0, 0, buffer.size(), error);
+        assert(!error);
+        assert(scratch[0] == src_view[0]);
+        assert(scratch[buffer.size() - 1]
+                == src_view[buffer.size() - 1]);
+
+        // A copy-on-write source clones its live (privately modified)
+        // view, not the stale file bytes underneath it.
+        mio::mmap_cow cow_src;
+        cow_src.map(path, error);
+        assert(!error);
+        cow_src[0] = 'C';
+        cow_src[1] = 'W';
+        mio::clone_range(cow_src, dst, 0, 0, buffer.size(), error);
+        assert(!error);
+        assert(dst[0] == 'C');
+        assert(dst[1] == 'W');
+        assert(dst[2] == src_view[2]);
+
+        // Ranges that do not fit either mapping are rejected.
+        mio::clone_range(src, dst, 0, 1, mio::map_entire_file, error);
+        assert(error == std::errc::invalid_argument);
+        mio::clone_range(src, dst, buffer.size() + 1, 0, 1, error);
+        assert(error == std::errc::invalid_argument);
+
+        // Closed mappings are rejected.
+        mio::mmap_sink closed_dst;
+        mio::clone_range(src, closed_dst, 0, 0, 1, error);
+        assert(error == std::errc::bad_file_descriptor);
+        error.clear();
+    }
+
+    // Test parallel chunked algorithms.
+    {
+        mio::mmap_source m;
+        m.map(path, error);
+        assert(!error);
+
+        // Every byte is visited exactly once across page-aligned chunks.
+        std::atomic<size_t> visited(0);
+        std::atomic<bool> content_ok(true);
+        mio::parallel_for_each_chunk(m, 1024,
+                [&](const char* data, const size_t size, const size_t offset)
+                {
+                    assert(offset % mio::page_size() == 0);
+                    for(size_t i = 0; i < size; ++i)
+                    {
+                        if(data[i] != buffer[offset + i])
+                        {
+                            content_ok = false;
+                        }
+                    }
+                    visited += size;
+                });
+        assert(visited == buffer.size());
+        assert(content_ok);
+
+        // Reduction sums to the same value as a serial pass.
+        const auto chunk_sum = [](const char* data, const size_t size,
+                const size_t) -> uint64_t
+        {
+            uint64_t sum = 0;
+            for(size_t i = 0; i < size; ++i)
+            {
+                sum += static_cast<unsigned char>(data[i]);
+            }
+            return sum;
+        };
+        const uint64_t parallel_sum = mio::parallel_reduce_chunk(m, 1024,
+                uint64_t{0}, chunk_sum, std::plus<uint64_t>{});
+        uint64_t serial_sum = 0;
+        for(const char c : buffer)
+        {
+            serial_sum += static_cast<unsigned char>(c);
+        }
+        assert(parallel_sum == serial_sum);
+
+        // A single worker produces the same result.
+        assert(mio::parallel_reduce_chunk(m, 1024, uint64_t{0}, chunk_sum,
+                std::plus<uint64_t>{}, 1) == serial_sum);
+
+        // A closed mapping is a no-op / returns the identity.
+        mio::mmap_source closed;
+        mio::parallel_for_each_chunk(closed, 1024,
+                [](const char*, size_t, size_t) { assert(false); });
+        assert(mio::parallel_reduce_chunk(closed, 1024, uint64_t{7},
+                chunk_sum, std::plus<uint64_t>{}) == 7);
+
+        // The first functor exception is rethrown on the calling thread.
+        bool caught = false;
+        try
+        {
+            mio::parallel_for_each_chunk(m, 1024,
+                    [](const char*, size_t, size_t)
+                    {
+                        throw std::runtime_error("chunk failed");
+                    });
+        }
+        catch(const std::runtime_error&)
+        {
+            caught = true;
+        }
+        assert(caught);
+    }
+
+    // Test the async engine.
+    {
+        mio::async_engine engine(2);
+        assert(engine.thread_count() == 2);
+
+        // Async map delivers the mapping and its error together.
+        mio::async_result<mio::mmap_source> mapped =
+                engine.map<mio::mmap_source>(path).get();
+        assert(!mapped.error);
+        assert(mapped.value.is_open());
+        assert(mapped.value.size() == buffer.size());
+        const auto& mapped_view = mapped.value;
+        assert(mapped_view[0] == buffer[0]);
+
+        // Async prefetch completes once the range is resident.
+        std::error_code prefetch_error =
+                engine.prefetch(mapped.value, 0, mio::map_entire_file).get();
+        assert(!prefetch_error);
+
+        // A missing file surfaces its error through the result, not the
+        // future's exception channel.
+        mio::async_result<mio::mmap_source> missing =
+                engine.map<mio::mmap_source>(
+                        "garbage-that-hopefully-doesnt-exist").get();
+        assert(missing.error);
+        assert(!missing.value.is_open());
+
+        // Async sync of a dirtied writable mapping.
+        mio::async_result<mio::mmap_sink> sink =
+                engine.map<mio::mmap_sink>(path).get();
+        assert(!sink.error);
+        sink.value[0] = buffer[0]; // dirty a page without changing content
+        std::error_code sync_error = engine.sync(
+                sink.value, 0, mio::map_entire_file).get();
+        assert(!sync_error);
+
+#ifdef MIO_HAS_COROUTINES
+        // The same operations are co_await-able in C++20; the coroutine
+        // runs to completion on an engine worker.
+        struct detached_task
+        {
+            struct promise_type
+            {
+                detached_task get_return_object() { return {}; }
+                std::suspend_never initial_suspend() noexcept { return {}; }
+                std::suspend_never final_suspend() noexcept { return {}; }
+                void return_void() {}
+                void unhandled_exception() { std::terminate(); }
+            };
+        };
+        std::promise<bool> done;
+        auto done_future = done.get_future();
+        const auto coroutine_body = [](mio::async_engine& engine,
+                const char* path, std::promise<bool>& done) -> detached_task
+        {
+            auto mapped = co_await engine.async_map<mio::mmap_source>(path);
+            bool ok = !mapped.error && mapped.value.is_open();
+            if(ok)
+            {
+                const std::error_code prefetch_error = co_await
+                        engine.async_prefetch(mapped.value, 0,
+                                mio::map_entire_file);
+                ok = !prefetch_error;
+            }
+            done.set_value(ok);
+        };
+        coroutine_body(engine, path, done);
+        assert(done_future.get());
+#endif
+    }
+
+    // Test the hybrid buffered/mapped file source.
+    {
+        // A threshold at the file size selects the buffered read path.
+        mio::file_source buffered(buffer.size());
+        assert(!buffered.is_open());
+        assert(buffered.empty());
+        buffered.open(path, error);
+        assert(!error);
+        assert(buffered.is_open());
+        assert(!buffered.is_mapped());
+        assert(buffered.size() == buffer.size());
+        for(size_t i = 0; i < buffer.size(); ++i)
+        {
+            assert(buffered[i] == buffer[i]);
+        }
+        assert(std::equal(buffered.begin(), buffered.end(), buffer.begin()));
+
+        // Re-opening the same object reuses its buffer.
+        buffered.open(path, error);
+        assert(!error);
+        assert(buffered.size() == buffer.size());
+        assert(buffered[0] == buffer[0]);
+
+        // A threshold below the file size selects the mapped path.
+        mio::file_source mapped(buffer.size() - 1);
+        mapped.open(path, error);
+        assert(!error);
+        assert(mapped.is_open());
+        assert(mapped.is_mapped());
+        assert(mapped.size() == buffer.size());
+        assert(std::equal(mapped.begin(), mapped.end(), buffer.begin()));
+
+#if __cplusplus >= 202002L
+        assert(buffered.as_span().size() == buffer.size());
+        assert(mapped.as_span().size() == buffer.size());
+#endif
+
+        // Moving transfers the mapping and its file handle; the
+        // moved-from source is closed and safe to destroy or reuse.
+        mio::file_source moved(std::move(mapped));
+        assert(moved.is_open());
+        assert(moved.is_mapped());
+        assert(!mapped.is_open());
+        assert(!mapped.is_mapped());
+        assert(moved.size() == buffer.size());
+        assert(moved[0] == buffer[0]);
+
+        mio::file_source moved_buffered;
+        moved_buffered = std::move(buffered);
+        assert(moved_buffered.is_open());
+        assert(!moved_buffered.is_mapped());
+        assert(!buffered.is_open());
+        assert(moved_buffered.size() == buffer.size());
+        assert(std::equal(moved_buffered.begin(), moved_buffered.end(),
+                buffer.begin()));
+        // The moved-from source can be reopened after the move.
+        buffered.open(path, error);
+        assert(!error);
+        assert(buffered.size() == buffer.size());
+
+        moved.close();
+        assert(!moved.is_open());
+        assert(moved.empty());
+
+        // Opening a missing file reports the error on either path.
+        buffered.open("file-that-does-not-exist", error);
+        assert(error);
+        error.clear();
+    }
+
+    // Test the address-space reservation pool.
+    {
+        mio::mapping_pool pool;
+
+        // An unopened pool rejects mapping requests.
+        auto rejected = pool.map_into_pool(path, error);
+        assert(error == std::errc::bad_file_descriptor);
+        assert(!rejected.is_open());
+
+        pool.open(buffer.size(), 2, error);
+        assert(!error);
+        assert(pool.is_open());
+        assert(pool.slot_count() == 2);
+        assert(pool.slot_size() >= buffer.size());
+        assert(pool.slot_size() % page_size == 0);
+        assert(pool.free_slots() == 2);
+
+        auto view = pool.map_into_pool(path, error);
+        assert(!error);
+        assert(view.is_open());
+        assert(view.size() == buffer.size());
+        assert(pool.free_slots() == 1);
+        for(size_t i = 0; i < buffer.size(); ++i)
+        {
+            assert(view[i] == buffer[i]);
+        }
+        assert(std::equal(view.begin(), view.end(), buffer.begin()));
+
+        auto view2 = pool.map_into_pool(path, error);
+        assert(!error);
+        assert(pool.free_slots() == 0);
+
+        // A full pool reports exhaustion rather than mapping elsewhere.
+        auto overflow = pool.map_into_pool(path, error);
+        assert(error == std::errc::no_buffer_space);
+        assert(!overflow.is_open());
+
+#ifndef _WIN32
+        // Releasing a slot recycles its address for the next file.
+        const char* const recycled_address = view2.data();
+        view2.release();
+        assert(pool.free_slots() == 1);
+        view2 = pool.map_into_pool(path, error);
+        assert(!error);
+        assert(view2.data() == recycled_address);
+#endif
+
+        // A file larger than a slot is rejected.
+        mio::mapping_pool small_pool;
+        small_pool.open(1, 1, error);
+        assert(!error);
+        assert(small_pool.slot_size() == page_size);
+        auto too_large = small_pool.map_into_pool(path, error);
+        assert(error == std::errc::file_too_large);
+        assert(!too_large.is_open());
+        assert(small_pool.free_slots() == 1);
+        error.clear();
+
+        // Closing with views outstanding is refused.
+        pool.close(error);
+        assert(error == std::errc::device_or_resource_busy);
+        view.release();
+        view2.release();
+        assert(pool.free_slots() == 2);
+        pool.close(error);
+        assert(!error);
+        assert(!pool.is_open());
+    }
+
+    // Test prefaulted (populated) mappings.
+    {
+        mio::map_options options;
+        options.populate = true;
+        mio::mmap_source m;
+        m.map(path, 0, mio::map_entire_file, options, error);
+        assert(!error);
+        assert(m.is_open());
+        assert(m.size() == buffer.size());
+        const auto& m_view = m;
+        for(size_t i = 0; i < buffer.size(); ++i)
+        {
+            assert(m_view[i] == buffer[i]);
+        }
+
+        // Prefaulted anonymous scratch memory behaves the same as lazy one.
+        mio::mmap_sink scratch;
+        scratch.map_anonymous(2 * page_size, options, error);
+        assert(!error);
+        assert(scratch[0] == 0);
+        scratch[page_size] = 'p';
+        assert(scratch[page_size] == 'p');
+    }
+
     // Make sure these compile.
     {
         mio::ummap_source _1;